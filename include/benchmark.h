@@ -0,0 +1,55 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class Client;
+
+// =========================================================
+// War3BotBench: 热点路径微基准 (独立可执行文件 War3BotBench)
+// ---------------------------------------------------------
+// 覆盖协议打包、哈希与加密登录路径，结果输出为 JSON
+// (字段布局与 Google Benchmark 一致，便于跨版本比对回归)。
+// =========================================================
+
+struct BenchResult {
+    QString     name;
+    qint64      iterations      = 0;
+    double      nsPerOp         = 0.0;
+    qint64      bytesPerOp      = 0;        // 0 表示不统计吞吐
+    bool        skipped         = false;
+    QString     note;
+};
+
+class War3BotBench
+{
+public:
+    // minTimeMs: 每个用例的最短采样时间; filter: 名称子串过滤 (空 = 全部)
+    explicit War3BotBench(int minTimeMs = 500, const QString &filter = QString());
+
+    // 运行全部用例并把 JSON 写入 outputPath ("-" 或空 = 标准输出)，返回进程退出码
+    int run(const QString &outputPath);
+
+private:
+    void runCase(const QString &name, qint64 bytesPerOp, const std::function<quint64()> &fn);
+    void skipCase(const QString &name, const QString &reason);
+    QJsonObject toJson() const;
+
+    void benchHashing();
+    void benchProtocol(Client &client);
+    void benchCrypto();
+    void benchCheckRevision(Client &client);
+    void benchPlayerTable();
+    void benchSessionRegistry();
+    void benchWatchdog();
+
+    int                         m_minTimeMs;
+    QString                     m_filter;
+    QVector<BenchResult>        m_results;
+    volatile quint64            m_sink = 0;
+};
+
+#endif // BENCHMARK_H
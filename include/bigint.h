@@ -74,9 +74,16 @@ public:
      * @brief 模幂运算 (Modular Exponentiation)
      * 计算 (this ^ exp) % mod
      * 这是 SRP 协议中最核心的加密计算函数。
+     * 默认由 GMP (mpz_powm_sec) 计算；设置环境变量 WAR3BOT_BIGINT_NATIVE 时退回 powmNative。
      */
     BigInt powm(const BigInt &exp, const BigInt &mod) const;
 
+    // 原生实现 (递归平方乘)，保留用于对照校验与基准
+    BigInt powmNative(const BigInt &exp, const BigInt &mod) const;
+
+    // 当前 powm 使用的后端名称 ("GMP" / "Native")
+    static const char *powmBackendName();
+
     /**
      * @brief 导出为字节数组
      * @param minByteCount 最小输出长度 (不足补0)
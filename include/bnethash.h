@@ -40,6 +40,23 @@ void sha1_hash(t_hash *hashout, uint size, const void *datain);
  */
 void little_endian_sha1_hash(t_hash *hashout, uint size, const void *datain);
 
+/**
+ * @brief 可分段输入的标准 SHA1 上下文
+ * 状态是纯值类型，可直接拷贝，用于缓存公共前缀的"中间状态" (midstate)，
+ * 之后在副本上继续追加数据，避免重复哈希相同的前缀。
+ */
+struct t_sha1_ctx {
+    t_hash          state;
+    quint64         length;         // 已输入的总字节数
+    unsigned char   buffer[64];     // 未满一块的残留数据
+    uint            bufferLen;
+};
+
+void sha1_init(t_sha1_ctx *ctx);
+void sha1_update(t_sha1_ctx *ctx, const void *datain, uint size);
+// 输出 20 字节标准摘要 (与 QCryptographicHash::Sha1 一致)
+QByteArray sha1_final(t_sha1_ctx ctx);
+
 // === 辅助工具函数 ===
 
 // 比较两个哈希值是否相等
@@ -3,7 +3,9 @@
 
 #include <QString>
 #include <QObject>
+#include <QThread>
 #include <QDateTime>
+#include <type_traits>
 #include "client.h"
 
 class BotManager;
@@ -100,6 +102,7 @@ public:
     void resetGame(bool disconnectFlag, const QString &context);
     void incrementSignalCount(const QString &sigName);
     bool isOwner(const QString &senderClientId) const;
+    bool isClientConnected();
     SignalAudit getAudit(const char* signalSignature);
     QString botStateToString(BotState state);
     void enterCriticalOperation();
@@ -107,6 +110,14 @@ public:
     void resetAuditCounts();
     bool isOccupied();
 
+    // === 分片线程调度 ===
+    // Bot 与其 Client 运行在 BotManager 分配的工作线程上，其它线程访问 client 必须经由以下入口
+    // (包括 getBotPid / colored*Text 等只读调用)。state / gameInfo / pendingTask 等业务字段
+    // 只由主线程 (BotManager) 读写; m_triggerCounts 只由分片线程读写。
+    bool isInShardThread() const;
+    template <typename Func> auto callInShard(Func func) -> decltype(func());
+    template <typename Func> void postToShard(Func func);
+
     void setupClient(NetManager* netManager, const QString& displayName);
     void setupGameInfo(const QString &host, const QString &name, const QString &mode, CommandSource source, const QString &clientId, bool isSolo = false);
     void setupPendingTask(const QString &host, const QString &name, const QString &mode, const QString &clientId, CommandSource source, bool isSolo = false);
@@ -131,10 +142,38 @@ signals:
     void rejoinRejected(const QString &clientId, quint32 remainingMs);
     void gameStateChanged(const QString &clientId, GameState gameState);
     void playerTransitioned(const QString &clientId, quint8 pid, const QString &playerName);
+    void playerMembershipChanged(const QString &clientId, const QString &playerName, bool joined);
 
 private:
     BotManager *m_manager;
     QMap<QString, int> m_triggerCounts;
 };
 
+// 同步执行：同线程直接调用，跨线程阻塞调用方直至分片线程执行完毕
+template <typename Func>
+auto Bot::callInShard(Func func) -> decltype(func())
+{
+    using Result = decltype(func());
+    if (isInShardThread()) return func();
+
+    if constexpr (std::is_void<Result>::value) {
+        QMetaObject::invokeMethod(this, func, Qt::BlockingQueuedConnection);
+    } else {
+        Result result{};
+        QMetaObject::invokeMethod(this, [&result, &func]() { result = func(); }, Qt::BlockingQueuedConnection);
+        return result;
+    }
+}
+
+// 异步执行：投递到分片线程的事件队列，保持投递顺序
+template <typename Func>
+void Bot::postToShard(Func func)
+{
+    if (isInShardThread()) {
+        func();
+        return;
+    }
+    QMetaObject::invokeMethod(this, func, Qt::QueuedConnection);
+}
+
 #endif // BOT_H
@@ -0,0 +1,102 @@
+#ifndef BOTLOGINSCHEDULER_H
+#define BOTLOGINSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QMultiMap>
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <functional>
+
+class Bot;
+
+// =========================================================
+// BotLoginScheduler: 机器人登录调度器
+// ---------------------------------------------------------
+// 取代 "每个 Bot 间隔 200ms 定时拨号" 的做法:
+//   1. 同时处于登录阶段 (拨号 -> 认证通过) 的 Bot 数量有上限
+//   2. 令牌桶限制发往 BNET 的新连接速率，允许少量突发
+//   3. 失败或超时后按指数退避 (带随机抖动) 重新排队
+// 调度器只管节奏，拨号/断开动作由 BotManager 通过回调提供；
+// checkRevision 与 SRP 仍在各 Bot 的分片线程上执行。
+// =========================================================
+
+struct BotLoginOptions {
+    int         maxInFlight         = 8;        // 同时登录中的 Bot 上限
+    double      ratePerSec          = 5.0;      // 令牌桶补充速率 (个/秒)
+    int         burst               = 5;        // 令牌桶容量
+    int         timeoutMs           = 20000;    // 单次登录超时
+    int         backoffBaseMs       = 2000;     // 首次失败后的退避时长
+    int         backoffMaxMs        = 60000;    // 退避上限
+};
+
+class BotLoginScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    using BotAction = std::function<void(Bot*)>;
+
+    explicit BotLoginScheduler(QObject *parent = nullptr);
+
+    void setOptions(const BotLoginOptions &options);
+    const BotLoginOptions &options() const  { return m_options; }
+
+    // dispatcher: 发起拨号; timeoutHandler: 登录超时时切断链路
+    void setDispatcher(BotAction dispatcher)            { m_dispatcher = std::move(dispatcher); }
+    void setTimeoutHandler(BotAction timeoutHandler)    { m_timeoutHandler = std::move(timeoutHandler); }
+
+    // 加入登录队列 (已在队列或登录中的 Bot 会被忽略)，返回是否入队
+    bool enqueue(Bot *bot, int delayMs = 0);
+
+    // 登录结果回报: 成功释放名额并清零失败计数; 失败释放名额并按退避重新排队
+    void reportSuccess(Bot *bot);
+    void reportFailure(Bot *bot, const QString &reason);
+
+    void remove(Bot *bot);
+    void clear();
+
+    bool isInFlight(Bot *bot) const;
+    bool isTracked(Bot *bot) const          { return m_entries.contains(bot); }
+    int pendingCount() const                { return m_pending.size(); }
+    int inFlightCount() const               { return m_inFlight; }
+
+private:
+    struct Entry {
+        int         attempts    = 0;        // 连续失败次数
+        bool        inFlight    = false;
+        qint64      readyAt     = 0;        // 排队中: 最早可拨号时间
+        qint64      startedAt   = 0;        // 登录中: 拨号时间
+    };
+
+    void pump();
+    void refillTokens(qint64 now);
+    void checkTimeouts(qint64 now);
+    void requeue(Bot *bot, Entry &entry, qint64 now);
+    void removePending(Bot *bot, qint64 readyAt);
+    void ensureRunning();
+    void finishBatchIfIdle();
+    int backoffDelay(int attempts) const;
+    qint64 now() const                      { return m_clock.elapsed(); }
+
+    BotLoginOptions                 m_options;
+    BotAction                       m_dispatcher;
+    BotAction                       m_timeoutHandler;
+
+    QHash<Bot*, Entry>              m_entries;
+    QMultiMap<qint64, Bot*>         m_pending;          // readyAt -> Bot (按时间有序)
+    int                             m_inFlight          = 0;
+
+    QTimer                          m_pumpTimer;
+    QElapsedTimer                   m_clock;
+    double                          m_tokens            = 0.0;
+    qint64                          m_lastRefill        = 0;
+
+    // 批次统计: 从队列由空变非空开始，到全部登录完成为止
+    bool                            m_batchActive       = false;
+    qint64                          m_batchStartedAt    = 0;
+    int                             m_batchSucceeded    = 0;
+    int                             m_batchFailures     = 0;
+};
+
+#endif // BOTLOGINSCHEDULER_H
@@ -3,6 +3,7 @@
 
 #include <QQueue>
 #include <QObject>
+#include <QThread>
 #include <QVector>
 #include <QSettings>
 #include <QPair>
@@ -10,6 +11,8 @@
 #include "bot.h"
 #include "client.h"
 #include "netmanager.h"
+#include "botloginscheduler.h"
+#include "timingwheel.h"
 
 class BotManager : public QObject
 {
@@ -56,6 +59,7 @@ public slots:
 private slots:
     void onBotRoomPingReceived(const QHostAddress &addr, quint16 port, const QString &identifier, quint64 clientTime, PingSearchMode mode = ByHostName);
     void onBotPlayerTransitioned(Bot *bot, const QString &clientId, quint8 pid, const QString &playerName);
+    void onBotPlayerMembershipChanged(Bot *bot, const QString &clientId, const QString &playerName, bool joined);
     void onBotGameStateChanged(Bot *bot, const QString &clientId, GameState gameState);
     void onBotRejoinRejected(Bot *bot, const QString &clientId, quint32 remainingMs);
     void onBotRoomPingsUpdated(Bot *bot, const QMap<quint8, quint32> &pings);
@@ -75,6 +79,7 @@ private slots:
     void onBotEnteredChat(Bot *bot);
     void onBotGameStarted(Bot *bot);
     void onBotPendingTaskTimeout();
+    void pruneCommandCooldowns(qint64 now);
 
 private:
     void unregisterBotMappings(const QString &clientId, const QString &hostName, const QString &roomName);
@@ -85,11 +90,16 @@ private:
     QString toLeetSpeak(const QString &input);
     void registerBotMappings(Bot *bot);
     void setupBotConnections(Bot *bot);
+    void setupWorkerThreads(int count);
+    void stopWorkerThreads();
+    QThread *nextWorkerThread();
     QString generateUniqueUsername();
     QChar randomCase(QChar c);
 
 private:
     QVector<Bot*>                           m_bots;
+    QVector<QThread*>                       m_workerThreads;
+    int                                     m_nextWorkerIndex           = 0;
     QString                                 m_botDisplayName            = "CC.Dota.XXX";
 
     QStringList                             m_allAccountFilePaths;
@@ -109,13 +119,17 @@ private:
     quint16                                 m_controlPort               = 0;
     quint16                                 m_targetPort                = 6112;
     NetManager                              *m_netManager               = nullptr;
+    BotLoginScheduler                       *m_loginScheduler           = nullptr;
 
     QMap<QString, Bot*>                     m_activeGames;
     QMap<QString, qint64>                   m_lastHostTime;
     QMap<QString, CommandInfo>              m_commandInfos;
     QHash<QString, Bot*>                    m_hostNameToBotMap;
     QHash<QString, Bot*>                    m_clientIdToBotMap;
-    QMap<QString, QMap<QString, qint64>>    m_commandCooldowns;
+    QMultiHash<QString, Bot*>               m_memberClientIdToBot;      // 房间成员索引 (含房主): clientId -> 所在的各个 Bot
+    QMultiHash<QString, Bot*>               m_memberNameToBot;          // 房间成员索引 (含房主): 小写名字 -> 所在的各个 Bot
+    QHash<QString, QHash<QString, qint64>>  m_commandCooldowns;         // clientId -> 指令 -> 冷却到期时间
+    TimingWheel<QString>                    m_commandCooldownWheel;     // clientId 全部冷却到期后整体出表
 };
 
 #endif // BOTMANAGER_H
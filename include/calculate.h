@@ -13,6 +13,12 @@
  */
 quint16 calculateStandardCRC16(const QByteArray &data);
 
+/**
+ * @brief calculateStandardCRC16 的指针版本
+ * @note  用于在接收缓冲区上原地校验控制协议包，不构造 QByteArray。
+ */
+quint16 calculateStandardCRC16(const char *data, int len);
+
 /**
  * @brief 计算标准 CRC32 并截取低 16 位
  * @note  **核心修复**：专用于 W3GS_INCOMING_ACTION (0x0C) 游戏同步包。
@@ -25,4 +31,10 @@ quint16 calculateStandardCRC16(const QByteArray &data);
  */
 quint16 calculateCRC32Lower16(const QByteArray &data);
 
+/**
+ * @brief calculateCRC32Lower16 的指针版本
+ * @note  用于直接在已组好的包缓冲区上原地计算，避免再切出一份 QByteArray。
+ */
+quint16 calculateCRC32Lower16(const char *data, int len);
+
 #endif // CALCULATE_H
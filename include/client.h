@@ -5,12 +5,17 @@
 #include <QTimer>
 #include <QObject>
 #include <QTcpServer>
+#include <QElapsedTimer>
 #include <QTcpSocket>
 #include <QUdpSocket>
 #include <QDataStream>
 #include <QHostAddress>
+#include <QtAlgorithms>
+#include <type_traits>
+#include <array>
 
 #include "netmanager.h"
+#include "timingwheel.h"
 #include "war3map.h"
 #include "command.h"
 
@@ -327,31 +332,22 @@ struct GameConfig {
 // 3. 玩家运行时数据 (Player Data)
 // =========================================================
 struct PlayerData {
-    qint64          downloadStartTime       = 0;
-    qint64          lastSpeedUpdateTime     = 0;
-    qint64          secondStartTime         = 0;
-    qint64          lastDownloadTime        = 0;
+    // --- 热数据: 心跳 / Tick / 地图下载循环每轮都会访问，集中在结构体头部 ---
+    QTcpSocket*     socket                  = nullptr;
     qint64          lastResponseTime        = 0;
+    qint64          lastDownloadTime        = 0;
+    qint64          secondStartTime         = 0;
+    qint64          lastSpeedUpdateTime     = 0;
+    qint64          downloadStartTime       = 0;
+    qint64          lastCountdownTick       = 0;
     double          currentSpeedKBps        = 0.0;
 
-    QString         name;
-    QString         clientId;
-    QTcpSocket*     socket = nullptr;
-    QTextCodec*     codec = nullptr;
-    QHostAddress    extIp;
-    QHostAddress    intIp;
-    QString         language;
-
-    quint32         lastDownloadOffset      = 0;
+    quint32         currentLatency          = 0;
     quint32         currentDownloadOffset   = 0;
+    quint32         lastDownloadOffset      = 0;
     quint32         bytesSentInWindow       = 0;
     quint32         bytesSentThisSecond     = 0;
-    quint32         currentLatency          = 0;
-
-    quint16         extPort                 = 0;
-    quint16         intPort                 = 0;
-
-    JoinSource      joinSource              = Unknown;
+    int             readyCountdown          = 10;
 
     quint8          pid                     = 0;
     bool            isVisualHost            = false;
@@ -359,28 +355,131 @@ struct PlayerData {
     bool            isFinishedLoading       = false;
     bool            isRealConnection        = false;
     bool            isReady                 = false;
-    int             readyCountdown          = 10;
-    qint64          lastCountdownTick       = 0;
+    JoinSource      joinSource              = Unknown;
+
+    QVector<QByteArray> outboundQueue;      // 本轮事件循环待发的 W3GS 包 (统一合并发送)
+
+    // --- 冷数据: 仅在加入 / 聊天 / 展示时访问 ---
+    QString         name;
+    QString         clientId;
+    QString         language;
+    QTextCodec*     codec                   = nullptr;
+    QHostAddress    extIp;
+    QHostAddress    intIp;
+    quint16         extPort                 = 0;
+    quint16         intPort                 = 0;
 };
 
 // =========================================================
-// 4. 玩家重新加入 (Player Rejoin)
+// 3.1 玩家表 (PlayerTable)
+// ---------------------------------------------------------
+// PID 只会落在 1..12，用按 PID 直接下标的定长数组 + 占用位图
+// 取代 QMap<quint8, PlayerData>: 没有红黑树节点分配，条目在内存中
+// 连续排列，遍历按位图升序跳过空位 (与 QMap 的键序一致)。
+// 接口保持 QMap 子集 (contains / operator[] / value / insert / remove /
+// 迭代器 key() value())，现有调用点无需改写。
 // =========================================================
-struct PlayerRejoin {
-    qint64          leaveTime;
-    bool            isVisualHost;
+class PlayerTable
+{
+public:
+    static const int CAPACITY = 16;         // 下标 0 保留 (无效 PID)
+
+    template <bool IsConst>
+    class Iterator
+    {
+    public:
+        using Table = typename std::conditional<IsConst, const PlayerTable, PlayerTable>::type;
+        using Value = typename std::conditional<IsConst, const PlayerData, PlayerData>::type;
+
+        Iterator(Table *table, int pid) : m_table(table), m_pid(pid) {}
+        Iterator(const Iterator<false> &other) : m_table(other.m_table), m_pid(other.m_pid) {}
+
+        quint8 key() const                          { return (quint8)m_pid; }
+        Value &value() const                        { return m_table->m_entries[m_pid]; }
+        Value &operator*() const                    { return value(); }
+        Value *operator->() const                   { return &value(); }
+        Iterator &operator++()                      { m_pid = m_table->nextPid(m_pid + 1); return *this; }
+        bool operator==(const Iterator &o) const    { return m_pid == o.m_pid; }
+        bool operator!=(const Iterator &o) const    { return m_pid != o.m_pid; }
+
+    private:
+        friend class Iterator<!IsConst>;
+        Table   *m_table;
+        int     m_pid;
+    };
+
+    using iterator          = Iterator<false>;
+    using const_iterator    = Iterator<true>;
+
+    bool contains(quint8 pid) const     { return pid < CAPACITY && (m_mask & (1u << pid)); }
+    int size() const                    { return qPopulationCount(m_mask); }
+    bool isEmpty() const                { return m_mask == 0; }
+
+    // 与 QMap 一致: 不存在时插入默认条目; 越界 PID 落到不入表的临时条目
+    PlayerData &operator[](quint8 pid)
+    {
+        if (pid == 0 || pid >= CAPACITY) {
+            m_scratch = PlayerData();
+            return m_scratch;
+        }
+        m_mask |= (1u << pid);
+        return m_entries[pid];
+    }
+    const PlayerData operator[](quint8 pid) const   { return value(pid); }
+    PlayerData value(quint8 pid) const              { return contains(pid) ? m_entries[pid] : PlayerData(); }
+
+    void insert(quint8 pid, const PlayerData &data)
+    {
+        if (pid == 0 || pid >= CAPACITY) return;
+        m_entries[pid] = data;
+        m_mask |= (1u << pid);
+    }
+
+    int remove(quint8 pid)
+    {
+        if (!contains(pid)) return 0;
+        m_entries[pid] = PlayerData();
+        m_mask &= ~(1u << pid);
+        return 1;
+    }
+
+    void clear()
+    {
+        for (int pid = nextPid(0); pid < CAPACITY; pid = nextPid(pid + 1)) m_entries[pid] = PlayerData();
+        m_mask = 0;
+    }
+
+    iterator begin()                    { return iterator(this, nextPid(0)); }
+    iterator end()                      { return iterator(this, CAPACITY); }
+    const_iterator begin() const        { return const_iterator(this, nextPid(0)); }
+    const_iterator end() const          { return const_iterator(this, CAPACITY); }
+    const_iterator constBegin() const   { return begin(); }
+    const_iterator constEnd() const     { return end(); }
+    iterator find(quint8 pid)           { return contains(pid) ? iterator(this, pid) : end(); }
+    const_iterator constFind(quint8 pid) const { return contains(pid) ? const_iterator(this, pid) : end(); }
+
+private:
+    int nextPid(int from) const
+    {
+        const quint32 rest = (from < CAPACITY) ? (m_mask >> from) : 0;
+        return rest ? from + qCountTrailingZeroBits(rest) : CAPACITY;
+    }
+
+    std::array<PlayerData, CAPACITY>    m_entries;
+    quint32                             m_mask      = 0;
+    PlayerData                          m_scratch;
 };
 
 // =========================================================
-// 5. 玩家动作数据 (Player Action)
+// 4. 玩家重新加入 (Player Rejoin)
 // =========================================================
-struct PlayerAction {
-    quint8          pid;
-    QByteArray      data;
+struct PlayerRejoin {
+    qint64          leaveTime;
+    bool            isVisualHost;
 };
 
 // =========================================================
-// 6. 多语言消息封装 (Multi-Language Message)
+// 5. 多语言消息封装 (Multi-Language Message)
 // =========================================================
 struct MultiLangMsg {
     QMap<QString, QString> msgs;
@@ -409,8 +508,46 @@ struct MultiLangMsg {
     }
 };
 
+// =========================================================
+// 6. 游戏心跳抖动统计 (Tick Jitter)
+// =========================================================
+// 记录每次 0x0C 实际触发时刻相对计划时刻的延迟 (100us 一档直方图)
+struct TickJitterStats {
+    static const int    BUCKET_US               = 100;
+    static const int    BUCKET_COUNT            = 500;      // 覆盖 0 ~ 50ms，超出计入最后一档
+
+    quint32             buckets[BUCKET_COUNT + 1] = {};
+    quint64             samples                 = 0;
+    quint64             missedTicks             = 0;        // 因阻塞被合并的心跳数
+    qint64              maxLateUs               = 0;
+
+    void reset() { *this = TickJitterStats(); }
+
+    void record(qint64 lateUs) {
+        if (lateUs < 0) lateUs = 0;
+        int index = (int)qMin<qint64>(lateUs / BUCKET_US, BUCKET_COUNT);
+        buckets[index]++;
+        samples++;
+        if (lateUs > maxLateUs) maxLateUs = lateUs;
+    }
+
+    // 百分位 (返回该档上界, 单位 us)
+    qint64 percentileUs(double p) const {
+        if (samples == 0) return 0;
+        quint64 target = (quint64)(samples * p);
+        if (target >= samples) target = samples - 1;
+        quint64 seen = 0;
+        for (int i = 0; i <= BUCKET_COUNT; ++i) {
+            seen += buckets[i];
+            if (seen > target) return qMin<qint64>((qint64)(i + 1) * BUCKET_US, maxLateUs);
+        }
+        return maxLateUs;
+    }
+};
+
 // 前置声明
 class BnetSRP3;
+class UdpBatchSocket;
 
 // =========================================================
 // Client 类定义
@@ -420,10 +557,12 @@ class Client : public QObject
 {
     Q_OBJECT
     friend class Command;
+    friend class War3BotBench;
 
 public:
     static const quint8 BNET_HEADER = 0xFF;
-    static const int MAX_CHUNK_SIZE = 1442;
+    static const int MAX_CHUNK_SIZE = MAP_PART_CHUNK_SIZE;
+    static const int ACTION_ARENA_RESERVE = 16 * 1024;
 
     explicit Client(QObject *parent = nullptr);
     ~Client();
@@ -467,6 +606,7 @@ public:
     void setMaxDownloadSpeed(quint32 kbps);                                                                     // 设置地图最大下载数度
     quint16 getGameTickInterval() const;                                                                        // 获取发送频率
     void setGameTickInterval(quint16 interval = 50);                                                            // 设置发送频率
+    TickJitterStats getTickJitterStats() const;                                                                 // 获取心跳抖动统计
     bool hasPlayerByClientId(const QString &clientId) const;                                                    // 房间是否存在玩家
     bool hasPlayerByUserName(const QString &userName) const;                                                    // 房间是否存在玩家
     void setPlayerReadyStates(const QString &clientId, const QString &name, bool ready);                        // 设置玩家准备状态
@@ -495,7 +635,7 @@ public:
     void dumpPacket(const QByteArray &bytes);                                                                   // 抓取数据报数据
     QString getBnetPacketName(BNCSPacketID id);                                                                 // 获取对应的包名
     QString stripColorCodes(const QString &text);                                                               // 移除颜色代码
-    const QMap<quint8, PlayerData> &getPlayers() const;                                                         // 获取玩家数据
+    const PlayerTable &getPlayers() const;                                                                      // 获取玩家数据 (仅限所属分片线程，勿整表按值拷贝)
     QString getCodecNameByLanguage(const QString &lang);                                                        // 获取对应的编码
     void writeIpToStreamWithLog(QDataStream &out, const QHostAddress &ip);                                      // Ip地址写入流
     QString translateSocketError(QAbstractSocket::SocketError err, const QString &errString);
@@ -536,6 +676,11 @@ public:
     void sendAccessDeniedMessage(quint8 targetPid, const QString &command);
     void sendStartConditionFailedMessage(quint8 targetPid, int current, int required);
 
+    // --- 发送队列 (每轮事件循环每玩家合并为一次写出) ---
+    void queuePacket(PlayerData &playerData, const QByteArray &packet);
+    void flushPlayerOutbound(PlayerData &playerData);
+    void flushOutbound();
+
     // --- 消息广播 ---
     void broadcastPacket(const QByteArray &packet, quint8 excludePid, bool includeOnly = false);
     void broadcastChatMessage(const MultiLangMsg &msg, quint8 excludePid = 0);
@@ -562,15 +707,16 @@ signals:
     void gameStateChanged(const QString &clientId, GameState gameState);
     void gameCreateSuccess(CommandSource commandSource, bool isHotRefresh);
     void playerTransitioned(const QString &clientId, quint8 pid, const QString &playerName);
+    void playerMembershipChanged(const QString &clientId, const QString &playerName, bool joined);
     void requestCreateGame(const QString &username, const QString &gameName, CommandSource commandSource);
 
 private slots:
     void onGameTick();
+    void scheduleNextGameTick();
     void onConnected();
     void onGameStarted();
     void onDisconnected();
     void onTcpReadyRead();
-    void onUdpReadyRead();
     void onNewConnection();
     void onProtectionTimeout();
     void onPlayerReadyRead();
@@ -587,8 +733,13 @@ private:
     // 玩家管理
     QList<QTcpSocket*>              m_playerSockets;
     QMap<QTcpSocket*, QByteArray>   m_playerBuffers;
-    QMap<quint8, PlayerData>        m_players;
+    PlayerTable                     m_players;
+    QHash<QTcpSocket*, quint8>      m_pidBySocket;          // 玩家索引: 加入/离开/接管时同步维护
+    QHash<QString, quint8>          m_pidByClientId;
+    QHash<QString, quint8>          m_pidByName;            // 键为小写名字
     QMap<QString, PlayerRejoin>     m_rejoinCooldowns;
+    TimingWheel<QString>            m_rejoinWheel;          // 重入冷却到期后移出 m_rejoinCooldowns
+    TimingWheel<quint8>             m_playerTimeoutWheel;   // 每名玩家下一次需要复查超时的时间
 
     // 频道管理
     QStringList                     m_channelList;
@@ -601,13 +752,19 @@ private:
 
     // 游戏数据
     GameConfig                      m_gameConfig;
-    QList<PlayerAction>             m_actionQueue;
+    QByteArray                      m_actionArena;          // 本周期 0x0C 包 (按最终线格式直接拼接)
+    int                             m_actionCount           = 0;
+    bool                            m_actionArenaSent       = false;
     quint32                         m_hostCounter           = 0;
     quint32                         m_randomSeed            = 0;
 
+    // 发送队列
+    bool                            m_outboundFlushScheduled = false;
+
     // 地图下载
     War3Map                         m_war3Map;
-    QByteArray                      m_mapData;
+    QByteArray                      m_mapData;              // 指向 War3Map 共享映射的只读视图
+    QByteArray                      m_mapPartHeaders;
     quint32                         m_mapSize               = 0;
     quint32                         m_maxDownloadSpeed      = 1000;
 
@@ -632,6 +789,7 @@ private:
     QString                         m_serverAddr;
     quint16                         m_serverPort            = 0;
     QUdpSocket                      *m_udpSocket            = nullptr;
+    UdpBatchSocket                  *m_udpIo                = nullptr;
     QTcpSocket                      *m_tcpSocket            = nullptr;
     QTcpServer                      *m_tcpServer            = nullptr;
 
@@ -639,6 +797,10 @@ private:
     QTimer                          *m_pingTimer            = nullptr;
     QTimer                          *m_startTimer           = nullptr;
     QTimer                          *m_gameTickTimer        = nullptr;
+    QElapsedTimer                   m_tickClock;                        // 单调时钟
+    qint64                          m_nextTickDeadlineNs    = 0;
+    qint64                          m_lastTickSentMs        = 0;     // 已下发给客户端的游戏时间 (毫秒)
+    TickJitterStats                 m_tickJitter;
     QTimer                          *m_startLagTimer        = nullptr;
     QTimer                          *m_rotectionTimeoutTimer   = nullptr;
     quint16                         m_gameStartLag          = 1000;
@@ -681,6 +843,8 @@ private:
     QByteArray createW3GSStartDownloadPacket(quint8 fromPid);
     QByteArray createW3GSRejectJoinPacket(RejectReason reason);
     QByteArray createW3GSIncomingActionPacket (quint16 sendInterval);
+    void appendIncomingAction(quint8 pid, const char *data, int len);
+    void resetActionArena();
     QByteArray createW3GSPlayerLeftPacket(quint8 pid, LeaveReason reason);
     QByteArray createChatCommandPacket(const QString &user, const QString &text);
     QByteArray createW3GSSlotInfoJoinPacket(quint8 playerID, const QHostAddress& externalIp, quint16 localPort);
@@ -707,6 +871,11 @@ private:
     // --- 状态管理 ---
     void checkAllPlayersLoaded();
 
+    // --- 玩家索引 ---
+    void indexPlayer(const PlayerData &playerData);
+    void unindexPlayer(const PlayerData &playerData);
+    void clearPlayers();
+
     // --- 地图管理 ---
     void initiateMapDownload(quint8 pid);
     void setMapData(const QByteArray &data);
@@ -725,4 +894,8 @@ private:
     QByteArray calculateOldLogonProof(const QString &password, quint32 clientToken, quint32 serverToken);
 };
 
+// 跨线程 (分片 -> BotManager) 排队信号所需的元类型
+Q_DECLARE_METATYPE(GameCreationStatus)
+Q_DECLARE_METATYPE(GameState)
+
 #endif // CLIENT_H
@@ -0,0 +1,102 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QList>
+#include <memory>
+
+// =========================================================
+// War3BotLoadGen: 本地负载发生器 (独立可执行文件 War3BotLoadGen)
+// ---------------------------------------------------------
+// 对本机运行的 War3Bot 实例模拟完整的玩家链路:
+//   控制协议: UDP C_S_REGISTER -> TCP 心跳绑定 -> /host /ready /start
+//   游戏协议: W3GS REQJOIN -> 地图下载 ACK -> 0x26 动作流
+// 按房间数阶梯放大，统计加入延迟、下载吞吐、0x0C 节拍抖动与
+// 每房间 CPU 占用。LoadGenStubBnet 代替 PvPGN 完成机器人登录与开房。
+// =========================================================
+
+struct LoadGenOptions {
+    QString     host                = "127.0.0.1";
+    quint16     controlPort         = 6116;
+    QList<int>  roomSteps           { 1 };      // 每一阶梯同时开启的房间数
+    int         playersPerRoom      = 2;        // 含房主
+    QString     mode                = "solo";   // /host 模式 (solo 两人即可开局)
+    int         durationMs          = 10000;    // 开局后的采样时长
+    int         actionIntervalMs    = 100;      // 每个玩家发送 0x26 的间隔
+    int         actionBytes         = 24;       // 单个动作块大小
+    qint64      serverPid           = 0;        // War3Bot 实例 PID (Linux 下读取 /proc 统计 CPU)
+};
+
+struct LoadGenStepResult {
+    int             rooms           = 0;
+    int             roomsStarted    = 0;        // 成功进入游戏的房间
+    int             roomsFailed     = 0;
+    int             joinsFailed     = 0;
+    QVector<double> joinLatencyMs;              // REQJOIN -> SLOTINFOJOIN
+    QVector<double> downloadMBps;               // 单个玩家的地图下载吞吐
+    QVector<double> tickJitterMs;               // |0x0C 实际间隔 - 声明间隔|
+    qint64          ticksReceived   = 0;
+    qint64          actionsSent     = 0;
+    qint64          wallMs          = 0;
+    double          cpuMs           = -1.0;     // < 0 表示未统计
+};
+
+// ---------------------------------------------------------
+// LoadGenStubBnet: 最小化的 BNCS 桩服务
+// 只应答机器人登录、进频道与开房所需的报文，不做任何校验
+// ---------------------------------------------------------
+class LoadGenStubBnet
+{
+public:
+    LoadGenStubBnet();
+    ~LoadGenStubBnet();
+
+    bool listen(quint16 port);
+    quint16 port() const                { return m_server.serverPort(); }
+    int loginCount() const              { return m_logins; }
+    int gameCount() const               { return m_games; }
+
+private:
+    void onNewConnection();
+    void onReadyRead(QTcpSocket *socket);
+    void handlePacket(QTcpSocket *socket, quint8 id, const QByteArray &payload);
+
+    struct Session {
+        QByteArray  buffer;
+        QByteArray  username;
+    };
+
+    QTcpServer                          m_server;
+    QHash<QTcpSocket*, Session>         m_sessions;
+    int                                 m_logins = 0;
+    int                                 m_games = 0;
+};
+
+class War3BotLoadGen
+{
+public:
+    explicit War3BotLoadGen(const LoadGenOptions &options);
+    ~War3BotLoadGen();
+
+    // stubBnetPort > 0 时同进程启动 BNET 桩服务；结果 JSON 写入 outputPath ("-" 或空 = 标准输出)
+    int run(const QString &outputPath, quint16 stubBnetPort = 0);
+
+    // 只运行 BNET 桩服务直到进程退出 (先于 War3Bot 实例启动，供机器人登录)
+    static int runStubBnet(quint16 port);
+
+private:
+    LoadGenStepResult runStep(int stepIndex, int rooms);
+    QJsonObject toJson() const;
+
+    LoadGenOptions                      m_options;
+    QString                             m_nonce;        // 本次运行的名字前缀，避免与残留房间/冷却重名
+    QVector<LoadGenStepResult>          m_results;
+    std::unique_ptr<LoadGenStubBnet>    m_stubBnet;
+};
+
+#endif // LOADGEN_H
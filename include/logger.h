@@ -3,9 +3,84 @@
 
 #include <QFile>
 #include <QMutex>
+#include <QPair>
 #include <QObject>
+#include <QThread>
+#include <QVector>
 #include <QDateTime>
 #include <QTextStream>
+#include <QWaitCondition>
+#include <QVarLengthArray>
+#include <type_traits>
+#include <atomic>
+
+struct LogRing;
+
+// =========================================================
+// 延迟格式化参数
+// ---------------------------------------------------------
+// 只捕获值 (数值直接存, QString 仅增加引用计数, 字节数组复制要显示的前缀),
+// 真正的字符串拼接在写线程 (或同步模式下的 log 调用) 中完成。
+// 注意: const char* 参数只允许传字符串字面量。
+// =========================================================
+struct LogArg
+{
+    enum Type : quint8 { Int, UInt, Double, Latin, Str, Hex };
+
+    Type        type        = Int;
+    union {
+        qint64      i;
+        quint64     u;
+        double      d;
+        const char *latin;
+    };
+    QString     str;
+    QByteArray  bytes;
+    int         hexLimit    = 0;
+    int         hexTotal    = 0;        // 原始字节数 (bytes 只保留前 hexLimit 字节)
+    bool        hexSpaced   = true;
+
+    LogArg() : i(0) {}
+    LogArg(const QString &v) : type(Str), i(0), str(v) {}
+    LogArg(const char *v) : type(Latin), latin(v) {}
+    LogArg(const QByteArray &) = delete;    // 字节数组请用 LogHex()
+    LogArg(double v) : type(Double), d(v) {}
+    LogArg(float v) : type(Double), d(v) {}
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, int>::type = 0>
+    LogArg(T v)
+    {
+        if (std::is_signed<T>::value) { type = Int; i = (qint64)v; }
+        else { type = UInt; u = (quint64)v; }
+    }
+
+    QString render() const;
+};
+
+// 十六进制转储参数: 最多显示 limit 字节, 超出部分以 "... (Total N bytes)" 结尾
+// 显示的前缀会被深拷贝: 写线程格式化时调用方的缓冲区可能已被复用或释放
+// (例如 fromRawData 包装的 recvmmsg 槽位)，不能只持有浅拷贝。
+inline LogArg LogHex(const QByteArray &data, int limit = 256, bool spaced = true)
+{
+    const int shown = (limit > 0) ? qMin(data.size(), limit) : data.size();
+    LogArg arg;
+    arg.type = LogArg::Hex;
+    arg.bytes = QByteArray(data.constData(), shown);
+    arg.hexTotal = data.size();
+    arg.hexLimit = limit;
+    arg.hexSpaced = spaced;
+    return arg;
+}
+
+// 一条延迟格式化的日志: 格式串 (字面量, %1..%9 占位) + 参数 + 产生时刻
+struct LogDeferred
+{
+    const char                  *format     = nullptr;
+    QVarLengthArray<LogArg, 6>  args;
+    qint64                      msecs       = 0;
+
+    QString render() const;
+};
 
 class Logger : public QObject
 {
@@ -20,6 +95,12 @@ public:
         LOG_CRITICAL = 4
     };
 
+    // 异步模式下队列满时的处理策略
+    enum OverflowPolicy {
+        Overflow_Drop = 0,      // 丢弃新日志并计数 (不阻塞业务线程)
+        Overflow_Block = 1      // 阻塞等待写线程腾出空间
+    };
+
     static Logger *instance();
     static void destroyInstance();
 
@@ -40,6 +121,30 @@ public:
     void setBackupCount(int count);
     void enableConsoleOutput(bool enable);
 
+    // === 异步模式 ===
+    // 生产者只负责格式化并入队 (无锁 MPSC 环形队列)，由后台写线程批量落盘/输出/轮转
+    void setAsyncMode(bool enable, int queueSize = 8192, OverflowPolicy policy = Overflow_Block);
+    bool isAsyncMode() const { return m_async.load(std::memory_order_acquire); }
+    quint64 droppedCount() const { return m_droppedCount.load(std::memory_order_relaxed); }
+    quint64 blockedCount() const { return m_blockedCount.load(std::memory_order_relaxed); }
+
+    // === 延迟格式化 ===
+    // 配合 LOG_xxx_F 宏使用: 级别不满足时参数表达式根本不会求值
+    // 参数按值捕获 (packed 结构体字段也可直接传入)
+    template <typename... Args>
+    void logDeferred(LogLevel level, const char *format, Args... args)
+    {
+        LogDeferred record;
+        record.format = format;
+        record.msecs = QDateTime::currentMSecsSinceEpoch();
+        (record.args.append(LogArg(args)), ...);
+        submitDeferred(level, std::move(record));
+    }
+
+    static OverflowPolicy overflowPolicyFromString(const QString &policyStr) {
+        return policyStr.toLower() == "drop" ? Overflow_Drop : Overflow_Block;     // 默认不丢日志
+    }
+
     void debug(const QString &message);
     void info(const QString &message);
     void warning(const QString &message);
@@ -76,10 +181,19 @@ private:
     ~Logger();
 
     void log(LogLevel level, const QString &message, int depth = 0);
+    QString formatMessage(LogLevel level, const QString &message, int depth, qint64 msecs = 0) const;
+    void submitDeferred(LogLevel level, LogDeferred &&record);
+    void writeRecord(LogLevel level, const QString &logMessage);
+    bool enqueueRecord(LogLevel level, LogDeferred &&record);
+    void writerLoop(LogRing *ring);
+    void writeBatch(const QVector<QPair<LogLevel, QString>> &batch);
+    void stopAsyncWriter();
     bool rotateLogFileIfNeeded();
     bool performLogRotation();
     void consoleOutput(LogLevel level, const QString &message);
     void consoleOutput(const QString &message, bool isError = false);
+    void writeConsole(const QString &text, bool toStderr);
+    static QString levelColor(LogLevel level);
 
 private:
     static Logger *m_instance;
@@ -94,6 +208,20 @@ private:
     qint64 m_maxFileSize;
     int m_backupCount;
     bool m_disabled;
+
+    // 异步写入
+    std::atomic<LogRing *> m_ring;
+    std::atomic<int> m_producers;       // 已取得 m_ring 尚未入队完成的生产者数
+    QThread *m_writerThread;
+    QMutex m_wakeMutex;
+    QWaitCondition m_wakeCond;
+    std::atomic<bool> m_async;
+    std::atomic<bool> m_stopWriter;
+    std::atomic<bool> m_writerIdle;
+    std::atomic<quint64> m_droppedCount;
+    std::atomic<quint64> m_blockedCount;
+    quint64 m_reportedDropped;
+    OverflowPolicy m_overflowPolicy;
 };
 
 // 宏定义便于使用
@@ -127,4 +255,29 @@ if (Logger::instance()->shouldLog(Logger::LogLevel::LOG_DEBUG)) { \
     } \
 } while(0)
 
+// 延迟格式化版本: LOG_INFO_F("   ├─ 📦 数据: %1 (%2 bytes)", LogHex(data), data.size());
+#define LOG_DEBUG_F(...) do { \
+    if (Logger::instance()->shouldLog(Logger::LogLevel::LOG_DEBUG)) { \
+            Logger::instance()->logDeferred(Logger::LogLevel::LOG_DEBUG, __VA_ARGS__); \
+    } \
+} while(0)
+
+#define LOG_INFO_F(...) do { \
+    if (Logger::instance()->shouldLog(Logger::LogLevel::LOG_INFO)) { \
+            Logger::instance()->logDeferred(Logger::LogLevel::LOG_INFO, __VA_ARGS__); \
+    } \
+} while(0)
+
+#define LOG_WARNING_F(...) do { \
+    if (Logger::instance()->shouldLog(Logger::LogLevel::LOG_WARNING)) { \
+            Logger::instance()->logDeferred(Logger::LogLevel::LOG_WARNING, __VA_ARGS__); \
+    } \
+} while(0)
+
+#define LOG_ERROR_F(...) do { \
+    if (Logger::instance()->shouldLog(Logger::LogLevel::LOG_ERROR)) { \
+            Logger::instance()->logDeferred(Logger::LogLevel::LOG_ERROR, __VA_ARGS__); \
+    } \
+} while(0)
+
 #endif // LOGGER_H
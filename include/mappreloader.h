@@ -0,0 +1,58 @@
+#ifndef MAPPRELOADER_H
+#define MAPPRELOADER_H
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QObject>
+#include <atomic>
+
+// =========================================================
+// MapPreloader: 启动阶段并行预加载地图库
+// ---------------------------------------------------------
+// 扫描配置的地图目录，把每个 .w3x / .w3m 交给线程池执行
+// War3Map::load，结果进入 War3Map 的共享缓存；之后房间
+// 创建时的 load 直接命中缓存，不再在主线程上解析 MPQ。
+// =========================================================
+class MapPreloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MapPreloader(QObject *parent = nullptr);
+    ~MapPreloader();
+
+    // 扫描目录并开始预加载 (threads <= 0 时使用 CPU 核心数)
+    int start(const QStringList &mapDirs, int threads = 0);
+
+    // 取消: 尚未开始的任务直接跳过，正在解析的地图跑完为止
+    void cancel();
+    bool waitForDone(int msecs = -1);
+
+    bool isRunning()                const { return m_running.load(std::memory_order_acquire); }
+    int totalCount()                const { return m_total; }
+    int finishedCount()             const { return m_finished.load(std::memory_order_relaxed); }
+
+    // 从配置字符串解析目录列表 (以 ; 或 , 分隔，空则使用默认 war3files/maps 搜索路径)
+    static QStringList resolveMapDirs(const QString &configValue);
+
+signals:
+    void progress(int finished, int total);
+    void finished(int loaded, int failed, int skipped, qint64 elapsedMs);
+
+private:
+    void runTask(const QString &mapPath);
+
+    QThreadPool                 m_pool;
+    QElapsedTimer               m_timer;
+    int                         m_total = 0;
+    int                         m_progressStep = 1;
+    std::atomic<bool>           m_running { false };
+    std::atomic<bool>           m_cancelled { false };
+    std::atomic<int>            m_finished { 0 };
+    std::atomic<int>            m_loaded { 0 };
+    std::atomic<int>            m_failed { 0 };
+    std::atomic<int>            m_skipped { 0 };
+};
+
+#endif // MAPPRELOADER_H
@@ -3,6 +3,7 @@
 
 #include "protocol.h"
 #include "securitywatchdog.h"
+#include "sessionregistry.h"
 
 #include <QMap>
 #include <QTimer>
@@ -13,8 +14,10 @@
 #include <QTcpSocket>
 #include <QHostAddress>
 #include <QReadWriteLock>
-#include <QNetworkDatagram>
 #include <QDateTime>
+#include <QVector>
+#include <QThread>
+#include <atomic>
 
 // NAT类型枚举
 enum NATType {
@@ -43,29 +46,13 @@ enum PingSearchMode {
     ByBoth     = 2
 };
 
-struct RegisterInfo {
-    QString clientId;
-    QString hardwareId;
-    QString username;
-    QString localIp;
-    quint64 localPort;
-    QString publicIp;
-    quint64 publicPort;
-    quint32 sessionId;
-    quint64 lastSeq;
-    quint64 lastSeen;
-    quint64 firstSeen;
-    QString crcToken;
-    quint32 natType;
-    bool isRegistered;
-};
-
 struct PreJoinData {
     QString clientId;
     quint8 source;
 };
 
 class BotManager;
+class UdpBatchSocket;
 
 class NetManager : public QObject
 {
@@ -80,7 +67,7 @@ public:
     bool startServer(quint64 port, const QString &configFile = "war3bot.ini");
     void stopServer();
     bool isRunning() const;
-    QByteArray getAppSecret() const;
+    static QByteArray getAppSecret();
     QList<RegisterInfo> getOnlinePlayers() const;
     PreJoinData getClientIdByPreJoinName(const QString &playerName);
     bool isClientRegistered(const QString &clientId) const;
@@ -102,7 +89,6 @@ signals:
     void roomPingReceived(const QHostAddress &senderAddr, quint16 senderPort, const QString &targetClientId, quint64 clientTime, PingSearchMode mode);
 
 private slots:
-    void onUDPReadyRead();
     void onTcpReadyRead();
     void onCleanupTimeout();
     void onTcpDisconnected();
@@ -113,15 +99,21 @@ private:
     void handleTcpPing(QTcpSocket *socket);
     void handleTcpUploadMessage(QTcpSocket *socket);
     void handleTcpCustomMessage(QTcpSocket *socket);
-    void handleIncomingDatagram(const QNetworkDatagram &datagram);
+    // 数据报校验 (可在接收工作线程调用) 与分发 (主线程)
+    enum DatagramVerdict { DatagramDrop, DatagramPing, DatagramValid };
+    DatagramVerdict inspectDatagram(char *data, int size, const QHostAddress &senderAddr, quint16 senderPort);
+    void handleIncomingDatagram(char *data, int size, const QHostAddress &senderAddr, quint16 senderPort);
+    void handleWorkerDatagram(UdpBatchSocket *io, char *data, int size, const QHostAddress &senderAddr, quint16 senderPort);
+    void dispatchDatagram(const PacketHeader *header, const char *payload, const QHostAddress &senderAddr, quint16 senderPort);
     void handleCommand(const PacketHeader *header, const CSCommandPacket *packet);
-    void handleUdpPing(const PacketHeader *header, const QHostAddress &senderAddr, quint64 senderPort);
+    void handleUdpPing(const PacketHeader *header, const QHostAddress &senderAddr, quint64 senderPort, UdpBatchSocket *io = nullptr);
     void handleUnregister(const PacketHeader *header, const QHostAddress &senderAddr, quint64 senderPort);
     void handleRoomPing(const PacketHeader *header, const char *payload, const QHostAddress &addr, quint16 port);
     void handleRegister(const PacketHeader *header, const CSRegisterPacket *packet, const QHostAddress &senderAddr, quint64 senderPort);
     void handleCheckMapCRC(const PacketHeader *header, const CSCheckMapCRCPacket *packet, const QHostAddress &senderAddr, quint64 senderPort);
 
     qint64 sendUdpPacket(const QHostAddress &target, quint64 port, PacketType type, const void *payload = nullptr, quint64 payloadLen = 0, quint32 sessionId = 0);
+    qint64 sendUdpPacketVia(UdpBatchSocket *io, const QHostAddress &target, quint64 port, PacketType type, const void *payload, quint64 payloadLen, quint32 sessionId);
     void sendUploadResult(QTcpSocket *socket, const QString &crc, const QString &fileName, bool success, UploadErrorCode reason);
     bool sendTcpPacket(QTcpSocket *socket, PacketType type, const void *payload, quint64 payloadLen, quint32 sessionId = 0);
     bool sendToClient(const QString &clientId, const QByteArray &data);
@@ -135,6 +127,9 @@ private:
     void updateMostFrequentCrc();
     void cleanupExpiredClients();
     bool bindSocket(quint64 port);
+    int openReusePortSocket(quint64 port);
+    bool startUdpWorkers(quint64 port);
+    void stopUdpWorkers();
     bool isValidFileName(const QString &name);
     void kickUserIfOnline(const QString &username);
     void removeClientInternal(const QString &clientId);
@@ -150,6 +145,8 @@ private:
 
     bool m_isRunning;
     bool m_enableBroadcast;
+    bool m_traceDatagrams = false;
+    int m_udpWorkerCount = 1;
     int m_cleanupInterval;
     int m_broadcastInterval;
     quint64 m_peerTimeout;
@@ -163,10 +160,16 @@ private:
 
     QUdpSocket *m_udpSocket;
     QTcpServer *m_tcpServer;
+    UdpBatchSocket *m_udpIo;
+
+    // SO_REUSEPORT 接收工作线程 (主线程的 m_udpSocket 也在同一端口组内)
+    struct UdpWorker {
+        QThread *thread;
+        QUdpSocket *socket;
+    };
+    QVector<UdpWorker> m_udpWorkers;
 
     QMap<QString, QPointer<QTcpSocket>> m_tcpClients;
-    QMap<quint32, QString> m_sessionIndex;
-    QMap<QString, int> m_crcCounts;
     QSet<QString> m_allowedCrcMaps;
     QString m_crcRootPath;
 
@@ -177,14 +180,14 @@ private:
     QMap<QString, quint32> m_pendingUploadTokens;
 
     quint32 m_nextSessionId;
-    quint64 m_serverSeq;
+    std::atomic<quint64> m_serverSeq;
 
     SecurityWatchdog m_watchdog;
     QSet<QString> m_bannedHwids;
     QReadWriteLock m_bannedListLock;
-public:
-    mutable QReadWriteLock m_registerInfosLock;
-    QMap<QString, RegisterInfo> m_registerInfos;
+
+    // 在线会话表 (分片加锁，sessionId 直达，CRC 人数增量维护，超时由内部时间轮驱动)
+    SessionRegistry m_sessions { 1000 };
 };
 
 #endif // NETMANAGER_H
@@ -0,0 +1,35 @@
+#ifndef PACKETSIGNER_H
+#define PACKETSIGNER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+// =========================================================
+// PacketSigner: 控制协议 (PacketHeader) 签名
+// ---------------------------------------------------------
+// 线上格式不变: signature = SHA-256(整包 || AppSecret) 的前 16 字节。
+// 摘要在栈上的定长上下文中分段计算，不拼接 "包 + 密钥"、不产生
+// QByteArray，NetManager / Client / 压测客户端共用同一实现。
+// 密钥位于消息尾部，无法像 HMAC 那样缓存密钥前缀的中间状态，
+// 这里只把密钥固化为静态常量 (不再每包构造)。
+// =========================================================
+
+namespace PacketSigner {
+
+const int SIGNATURE_SIZE = 16;
+
+// 共享密钥 (fromRawData，不分配)
+QByteArray appSecret();
+
+// 对 data[0, len) 追加密钥后求 SHA-256，输出前 16 字节
+void sign(const char *data, int len, char *out);
+
+// 与 sign 的结果比较 (耗时与不匹配位置无关)
+bool verify(const char *data, int len, const char *expected);
+
+// 标准 SHA-256 (32 字节输出，与 QCryptographicHash::Sha256 一致)
+void sha256(const void *data, int len, unsigned char *out);
+
+}
+
+#endif // PACKETSIGNER_H
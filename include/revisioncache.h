@@ -0,0 +1,55 @@
+#ifndef REVISIONCACHE_H
+#define REVISIONCACHE_H
+
+#include <QWaitCondition>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <atomic>
+
+// =========================================================
+// CheckRevisionCache: 进程级版本校验结果缓存
+// ---------------------------------------------------------
+// PvPGN 下发的 formula / MPQ 组合很少，而 checkRevisionFlat
+// 每次都要完整哈希 War3.exe / Storm.dll / Game.dll。
+// 以 "formula + MPQ 编号 + 三个文件的路径/大小/修改时间" 为键缓存
+// 校验和，同一组合只计算一次；文件被替换后键自然变化而失效。
+// 可选持久化到 War3.exe 同目录的 checkrevision.idx，重启后直接命中。
+// =========================================================
+class CheckRevisionCache
+{
+public:
+    // 返回校验和; 失败返回 false。hit 非空时回填是否命中缓存
+    static bool checkRevision(const QByteArray &formula, const QString &exePath,
+                              const QString &stormPath, const QString &gamePath,
+                              int mpqNumber, quint32 *checkSum, bool *hit = nullptr);
+
+    static void setPersistent(bool enabled);
+    static void clear();
+
+    static quint64 hits()           { return s_hits.load(std::memory_order_relaxed); }
+    static quint64 misses()         { return s_misses.load(std::memory_order_relaxed); }
+    static int size();
+
+private:
+    static QString buildKey(const QByteArray &formula, const QString &exePath,
+                            const QString &stormPath, const QString &gamePath, int mpqNumber);
+    static void loadIndexLocked(const QString &indexPath);
+    static QHash<QString, quint32> snapshotIndexLocked(const QString &indexPath);
+    static void saveIndex(const QString &indexPath, const QHash<QString, quint32> &entries, quint64 generation);
+
+    static QMutex                       s_mutex;
+    static QWaitCondition               s_computed;
+    static QHash<QString, quint32>      s_entries;
+    static QSet<QString>                s_computing;        // 正在计算的键 (同键的其他线程等待结果)
+    static QSet<QString>                s_loadedIndexes;    // 已读入的持久化文件
+    static bool                         s_persistent;
+    static quint64                      s_generation;       // 快照序号 (受 s_mutex 保护)
+    static QMutex                       s_saveMutex;        // 串行化落盘，不与 s_mutex 嵌套
+    static QHash<QString, quint64>      s_savedGenerations; // 各索引文件已写入的快照序号
+    static std::atomic<quint64>         s_hits;
+    static std::atomic<quint64>         s_misses;
+};
+
+#endif // REVISIONCACHE_H
@@ -1,21 +1,23 @@
 #ifndef SECURITYWATCHDOG_H
 #define SECURITYWATCHDOG_H
 
+#include <QReadWriteLock>
 #include <QHostAddress>
-#include <QDateTime>
 #include <QObject>
-#include <QTimer>
-#include <QMutex>
 #include <QHash>
-#include <QSet>
+#include <array>
+#include <atomic>
 
 #include "protocol.h"
 
 // ================= 配置常量 =================
 #define BAN_BASE_TIME_MS 60000          // 基础封禁1分钟
-#define MAX_IP_STATS_SIZE 100000        // 最大记录数
-#define RECORD_TIMEOUT_MS 600000        // 10分钟无活动清理
-#define CLEANUP_INTERVAL_MS 30000       // 30秒清理一次
+#define RECORD_TIMEOUT_MS 600000        // 10分钟无活动后，有 Session 的记录也可被替换
+
+// --- 记录表容量 (组相联，满组时替换最久未活动的记录，组内全部被占用时走组共享配额) ---
+#define IPV4_TABLE_SETS 16384           // IPv4: 16384 组 x 8 路 = 131072 条
+#define IPV6_TABLE_SETS 2048            // IPv6 (/64 前缀): 2048 组 x 8 路 = 16384 条
+#define TABLE_WAYS 8
 
 // --- 频率限制 (基于单个 Session) ---
 #define BASE_UDP_PER_SEC 150            // 握手/基础 UDP 频率
@@ -23,24 +25,29 @@
 #define MAX_TCP_PER_MIN_BASE 60         // 基础 TCP 频率
 #define EXTRA_TCP_PER_SESSION 20        // 每个有效在线 Session 增加的配额
 
-struct IpStats {
-    qint64 lastActivityTime = 0;
-
-    // Session 追踪 (解决 NAT 同 IP 问题)
-    QSet<quint32> activeSessions;
-
-    // UDP 统计
-    qint64 lastUdpResetTime = 0;
-    int udpPacketCount = 0;
-
-    // TCP 统计
-    qint64 lastTcpResetTime = 0;
-    int tcpConnCount = 0;
+// =========================================================
+// IpStats: 单个来源的限速记录 (独占一条缓存行)
+// ---------------------------------------------------------
+// 限速使用 GCRA 形式的令牌桶: udpTat / tcpTat 为 "理论到达时间" (微秒)，
+// 每个包用一次 CAS 把它推后 cost，超出当前时间的部分即桶内积压。
+// 所有字段都是原子量，检查路径不加锁。
+// =========================================================
+struct alignas(64) IpStats {
+    std::atomic<quint64> key            { 0 };  // 0 = 空, ~0 = 正在初始化
+    std::atomic<qint64> lastActivityTime{ 0 };  // 毫秒 (粗粒度单调时钟)
+    std::atomic<qint64> udpTat          { 0 };
+    std::atomic<qint64> tcpTat          { 0 };
+    std::atomic<qint64> banExpireTime   { 0 };  // 0 = 未封禁
+    std::atomic<int> violationCount     { 0 };
+    std::atomic<int> activeSessions     { 0 };  // 该来源下登记的在线 Session 数
+    std::atomic<int> flags              { 0 };  // 白名单 / 黑名单
+    std::atomic<quint32> generation     { 0 };  // 每次被占用时更新，用于识别替换前登记的 Session
+};
 
-    // 封禁状态
-    bool isBanned = false;
-    qint64 banExpireTime = 0;
-    int violationCount = 0;
+// 组共享令牌桶: 组内没有可用记录时，该组所有来源共用基础配额
+struct alignas(64) SetFallback {
+    std::atomic<qint64> udpTat          { 0 };
+    std::atomic<qint64> tcpTat          { 0 };
 };
 
 class SecurityWatchdog : public QObject
@@ -48,6 +55,7 @@ class SecurityWatchdog : public QObject
     Q_OBJECT
 public:
     explicit SecurityWatchdog(QObject *parent = nullptr);
+    ~SecurityWatchdog() override;
 
     // --- 业务同步接口 ---
     // 当 NetManager 验证 Session 成功或心跳活跃时调用
@@ -55,7 +63,7 @@ public:
     // 当 NetManager 清理过期 Session 时调用
     void markSessionInactive(const QHostAddress &ip, quint32 sessionId);
 
-    // --- 核心检查函数 ---
+    // --- 核心检查函数 (可在多个收包线程并发调用) ---
     bool checkUdpPacket(const QHostAddress &sender, int packetSize, PacketType packetType, quint32 sessionId = 0);
     bool checkTcpConnection(const QHostAddress &sender);
 
@@ -64,26 +72,53 @@ public:
     void addBlacklist(const QString &ip);
     void unban(const QString &ip);
 
-private slots:
-    void cleanupStaleRecords();
-
 private:
-    bool isIpBanned(quint32 ipInt, const QString &ipStr, IpStats &stats, qint64 now);
-    void triggerBan(quint32 ipInt, const QString &ipStr, IpStats &stats, const QString &reason);
-    quint32 parseIpToInt(const QHostAddress &addr) const;
+    enum StatsFlag { FlagWhitelist = 1, FlagBlacklist = 2 };
+
+    // 组相联记录表: 按键哈希到组，组内 8 路线性比较
+    struct StatsTable {
+        StatsTable(int sets, const char *name)
+            : sets(sets), name(name), slots(new IpStats[sets * TABLE_WAYS]), fallback(new SetFallback[sets]) {}
+        ~StatsTable() { delete[] slots; delete[] fallback; }
+
+        const int               sets;
+        const char              *name;
+        IpStats                 *slots;
+        SetFallback             *fallback;
+        std::atomic<quint64>    evictions   { 0 };
+        std::atomic<quint64>    overflows   { 0 };  // 整组都被占用 (名单 / 在线) 时改用组共享配额的次数
+    };
+
+    // 在线 Session 集合: (来源键, SessionId) -> 登记时记录的 generation，按哈希分片，各片一把读写锁
+    // 记录被替换后 generation 不再匹配，该 Session 再次出现时重新计数
+    struct alignas(64) SessionShard {
+        QReadWriteLock          lock;
+        QHash<quint64, quint32> pairs;
+    };
+    static const int SESSION_SHARDS = 64;
+
+    StatsTable *tableFor(const QHostAddress &addr, quint64 *key);
+    int setIndex(const StatsTable &table, quint64 key) const;
+    IpStats *findStats(StatsTable &table, quint64 key) const;
+    IpStats *acquireStats(StatsTable &table, quint64 key, qint64 nowMs);
+    bool checkFallback(StatsTable &table, quint64 key, bool isUdp, qint64 nowMs);
+    quint64 sessionPair(quint64 key, quint32 sessionId) const;
+    SessionShard &sessionShard(quint64 pair);
+    bool isKnownSession(quint64 key, quint32 sessionId, quint32 generation);
+
+    bool isIpBanned(const QHostAddress &addr, IpStats &stats, qint64 nowMs);
+    void triggerBan(const QHostAddress &addr, IpStats &stats, qint64 nowMs, const QString &reason);
 
     // 获取动态阈值
     int getDynamicUdpLimit(const IpStats &stats) const;
     int getDynamicTcpLimit(const IpStats &stats) const;
 
 private:
-    QMutex m_mutex;
-    QTimer *m_cleanupTimer;
-
-    QSet<quint32> m_whitelistInt;
-    QSet<quint32> m_blacklistInt;
-    QHash<quint32, IpStats> m_ipStats;
-    QHash<QString, IpStats> m_ipStatsFallback; // IPv6
+    const quint64 m_hashSeed;   // 启动时随机生成，外部无法构造落入同一组的地址
+    std::atomic<quint32> m_generation { 0 };
+    StatsTable m_ipStats;
+    StatsTable m_ipStatsV6;     // IPv6 按 /64 前缀聚合 (同一前缀通常属于同一用户)
+    std::array<SessionShard, SESSION_SHARDS> m_sessionShards;
 };
 
 #endif // SECURITYWATCHDOG_H
@@ -0,0 +1,142 @@
+#ifndef SESSIONREGISTRY_H
+#define SESSIONREGISTRY_H
+
+#include "timingwheel.h"
+
+#include <QSharedPointer>
+#include <QReadWriteLock>
+#include <QHostAddress>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <array>
+#include <atomic>
+
+struct RegisterInfo {
+    QString clientId;
+    QString hardwareId;
+    QString username;
+    QString localIp;
+    quint64 localPort;
+    QString publicIp;
+    quint64 publicPort;
+    quint32 sessionId;
+    quint64 lastSeq;
+    quint64 lastSeen;
+    quint64 firstSeen;
+    QString crcToken;
+    quint32 natType;
+    bool isRegistered;
+};
+
+// =========================================================
+// SessionRegistry: 分片加锁的在线会话表
+// ---------------------------------------------------------
+// 取代 NetManager 中 "一把读写锁 + clientId 主表 + sessionId 索引" 的结构:
+//   - 记录按 clientId 哈希落入 32 个分片之一，sessionId 索引按 sessionId 落片，
+//     两个索引都直接指向同一条记录 (QSharedPointer)，每个分片各自一把读写锁
+//   - 心跳 (touch) 只在 sessionId 分片上取读锁定位记录，lastSeen 与
+//     公网端点指纹是原子量，端点未变化时不取任何写锁、不构造字符串
+//   - 地图 CRC 的在线人数随 setCrcToken / 删除增量维护，无需全表重数
+//   - 超时由内部时间轮驱动，只复核到期的记录
+// 任何时刻最多持有一个分片锁 (分片锁之内只会再取 CRC 计数锁)，不存在锁顺序问题。
+// 记录的 clientId / sessionId 创建后不再改变; 其余字段受所在 clientId 分片的锁保护。
+// forEach / updateBySession 回调中的 lastSeen 以原子量为准，回调内不得再调用本类。
+// =========================================================
+class SessionRegistry
+{
+public:
+    static const int SHARD_COUNT = 32;
+
+    explicit SessionRegistry(qint64 expiryTickMs = 1000);
+
+    // 1. 注册 / 删除
+    // 分配新的 sessionId 并登记 (同 clientId 的旧会话被替换)，expiryDeadlineMs 为首次超时复核时间
+    quint32 registerClient(const RegisterInfo &info, qint64 expiryDeadlineMs);
+    bool remove(const QString &clientId, RegisterInfo *removed = nullptr);
+    bool removeBySession(quint32 sessionId, RegisterInfo *removed = nullptr);
+    void clear();
+
+    // 2. 心跳热路径: 刷新 lastSeen，公网端点变化时更新并回填 outEndpointChanged
+    bool touch(quint32 sessionId, const QHostAddress &addr, quint64 port, qint64 nowMs, bool *outEndpointChanged);
+
+    // 3. 查询 (返回快照)
+    bool find(const QString &clientId, RegisterInfo *out = nullptr) const;
+    bool findBySession(quint32 sessionId, RegisterInfo *out = nullptr) const;
+    QString clientIdBySession(quint32 sessionId) const;
+    bool contains(const QString &clientId) const        { return find(clientId); }
+    int size() const;
+    QList<RegisterInfo> snapshot() const;
+
+    // 逐分片在读锁下遍历，fn(const RegisterInfo &) 返回 true 时停止; 返回是否提前停止
+    template <typename Fn>
+    bool forEach(Fn &&fn) const
+    {
+        for (const Shard &shard : m_shards) {
+            QReadLocker locker(&shard.lock);
+            for (const EntryPtr &entry : shard.byClient) {
+                if (fn(static_cast<const RegisterInfo &>(entry->info))) return true;
+            }
+        }
+        return false;
+    }
+
+    // 在记录所在分片的写锁下修改 (clientId / sessionId / crcToken 不可在此修改)
+    template <typename Fn>
+    bool updateBySession(quint32 sessionId, Fn &&fn)
+    {
+        EntryPtr entry = lookupSession(sessionId);
+        if (!entry) return false;
+
+        Shard &shard = clientShard(entry->info.clientId);
+        QWriteLocker locker(&shard.lock);
+        if (shard.byClient.value(entry->info.clientId) != entry) return false;   // 已被删除 / 替换
+        entry->info.lastSeen = entry->lastSeen.load(std::memory_order_relaxed);
+        fn(entry->info);
+        return true;
+    }
+
+    // 4. 地图 CRC 人数统计
+    bool setCrcToken(const QString &clientId, const QString &crcToken, QString *username = nullptr);
+    QString mostFrequentCrc(int *count = nullptr) const;
+
+    // 5. 超时: 推进时间轮，仍活跃的记录顺延，返回已超时记录的快照 (不删除)
+    QList<RegisterInfo> collectExpired(qint64 nowMs, quint64 timeoutMs);
+
+private:
+    struct Entry {
+        RegisterInfo            info;
+        std::atomic<quint64>    lastSeen    { 0 };
+        std::atomic<quint64>    endpoint    { 0 };  // 公网端点指纹 (0 = 未知 / IPv6，走字符串比较)
+    };
+    using EntryPtr = QSharedPointer<Entry>;
+
+    struct alignas(64) Shard {
+        mutable QReadWriteLock          lock;
+        QHash<QString, EntryPtr>        byClient;
+        QHash<quint32, EntryPtr>        bySession;
+    };
+
+    Shard &clientShard(const QString &clientId)             { return m_shards[qHash(clientId) & (SHARD_COUNT - 1)]; }
+    const Shard &clientShard(const QString &clientId) const { return m_shards[qHash(clientId) & (SHARD_COUNT - 1)]; }
+    Shard &sessionShard(quint32 sessionId)                  { return m_shards[sessionId & (SHARD_COUNT - 1)]; }
+    const Shard &sessionShard(quint32 sessionId) const      { return m_shards[sessionId & (SHARD_COUNT - 1)]; }
+
+    EntryPtr lookupSession(quint32 sessionId) const;
+    void unlinkSession(const EntryPtr &entry);
+    void adjustCrcCountLocked(const QString &crcToken, int delta);
+    static void fillSnapshot(const EntryPtr &entry, RegisterInfo *out);
+    static quint64 endpointKey(const QHostAddress &addr, quint64 port);
+
+    std::array<Shard, SHARD_COUNT>  m_shards;
+
+    mutable QMutex                  m_crcLock;
+    QMap<QString, int>              m_crcCounts;            // crcToken -> 在线人数
+
+    QMutex                          m_expiryLock;
+    TimingWheel<QString>            m_expiryWheel;          // clientId -> 最早可能超时的时间
+};
+
+#endif // SESSIONREGISTRY_H
@@ -0,0 +1,171 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <QDateTime>
+#include <QVector>
+#include <QHash>
+#include <array>
+
+// =========================================================
+// TimingWheel: 分层时间轮
+// ---------------------------------------------------------
+// 超时 / 冷却只在登记时按截止时间放入对应槽位，推进时只处理
+// 到期槽位，周期性开销与到期条目数成正比，而不是与总条目数成正比。
+//   第 0 层: 256 槽 x 1 tick
+//   第 1 层:  64 槽 x 256 tick
+//   第 2 层:  64 槽 x 16384 tick
+//   更远的截止时间进入溢出表，第 2 层转完一圈时重新分配
+// 同一个键重复登记时只保留最新截止时间 (旧条目在到期时被识别为过期而丢弃)，
+// 因此登记 / 取消都是 O(1)。时间统一使用 QDateTime::currentMSecsSinceEpoch()。
+// 非线程安全，由持有者所在线程 (或锁) 保护。
+// =========================================================
+template <typename Key>
+class TimingWheel
+{
+public:
+    explicit TimingWheel(qint64 tickMs = 100) : m_tickMs(qMax<qint64>(1, tickMs)) {}
+
+    // 登记 / 改期 (deadlineMs 为绝对时间)
+    void schedule(const Key &key, qint64 deadlineMs)
+    {
+        // 空轮从当前时间起步，长时间未推进也不需要逐 tick 追赶
+        if (m_deadlines.isEmpty()) {
+            clear();
+            m_currentTick = QDateTime::currentMSecsSinceEpoch() / m_tickMs;
+        }
+
+        qint64 tick = (deadlineMs + m_tickMs - 1) / m_tickMs;
+        if (tick <= m_currentTick) tick = m_currentTick + 1;
+
+        m_deadlines.insert(key, tick);
+        place(Entry{ key, tick });
+    }
+
+    void cancel(const Key &key)             { m_deadlines.remove(key); }
+    bool contains(const Key &key) const     { return m_deadlines.contains(key); }
+    int size() const                        { return m_deadlines.size(); }
+    bool isEmpty() const                    { return m_deadlines.isEmpty(); }
+
+    // 已登记键的截止时间 (未登记返回 -1)
+    qint64 deadline(const Key &key) const
+    {
+        auto it = m_deadlines.constFind(key);
+        return (it != m_deadlines.constEnd()) ? it.value() * m_tickMs : -1;
+    }
+
+    void clear()
+    {
+        m_deadlines.clear();
+        for (auto &slot : m_level0) slot.clear();
+        for (auto &slot : m_level1) slot.clear();
+        for (auto &slot : m_level2) slot.clear();
+        m_overflow.clear();
+    }
+
+    // 推进到 nowMs，对每个到期的键调用 onExpired(key)，返回触发数量。
+    // 回调中可以重新 schedule (包括同一个键)，新条目最早在下一个 tick 触发。
+    template <typename Fn>
+    int advance(qint64 nowMs, Fn &&onExpired)
+    {
+        const qint64 target = nowMs / m_tickMs;
+        if (target <= m_currentTick) return 0;
+
+        // 没有待触发条目时直接跳到目标 tick
+        if (m_deadlines.isEmpty()) {
+            clear();
+            m_currentTick = target;
+            return 0;
+        }
+
+        int fired = 0;
+        while (m_currentTick < target) {
+            ++m_currentTick;
+            cascade();
+
+            QVector<Entry> due;
+            due.swap(m_level0[m_currentTick & LEVEL0_MASK]);
+            for (const Entry &entry : qAsConst(due)) {
+                auto it = m_deadlines.find(entry.key);
+                if (it == m_deadlines.end() || it.value() != entry.tick) continue;   // 已取消或已改期
+                m_deadlines.erase(it);
+                onExpired(entry.key);
+                ++fired;
+            }
+
+            if (m_deadlines.isEmpty()) {
+                clear();
+                m_currentTick = target;
+                break;
+            }
+        }
+        return fired;
+    }
+
+private:
+    struct Entry {
+        Key     key;
+        qint64  tick;
+    };
+
+    static const int LEVEL0_BITS = 8;
+    static const int LEVEL1_BITS = 6;
+    static const int LEVEL2_BITS = 6;
+    static const qint64 LEVEL0_MASK = (1 << LEVEL0_BITS) - 1;
+    static const qint64 LEVEL1_MASK = (1 << LEVEL1_BITS) - 1;
+    static const qint64 LEVEL2_MASK = (1 << LEVEL2_BITS) - 1;
+    static const qint64 LEVEL1_SHIFT = LEVEL0_BITS;
+    static const qint64 LEVEL2_SHIFT = LEVEL0_BITS + LEVEL1_BITS;
+    static const qint64 LEVEL0_SPAN = 1LL << LEVEL1_SHIFT;
+    static const qint64 LEVEL1_SPAN = 1LL << LEVEL2_SHIFT;
+    static const qint64 LEVEL2_SPAN = 1LL << (LEVEL2_SHIFT + LEVEL2_BITS);
+
+    void place(const Entry &entry)
+    {
+        const qint64 delta = entry.tick - m_currentTick;
+        if (delta < LEVEL0_SPAN) {
+            m_level0[entry.tick & LEVEL0_MASK].append(entry);
+        } else if (delta < LEVEL1_SPAN) {
+            m_level1[(entry.tick >> LEVEL1_SHIFT) & LEVEL1_MASK].append(entry);
+        } else if (delta < LEVEL2_SPAN) {
+            m_level2[(entry.tick >> LEVEL2_SHIFT) & LEVEL2_MASK].append(entry);
+        } else {
+            m_overflow.append(entry);
+        }
+    }
+
+    // 低层转完一圈时，把上一层当前槽位的条目重新分配到下层
+    void cascade()
+    {
+        if ((m_currentTick & LEVEL0_MASK) != 0) return;
+
+        if (((m_currentTick >> LEVEL1_SHIFT) & LEVEL1_MASK) == 0) {
+            if (((m_currentTick >> LEVEL2_SHIFT) & LEVEL2_MASK) == 0) {
+                redistribute(m_overflow);
+            }
+            redistribute(m_level2[(m_currentTick >> LEVEL2_SHIFT) & LEVEL2_MASK]);
+        }
+        redistribute(m_level1[(m_currentTick >> LEVEL1_SHIFT) & LEVEL1_MASK]);
+    }
+
+    void redistribute(QVector<Entry> &slot)
+    {
+        QVector<Entry> entries;
+        entries.swap(slot);
+        for (const Entry &entry : qAsConst(entries)) {
+            // 过期条目在这里顺带丢弃，避免在各层之间反复搬运
+            auto it = m_deadlines.constFind(entry.key);
+            if (it == m_deadlines.constEnd() || it.value() != entry.tick) continue;
+            place(entry);
+        }
+    }
+
+    qint64                                  m_tickMs;
+    qint64                                  m_currentTick   = 0;
+    QHash<Key, qint64>                      m_deadlines;            // 键 -> 当前有效的截止 tick
+    std::array<QVector<Entry>, 1 << LEVEL0_BITS>    m_level0;
+    std::array<QVector<Entry>, 1 << LEVEL1_BITS>    m_level1;
+    std::array<QVector<Entry>, 1 << LEVEL2_BITS>    m_level2;
+    QVector<Entry>                          m_overflow;
+};
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,78 @@
+#ifndef UDPBATCHSOCKET_H
+#define UDPBATCHSOCKET_H
+
+#include <QHostAddress>
+#include <QUdpSocket>
+#include <QByteArray>
+#include <QPointer>
+#include <QObject>
+#include <functional>
+
+class QSocketNotifier;
+
+// =========================================================
+// UdpBatchSocket: 批量 UDP 收发后端
+// ---------------------------------------------------------
+// 挂在一个已有的 QUdpSocket 上，接管它的收包并提供发包入口:
+//   Linux: 在 dup 出的描述符上用 recvmmsg 一次读取多个报文，
+//          收包回调中产生的回包先排队，一批处理完后用 sendmmsg 一次发出
+//   其他平台 / 设置 WAR3BOT_NO_UDP_BATCH: 退回 Qt 的 readDatagram / writeDatagram
+// 绑定、关闭、重新绑定由 QUdpSocket 的状态变化自动跟随。
+// 收包缓冲区与来源地址在回调返回后即被复用，回调中不要保存指针。
+// =========================================================
+
+class UdpBatchSocket : public QObject
+{
+    Q_OBJECT
+
+public:
+    using DatagramHandler = std::function<void(char *data, int size, const QHostAddress &sender, quint16 senderPort)>;
+
+    UdpBatchSocket(QUdpSocket *socket, DatagramHandler handler = DatagramHandler(), QObject *parent = nullptr);
+    ~UdpBatchSocket() override;
+
+    // 收包回调内调用时排队到本批结束统一发出，其余情况直接发送
+    qint64 send(const char *data, int size, const QHostAddress &target, quint16 port);
+    qint64 send(const QByteArray &data, const QHostAddress &target, quint16 port)
+    {
+        return send(data.constData(), data.size(), target, port);
+    }
+    void flush();
+
+    void setHandler(DatagramHandler handler){ m_handler = std::move(handler); }
+    QString errorString() const             { return m_socket ? m_socket->errorString() : QString(); }
+
+    bool isBatched() const                  { return m_fd >= 0; }
+    const char *backendName() const         { return isBatched() ? "recvmmsg/sendmmsg" : "Qt"; }
+
+    // 编译平台支持且未被环境变量关闭
+    static bool batchingAvailable();
+
+private slots:
+    void onSocketStateChanged(QAbstractSocket::SocketState state);
+    void onQtReadyRead();
+    void onBatchReadable();
+
+private:
+    void attach();
+    void detach();
+
+    QPointer<QUdpSocket>            m_socket;
+    DatagramHandler                 m_handler;
+
+    // Qt 回退路径复用的缓冲区与来源地址
+    QByteArray                      m_rxBuffer;
+    QHostAddress                    m_sender;
+    quint16                         m_senderPort        = 0;
+
+    // 批量路径 (仅 Linux)
+    int                             m_fd                = -1;
+    QSocketNotifier                 *m_notifier         = nullptr;
+    bool                            m_inBatch           = false;
+    int                             m_txCount           = 0;
+    quint64                         m_txDropped         = 0;
+    struct BatchBuffers;
+    BatchBuffers                    *m_batch            = nullptr;
+};
+
+#endif // UDPBATCHSOCKET_H
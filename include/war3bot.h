@@ -4,6 +4,7 @@
 #include "client.h"
 #include "netmanager.h"
 #include "botmanager.h"
+#include "mappreloader.h"
 
 class War3Bot : public QObject
 {
@@ -19,6 +20,7 @@ public:
     bool isRunning() const;
     BotManager *getBotManager() const { return m_botManager; }
     NetManager* getNetManager() const { return m_netManager; }
+    MapPreloader *getMapPreloader() const { return m_mapPreloader; }
     bool startServer(quint16 port, const QString &configFile);
     void setForcePortReuse(bool force) { m_forcePortReuse = force; }
     void connectToBattleNet(QString hostname = "", quint16 port = 0, QString user = "", QString pass = "");
@@ -36,6 +38,7 @@ private:
     QString m_pendingGameName;
     bool m_forcePortReuse = false;
     BotManager *m_botManager;
+    MapPreloader *m_mapPreloader;
     NetManager *m_netManager;
     QString m_configPath;
     Client *m_client;
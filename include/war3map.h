@@ -4,6 +4,8 @@
 #include <QString>
 #include <QByteArray>
 #include <QDataStream>
+#include <QFile>
+#include <QStringList>
 #include <memory>
 #include <qmutex.h>
 
@@ -60,10 +62,23 @@ struct W3iForce {
     QString             name;
 };
 
+// W3GS_MAPPART (0x43) 分片参数
+#define MAP_PART_CHUNK_SIZE                 1442
+#define MAP_PART_HEADER_SIZE                18
+#define MAP_PART_TOPID_OFFSET               4
+#define MAP_PART_FROMPID_OFFSET             5
+
+// 地图文件以只读 mmap 共享: 更新地图必须写新文件后 rename 替换，不能原地改写或截断
+// (原地截断会让仍在发送旧映射的房间触发 SIGBUS; rename 后旧映射仍指向旧 inode，安全)
 struct War3MapSharedData {
     bool                valid               = false;
     QString             mapPath;
-    QByteArray          mapRawData;
+    QByteArray          mapRawData;         // 只读视图 (指向 mapFile 的内存映射，不持有拷贝)
+    QByteArray          mapPartHeaders;     // 预构建的 0x43 包头 (每片 MAP_PART_HEADER_SIZE 字节, PID 字段留空)
+    std::shared_ptr<QFile> mapFile;         // 保持映射存活，随共享数据一起释放
+    bool                mapped              = false;
+    qint64              fileSize            = -1;   // 加载时的文件指纹，缓存复用前与磁盘比对
+    qint64              fileMtime           = 0;
     QByteArray          mapSize;
     QByteArray          mapInfo;            // MapInfo CRC
     QByteArray          mapCRC;             // Xoro CRC
@@ -115,6 +130,7 @@ public:
     QByteArray                                                  getMapPlayableWidth()                   const;
     QByteArray                                                  getMapPlayableHeight()                  const;
     QByteArray                                                  getMapRawData()                         const;
+    QByteArray                                                  getMapPartHeaders()                     const;
     QByteArray                                                  getMapSHA1Bytes()                       const;
 
     // === Getters (协议专用) ===
@@ -133,8 +149,19 @@ public:
     // 清理未使用的缓存
     static void                                                 clearUnusedCache();
 
-    // 暴雪自定义哈希 (原 computeXoroCRC，纯净版)
+    // 内存报告: 每张缓存地图的映射大小 / 常驻字节数
+    static QStringList                                          memoryReport();
+
+    // 预构建全部 W3GS_MAPPART 包头 (偏移 + CRC 只算一次, 发送时仅需回填 PID, 数据直接取自映射)
+    static QByteArray                                           buildMapPartHeaders(const QByteArray &mapData);
+
+    // 暴雪自定义哈希 (多通道折叠 + 运行时选择 AVX2/SSE2/标量内核，与原实现逐位一致)
     static quint32                                              calcBlizzardHash(const QByteArray &data);
+    // 原始逐 DWORD 串行实现 (原 computeXoroCRC，纯净版)，用于对照校验与基准
+    static quint32                                              calcBlizzardHashReference(const QByteArray &data);
+    static const char                                          *blizzardHashKernelName();
+    // 在已缓存的地图数据上对比两种实现的吞吐与结果
+    static QStringList                                          benchmarkBlizzardHash(int rounds = 5);
 
     // StatString 编码/解码
     static QByteArray                                           encodeStatString(const QByteArray &data);
@@ -0,0 +1,577 @@
+#include "benchmark.h"
+#include "bncsutil/checkrevision.h"
+#include "calculate.h"
+#include "bnetsrp3.h"
+#include "war3map.h"
+#include "client.h"
+#include "revisioncache.h"
+#include "sessionregistry.h"
+#include "securitywatchdog.h"
+#include "packetsigner.h"
+#include "protocol.h"
+#include "logger.h"
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QHostInfo>
+#include <QSysInfo>
+#include <QThread>
+#include <QFileInfo>
+#include <QTextCodec>
+#include <QFile>
+
+#include <cstdio>
+
+War3BotBench::War3BotBench(int minTimeMs, const QString &filter)
+    : m_minTimeMs(qMax(10, minTimeMs))
+    , m_filter(filter)
+{
+}
+
+// =========================================================
+// 1. 计时框架
+// ---------------------------------------------------------
+// 迭代次数按实测速度逐批放大 (每批至多 10 倍)，直到一批耗时
+// 超过最短采样时间；返回值累加到 volatile 汇点，防止被编译器整体消除。
+// =========================================================
+
+void War3BotBench::runCase(const QString &name, qint64 bytesPerOp, const std::function<quint64()> &fn)
+{
+    if (!m_filter.isEmpty() && !name.contains(m_filter)) return;
+
+    fprintf(stderr, "   ├─ %-40s ", qPrintable(name));
+    fflush(stderr);
+
+    // 预热一次 (首次分配 / 页缓存)
+    m_sink = m_sink + fn();
+
+    qint64 iterations = 1;
+    qint64 elapsedNs = 0;
+    QElapsedTimer timer;
+    const qint64 minNs = (qint64)m_minTimeMs * 1000000;
+
+    while (true) {
+        timer.start();
+        for (qint64 i = 0; i < iterations; ++i) {
+            m_sink = m_sink + fn();
+        }
+        elapsedNs = timer.nsecsElapsed();
+        if (elapsedNs >= minNs || iterations >= 1000000000LL) break;
+
+        // 按已测速度估算下一批，至多放大 10 倍
+        const qint64 predicted = (elapsedNs > 0) ? (qint64)(iterations * 1.4 * minNs / elapsedNs) : iterations * 10;
+        iterations = qBound(iterations + 1, predicted, iterations * 10);
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = (double)elapsedNs / iterations;
+    result.bytesPerOp = bytesPerOp;
+    m_results.append(result);
+
+    if (bytesPerOp > 0) {
+        const double mbPerSec = (bytesPerOp / (1024.0 * 1024.0)) / (result.nsPerOp / 1e9);
+        fprintf(stderr, "%12.1f ns/op %10.1f MB/s\n", result.nsPerOp, mbPerSec);
+    } else {
+        fprintf(stderr, "%12.1f ns/op\n", result.nsPerOp);
+    }
+}
+
+void War3BotBench::skipCase(const QString &name, const QString &reason)
+{
+    if (!m_filter.isEmpty() && !name.contains(m_filter)) return;
+
+    fprintf(stderr, "   ├─ %-40s ⏭️ 跳过: %s\n", qPrintable(name), qPrintable(reason));
+
+    BenchResult result;
+    result.name = name;
+    result.skipped = true;
+    result.note = reason;
+    m_results.append(result);
+}
+
+static QByteArray randomBytes(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    QRandomGenerator gen(0x57334242);   // 固定种子，保证各版本输入一致
+    for (int i = 0; i < size; ++i) data[i] = (char)gen.bounded(256);
+    return data;
+}
+
+// =========================================================
+// 2. 哈希: 暴雪哈希 / CRC32 低 16 位 / 控制协议签名
+// =========================================================
+
+void War3BotBench::benchHashing()
+{
+    const QByteArray script = randomBytes(1024 * 1024);
+
+    runCase("hash/blizzard/1MiB", script.size(), [&]() -> quint64 {
+        return War3Map::calcBlizzardHash(script);
+    });
+    runCase("hash/blizzard_reference/1MiB", script.size(), [&]() -> quint64 {
+        return War3Map::calcBlizzardHashReference(script);
+    });
+
+    const QByteArray action = randomBytes(256);
+    runCase("hash/crc32_lower16/256B", action.size(), [&]() -> quint64 {
+        return calculateCRC32Lower16(action.constData(), action.size());
+    });
+
+    const QByteArray chunk = randomBytes(MAP_PART_CHUNK_SIZE);
+    runCase("hash/crc32_lower16/1442B", chunk.size(), [&]() -> quint64 {
+        return calculateCRC32Lower16(chunk.constData(), chunk.size());
+    });
+
+    // 控制协议 UDP 包 (包头 + 小负载) 的签名 + CRC 校验: 旧的拼接 + QCryptographicHash 写法对照栈上实现
+    const QByteArray datagram = randomBytes(sizeof(PacketHeader) + 32);
+    runCase("hash/control_verify_qt/68B", datagram.size(), [&]() -> quint64 {
+        const QByteArray secret = PacketSigner::appSecret();
+        QCryptographicHash hasher(QCryptographicHash::Sha256);
+        hasher.addData(datagram);
+        hasher.addData(secret);
+        const QByteArray expected = hasher.result();
+        return (quint8)expected[0] + calculateStandardCRC16(datagram);
+    });
+    runCase("hash/control_verify/68B", datagram.size(), [&]() -> quint64 {
+        char signature[PacketSigner::SIGNATURE_SIZE] = {};
+        const bool ok = PacketSigner::verify(datagram.constData(), datagram.size(), signature);
+        return (quint64)ok + calculateStandardCRC16(datagram.constData(), datagram.size());
+    });
+}
+
+// =========================================================
+// 3. 协议打包: 0x0C 动作包 / 0x43 地图分片 / StatString
+// =========================================================
+
+void War3BotBench::benchProtocol(Client &client)
+{
+    // 典型对局: 10 名玩家每 tick 各一个 24 字节动作
+    const QByteArray actionData = randomBytes(24);
+    runCase("w3gs/incoming_action/10x24B", 0, [&]() -> quint64 {
+        for (quint8 pid = 1; pid <= 10; ++pid) {
+            client.appendIncomingAction(pid, actionData.constData(), actionData.size());
+        }
+        return (quint64)client.createW3GSIncomingActionPacket(100).size();
+    });
+
+    runCase("w3gs/incoming_action/empty", 0, [&]() -> quint64 {
+        return (quint64)client.createW3GSIncomingActionPacket(100).size();
+    });
+
+    const QByteArray chunk = randomBytes(MAP_PART_CHUNK_SIZE);
+    quint32 offset = 0;
+    runCase("w3gs/map_part/1442B", chunk.size(), [&]() -> quint64 {
+        offset += MAP_PART_CHUNK_SIZE;
+        return (quint64)client.createW3GSMapPartPacket(2, 1, offset, chunk).size();
+    });
+
+    if (!client.m_mapPartHeaders.isEmpty()) {
+        const QByteArray mapData = client.m_mapData;
+        runCase("w3gs/map_part_headers/full_map", mapData.size(), [&]() -> quint64 {
+            return (quint64)War3Map::buildMapPartHeaders(mapData).size();
+        });
+        runCase("hash/blizzard/real_map", mapData.size(), [&]() -> quint64 {
+            return War3Map::calcBlizzardHash(mapData);
+        });
+    } else {
+        skipCase("w3gs/map_part_headers/full_map", "默认地图未加载");
+        skipCase("hash/blizzard/real_map", "默认地图未加载");
+    }
+
+    // StatString: 标志位 + 尺寸 + CRC + 路径 + 主机名
+    QByteArray rawStat = randomBytes(13);
+    rawStat.append("Maps\\Download\\DotA v6.83d.w3x");
+    rawStat.append('\0');
+    rawStat.append("CC.Dota.XXX");
+    rawStat.append('\0');
+    rawStat.append('\0');
+    rawStat.append(randomBytes(20));
+    const QByteArray encodedStat = War3Map::encodeStatString(rawStat);
+
+    runCase("statstring/encode", rawStat.size(), [&]() -> quint64 {
+        return (quint64)War3Map::encodeStatString(rawStat).size();
+    });
+    runCase("statstring/decode", encodedStat.size(), [&]() -> quint64 {
+        return (quint64)War3Map::decodeStatString(encodedStat).size();
+    });
+}
+
+// =========================================================
+// 4. 加密: BigInt::powm / SRP3 登录步骤
+// =========================================================
+
+void War3BotBench::benchCrypto()
+{
+    // 与 SRP3 同规模 (256 位) 的模幂
+    const BigInt base(randomBytes(32));
+    const BigInt exp(randomBytes(32).mid(1).prepend((char)0x7F));
+    QByteArray modBytes = randomBytes(32);
+    modBytes[0] = (char)0xF8;
+    modBytes[31] = (char)(modBytes[31] | 1);
+    const BigInt mod(modBytes);
+
+    runCase("bigint/powm/256bit", 0, [&]() -> quint64 {
+        return (quint64)base.powm(exp, mod).toHexString().size();
+    });
+    runCase("bigint/powm_native/256bit", 0, [&]() -> quint64 {
+        return (quint64)base.powmNative(exp, mod).toHexString().size();
+    });
+
+    // 预先模拟一次服务端，得到固定的 salt 与 B
+    const QString user = "BENCHUSER";
+    const QString pass = "benchpass";
+    BnetSRP3 registrar(user, pass);
+    BigInt salt = registrar.getSalt();
+    BigInt verifier = registrar.getVerifier();
+    BnetSRP3 server(user, salt);
+    BigInt B = server.getServerSessionPublicKey(verifier);
+
+    runCase("srp3/client_public_key", 0, [&]() -> quint64 {
+        BnetSRP3 srp(user, pass);
+        return (quint64)srp.getClientSessionPublicKey().toHexString().size();
+    });
+
+    BnetSRP3 client(user, pass);
+    client.setSalt(salt);
+    BigInt A = client.getClientSessionPublicKey();
+    BigInt K = client.getHashedClientSecret(B);
+
+    runCase("srp3/hashed_client_secret", 0, [&]() -> quint64 {
+        return (quint64)client.getHashedClientSecret(B).toHexString().size();
+    });
+    runCase("srp3/client_password_proof", 0, [&]() -> quint64 {
+        return (quint64)client.getClientPasswordProof(A, B, K).toHexString().size();
+    });
+
+    // 完整客户端登录: A -> K -> M1
+    runCase("srp3/full_client_login", 0, [&]() -> quint64 {
+        BnetSRP3 srp(user, pass);
+        srp.setSalt(salt);
+        BigInt a = srp.getClientSessionPublicKey();
+        BigInt k = srp.getHashedClientSecret(B);
+        return (quint64)srp.getClientPasswordProof(a, B, k).toHexString().size();
+    });
+}
+
+// =========================================================
+// 5. 版本校验 (需要 war3files 中的 War3.exe / Storm.dll / Game.dll)
+// =========================================================
+
+void War3BotBench::benchCheckRevision(Client &client)
+{
+    if (client.m_war3ExePath.isEmpty() || !QFile::exists(client.m_war3ExePath)) {
+        skipCase("check_revision/ver-IX86-1", "未找到 War3.exe");
+        return;
+    }
+
+    const QByteArray formula = "A=443747131 B=3328179921 C=1040998290 4 A=A^S B=B-C C=C+A A=A-B";
+    const int mpqNumber = extractMPQNumber("ver-IX86-1.mpq");
+    const QByteArray exePath = client.m_war3ExePath.toUtf8();
+    const QByteArray stormPath = client.m_stormDllPath.toUtf8();
+    const QByteArray gamePath = client.m_gameDllPath.toUtf8();
+    const qint64 totalBytes = QFileInfo(client.m_war3ExePath).size()
+                              + QFileInfo(client.m_stormDllPath).size()
+                              + QFileInfo(client.m_gameDllPath).size();
+
+    runCase("check_revision/ver-IX86-1", totalBytes, [&]() -> quint64 {
+        unsigned long checkSum = 0;
+        checkRevisionFlat(formula.constData(), exePath.constData(), stormPath.constData(),
+                          gamePath.constData(), mpqNumber, &checkSum);
+        return checkSum;
+    });
+
+    // 缓存命中路径: 三次 stat + 一次哈希表查找 (首次迭代完成计算并入缓存)
+    CheckRevisionCache::setPersistent(false);
+    runCase("check_revision/cached", 0, [&]() -> quint64 {
+        quint32 checkSum = 0;
+        CheckRevisionCache::checkRevision(formula, client.m_war3ExePath, client.m_stormDllPath,
+                                          client.m_gameDllPath, mpqNumber, &checkSum);
+        return checkSum;
+    });
+}
+
+// =========================================================
+// 6. 玩家表遍历 (心跳 / Tick 循环的访问模式)
+// ---------------------------------------------------------
+// 512 个房间 x 10 名玩家，每次操作扫一遍全部房间并读取热字段。
+// 对比旧的 QMap<quint8, PlayerData> 与按 PID 下标的 PlayerTable；
+// 缓存未命中差异可配合 perf 观察:
+//   perf stat -e cache-misses War3BotBench --filter players/
+// =========================================================
+
+void War3BotBench::benchPlayerTable()
+{
+    const int rooms = 512;
+    const int playersPerRoom = 10;
+
+    QVector<QMap<quint8, PlayerData>> maps(rooms);
+    QVector<PlayerTable> tables(rooms);
+    QVector<QByteArray> noise;              // 穿插分配，模拟长期运行后分散的堆
+    noise.reserve(rooms * playersPerRoom);
+
+    for (int r = 0; r < rooms; ++r) {
+        for (int i = 0; i < playersPerRoom; ++i) {
+            PlayerData p;
+            p.pid = (quint8)(i + 1);
+            p.name = QString("Player%1_%2").arg(r).arg(i);
+            p.lastResponseTime = r * 1000 + i;
+            p.currentLatency = (quint32)(i * 7);
+            maps[r].insert(p.pid, p);
+            tables[r].insert(p.pid, p);
+            noise.append(QByteArray(96 + (r * 31 + i * 17) % 160, 'x'));
+        }
+    }
+
+    runCase("players/scan_qmap", 0, [&]() -> quint64 {
+        quint64 sum = 0;
+        for (const auto &players : qAsConst(maps)) {
+            for (auto it = players.constBegin(); it != players.constEnd(); ++it) {
+                sum += it.value().lastResponseTime + it.value().currentLatency + it.key();
+            }
+        }
+        return sum;
+    });
+
+    runCase("players/scan_table", 0, [&]() -> quint64 {
+        quint64 sum = 0;
+        for (const auto &players : qAsConst(tables)) {
+            for (auto it = players.constBegin(); it != players.constEnd(); ++it) {
+                sum += it.value().lastResponseTime + it.value().currentLatency + it.key();
+            }
+        }
+        return sum;
+    });
+
+    runCase("players/lookup_qmap", 0, [&]() -> quint64 {
+        quint64 sum = 0;
+        for (const auto &players : qAsConst(maps)) {
+            for (quint8 pid = 1; pid <= 12; ++pid) {
+                auto it = players.constFind(pid);
+                if (it != players.constEnd()) sum += it.value().currentLatency;
+            }
+        }
+        return sum;
+    });
+
+    runCase("players/lookup_table", 0, [&]() -> quint64 {
+        quint64 sum = 0;
+        for (const auto &players : qAsConst(tables)) {
+            for (quint8 pid = 1; pid <= 12; ++pid) {
+                auto it = players.constFind(pid);
+                if (it != players.constEnd()) sum += it.value().currentLatency;
+            }
+        }
+        return sum;
+    });
+}
+
+// =========================================================
+// 7. 在线会话表 (控制端口心跳 / 上传路径)
+// ---------------------------------------------------------
+// 10000 个会话: 心跳按 sessionId 刷新 (端点不变)、按 clientId 取快照、
+// 统计最热门地图 CRC (旧实现每次上传都重数全部会话)。
+// =========================================================
+
+void War3BotBench::benchSessionRegistry()
+{
+    const int sessions = 10000;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    SessionRegistry registry;
+    QVector<quint32> sessionIds;
+    QVector<QHostAddress> addrs;
+    QVector<QString> clientIds;
+    sessionIds.reserve(sessions);
+    addrs.reserve(sessions);
+    clientIds.reserve(sessions);
+
+    for (int i = 0; i < sessions; ++i) {
+        RegisterInfo info;
+        info.clientId = QString("client-%1").arg(i);
+        info.hardwareId = QString("hwid-%1").arg(i);
+        info.username = QString("user%1").arg(i);
+        info.localPort = 6112;
+        info.publicIp = QString("10.%1.%2.%3").arg(i >> 16).arg((i >> 8) & 0xFF).arg(i & 0xFF);
+        info.publicPort = 6112;
+        info.sessionId = 0; info.lastSeq = 0; info.natType = 0; info.isRegistered = true;
+        info.lastSeen = now; info.firstSeen = now;
+
+        sessionIds.append(registry.registerClient(info, now + 60000));
+        addrs.append(QHostAddress(info.publicIp));
+        clientIds.append(info.clientId);
+        registry.setCrcToken(info.clientId, QString("%1").arg(i % 8, 8, 16, QChar('0')));
+    }
+
+    int cursor = 0;
+    runCase("sessions/touch/10k", 0, [&]() -> quint64 {
+        cursor = (cursor + 1) % sessions;
+        bool changed = false;
+        return registry.touch(sessionIds[cursor], addrs[cursor], 6112, now, &changed) ? 1 : 0;
+    });
+
+    runCase("sessions/find_client/10k", 0, [&]() -> quint64 {
+        cursor = (cursor + 1) % sessions;
+        RegisterInfo info;
+        return registry.find(clientIds[cursor], &info) ? info.publicPort : 0;
+    });
+
+    runCase("sessions/most_frequent_crc/10k", 0, [&]() -> quint64 {
+        int count = 0;
+        return (quint64)registry.mostFrequentCrc(&count).size() + (quint64)count;
+    });
+}
+
+// =========================================================
+// 8. 控制端口准入 (SecurityWatchdog::checkUdpPacket)
+// ---------------------------------------------------------
+// 在线玩家的心跳、已封禁来源的洪水、伪造来源的随机 IPv4 洪水。
+// =========================================================
+
+void War3BotBench::benchWatchdog()
+{
+    SecurityWatchdog watchdog;
+
+    const QHostAddress player("10.1.2.3");
+    watchdog.markSessionActive(player, 4242);
+    runCase("watchdog/heartbeat_known", 0, [&]() -> quint64 {
+        watchdog.markSessionActive(player, 4242);
+        return watchdog.checkUdpPacket(player, 40, PacketType::C_S_HEARTBEAT, 4242) ? 1 : 0;
+    });
+
+    const QHostAddress attacker("10.9.9.9");
+    watchdog.checkUdpPacket(attacker, 2000, PacketType::C_S_COMMAND);     // 超大包直接触发封禁
+    runCase("watchdog/flood_banned", 0, [&]() -> quint64 {
+        return watchdog.checkUdpPacket(attacker, 68, PacketType::C_S_COMMAND) ? 1 : 0;
+    });
+
+    quint32 spoofed = 0x0B000000;
+    runCase("watchdog/flood_spoofed_ipv4", 0, [&]() -> quint64 {
+        spoofed = spoofed * 1664525u + 1013904223u;
+        return watchdog.checkUdpPacket(QHostAddress(spoofed), 68, PacketType::C_S_REGISTER) ? 1 : 0;
+    });
+}
+
+// =========================================================
+// 9. 输出
+// =========================================================
+
+QJsonObject War3BotBench::toJson() const
+{
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    context["host_name"] = QHostInfo::localHostName();
+    context["executable"] = QCoreApplication::applicationFilePath();
+    context["version"] = QCoreApplication::applicationVersion();
+    context["num_cpus"] = QThread::idealThreadCount();
+    context["cpu_arch"] = QSysInfo::currentCpuArchitecture();
+    context["os"] = QSysInfo::prettyProductName();
+    context["qt_version"] = QString(qVersion());
+    context["blizzard_hash_kernel"] = QString(War3Map::blizzardHashKernelName());
+    context["bigint_powm_backend"] = QString(BigInt::powmBackendName());
+    context["min_time_ms"] = m_minTimeMs;
+#ifdef QT_NO_DEBUG
+    context["library_build_type"] = "release";
+#else
+    context["library_build_type"] = "debug";
+#endif
+
+    QJsonArray benchmarks;
+    for (const BenchResult &r : m_results) {
+        QJsonObject item;
+        item["name"] = r.name;
+        item["run_type"] = "iteration";
+        if (r.skipped) {
+            item["error_occurred"] = true;
+            item["error_message"] = r.note;
+        } else {
+            item["iterations"] = (double)r.iterations;
+            item["real_time"] = r.nsPerOp;
+            item["time_unit"] = "ns";
+            if (r.bytesPerOp > 0) {
+                item["bytes_per_second"] = r.bytesPerOp / (r.nsPerOp / 1e9);
+            }
+        }
+        benchmarks.append(item);
+    }
+
+    QJsonObject root;
+    root["context"] = context;
+    root["benchmarks"] = benchmarks;
+    return root;
+}
+
+int War3BotBench::run(const QString &outputPath)
+{
+    // 基准期间关闭日志: 避免 SRP 等路径的日志格式化计入耗时，也避免污染标准输出的 JSON
+    Logger::instance()->setDisabled(true);
+
+    fprintf(stderr, "🧪 [War3BotBench] 开始 (每项最短 %d ms)\n", m_minTimeMs);
+    {
+        // Client 构造时会扫描 war3files 并加载默认地图，协议与版本校验用例共用
+        Client client;
+        benchHashing();
+        benchProtocol(client);
+        benchCrypto();
+        benchCheckRevision(client);
+        benchPlayerTable();
+        benchSessionRegistry();
+        benchWatchdog();
+    }
+    fprintf(stderr, "   └─ ✅ 完成: %d 项\n", m_results.size());
+
+    Logger::instance()->setDisabled(false);
+
+    const QByteArray json = QJsonDocument(toJson()).toJson(QJsonDocument::Indented);
+    if (outputPath.isEmpty() || outputPath == "-") {
+        fwrite(json.constData(), 1, json.size(), stdout);
+        fflush(stdout);
+        return 0;
+    }
+
+    QFile out(outputPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        fprintf(stderr, "❌ 无法写入结果文件: %s\n", qPrintable(outputPath));
+        return 1;
+    }
+    out.write(json);
+    fprintf(stderr, "📄 结果已写入: %s\n", qPrintable(outputPath));
+    return 0;
+}
+
+// =========================================================
+// 10. 入口 (独立的 War3BotBench 可执行文件)
+// =========================================================
+
+int main(int argc, char *argv[])
+{
+    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("War3BotBench");
+    QCoreApplication::setApplicationVersion("3.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("War3Bot 热点路径基准测试");
+    parser.addHelpOption();
+
+    QCommandLineOption outOption({"o", "out"}, "基准结果 JSON 输出文件 (默认: 标准输出)", "file", "-");
+    parser.addOption(outOption);
+
+    QCommandLineOption timeOption({"t", "time"}, "每个基准用例的最短采样时间 (毫秒)", "ms", "500");
+    parser.addOption(timeOption);
+
+    QCommandLineOption filterOption({"f", "filter"}, "只运行名称包含该子串的基准用例", "filter");
+    parser.addOption(filterOption);
+
+    parser.process(app);
+
+    War3BotBench bench(parser.value(timeOption).toInt(), parser.value(filterOption));
+    return bench.run(parser.value(outOption));
+}
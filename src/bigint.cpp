@@ -4,6 +4,7 @@
  * 说明:
  *      BigInt 类的具体实现。
  *      修复了除法逻辑缺陷，实现了基于位运算的模幂优化。
+ *      模幂运算默认交给 GMP，原生实现保留作对照。
  * -------------------------------------------------------------------------
  */
 
@@ -11,6 +12,7 @@
 #include <algorithm>
 #include <QtMath>
 #include <QRandomGenerator>
+#include <gmp.h>
 
 // 辅助函数：安全读取 Vector，越界则视为 0
 quint32 BigInt::getVal(const QVector<quint32> &vec, int index)
@@ -354,9 +356,55 @@ BigInt BigInt::random(int size)
     return result;
 }
 
-// === 模幂运算 [FIXED] ===
-// 优化：使用位移和奇偶判断代替除法，避免调用 operator/
+// === 模幂运算: GMP 后端 ===
+// m_data 为低位在前的 32 位段数组，与 mpz_import/mpz_export 的 order = -1 直接对应，
+// 字节序转换仍由 toByteArray / getData 统一负责，两种后端输出完全一致
+static bool useNativePowm()
+{
+    static const bool native = !qEnvironmentVariableIsEmpty("WAR3BOT_BIGINT_NATIVE");
+    return native;
+}
+
+const char *BigInt::powmBackendName()
+{
+    return useNativePowm() ? "Native" : "GMP";
+}
+
 BigInt BigInt::powm(const BigInt &exp, const BigInt &mod) const
+{
+    // 边界语义 (指数为 0 返回 1、模数为 0) 以原生实现为准
+    if (useNativePowm() || exp == BigInt((quint64)0) || mod == BigInt((quint64)0)) {
+        return powmNative(exp, mod);
+    }
+
+    mpz_t b, e, m, r;
+    mpz_inits(b, e, m, r, NULL);
+    mpz_import(b, m_data.size(), -1, sizeof(quint32), 0, 0, m_data.constData());
+    mpz_import(e, exp.m_data.size(), -1, sizeof(quint32), 0, 0, exp.m_data.constData());
+    mpz_import(m, mod.m_data.size(), -1, sizeof(quint32), 0, 0, mod.m_data.constData());
+
+    // SRP 的指数是私钥，奇数模数 (N 为素数) 时使用常数时间版本
+    if (mpz_odd_p(m)) {
+        mpz_powm_sec(r, b, e, m);
+    } else {
+        mpz_powm(r, b, e, m);
+    }
+
+    BigInt result;
+    const size_t words = (mpz_sizeinbase(r, 2) + 31) / 32;
+    result.m_data.resize((int)qMax<size_t>(1, words));
+    result.m_data.fill(0);
+    size_t written = 0;
+    mpz_export(result.m_data.data(), &written, -1, sizeof(quint32), 0, 0, r);
+    result.trim();
+
+    mpz_clears(b, e, m, r, NULL);
+    return result;
+}
+
+// === 模幂运算: 原生实现 [FIXED] ===
+// 优化：使用位移和奇偶判断代替除法，避免调用 operator/
+BigInt BigInt::powmNative(const BigInt &exp, const BigInt &mod) const
 {
     if (exp == BigInt((quint64)0)) return BigInt((quint64)1);
     if (exp == BigInt((quint64)1)) return (*this) % mod;
@@ -364,12 +412,12 @@ BigInt BigInt::powm(const BigInt &exp, const BigInt &mod) const
     if (!exp.isOdd()) {
         // 偶数: exp >> 1
         BigInt half = exp >> 1;
-        BigInt halfPow = this->powm(half, mod);
+        BigInt halfPow = this->powmNative(half, mod);
         return (halfPow * halfPow) % mod;
     } else {
         // 奇数: exp >> 1
         BigInt half = exp >> 1;
-        BigInt halfPow = this->powm(half, mod);
+        BigInt halfPow = this->powmNative(half, mod);
         // (halfPow^2 % mod) * this % mod
         BigInt tmp = (halfPow * halfPow) % mod;
         return (tmp * (*this)) % mod;
@@ -255,6 +255,76 @@ void sha1_hash(t_hash *hashout, uint size, const void *datain)
     }
 }
 
+/**
+ * @brief 处理一个完整的 64 字节块 (大端装载)
+ */
+static void sha1_block(t_hash *hash, const unsigned char *block)
+{
+    quint32 tmp[64 + 16];
+    for (int i = 0; i < 16; i++) {
+        tmp[i] = qFromBigEndian<quint32>(block + i * 4);
+    }
+    do_hash(hash, tmp, do_sha1_hash);
+}
+
+void sha1_init(t_sha1_ctx *ctx)
+{
+    hash_init(&ctx->state);
+    ctx->length = 0;
+    ctx->bufferLen = 0;
+}
+
+/**
+ * @brief 追加数据
+ * 先补齐残留缓冲，再直接处理整块，剩余部分留待下次
+ */
+void sha1_update(t_sha1_ctx *ctx, const void *datain, uint size)
+{
+    const unsigned char *data = (const unsigned char*)datain;
+    ctx->length += size;
+
+    if (ctx->bufferLen > 0) {
+        uint take = qMin<uint>(64 - ctx->bufferLen, size);
+        memcpy(ctx->buffer + ctx->bufferLen, data, take);
+        ctx->bufferLen += take;
+        data += take;
+        size -= take;
+        if (ctx->bufferLen < 64) return;
+        sha1_block(&ctx->state, ctx->buffer);
+        ctx->bufferLen = 0;
+    }
+
+    while (size >= 64) {
+        sha1_block(&ctx->state, data);
+        data += 64;
+        size -= 64;
+    }
+
+    if (size > 0) {
+        memcpy(ctx->buffer, data, size);
+        ctx->bufferLen = size;
+    }
+}
+
+/**
+ * @brief 结束并输出摘要 (按值传入，原上下文保持可复用)
+ */
+QByteArray sha1_final(t_sha1_ctx ctx)
+{
+    // 填充: 0x80 + 0 ... + 64 位大端比特长度
+    const quint64 bitLength = ctx.length * 8;
+    unsigned char pad[64 + 8] = { 0x80 };
+    uint padLen = (ctx.bufferLen < 56) ? (56 - ctx.bufferLen) : (120 - ctx.bufferLen);
+    qToBigEndian<quint64>(bitLength, pad + padLen);
+    sha1_update(&ctx, pad, padLen + 8);
+
+    QByteArray digest(20, Qt::Uninitialized);
+    for (int i = 0; i < 5; i++) {
+        qToBigEndian<quint32>(ctx.state[i], (uchar*)digest.data() + i * 4);
+    }
+    return digest;
+}
+
 /**
  * @brief 计算小端序修正的 SHA1 (PvPGN 特有)
  * 先计算标准 SHA1，然后将结果的 5 个整数转换为大端序存储。
@@ -3,7 +3,7 @@
 #include "botmanager.h"
 
 Bot::Bot(BotManager *manager, quint32 id, QString username, QString password)
-    : QObject((QObject*)manager), id(id), username(username),
+    : QObject(nullptr), id(id), username(username),
     password(password), state(BotState::Disconnected), m_manager(manager)
 {
 }
@@ -16,6 +16,17 @@ Bot::~Bot()
     }
 }
 
+bool Bot::isInShardThread() const
+{
+    return thread() == QThread::currentThread();
+}
+
+bool Bot::isClientConnected()
+{
+    if (!client) return false;
+    return callInShard([this]() { return client->isConnected(); });
+}
+
 bool Bot::isOccupied()
 {
     return (state != BotState::Idle &&
@@ -32,14 +43,17 @@ void Bot::resetGame(bool disconnectFlag, const QString &context)
     // 1. 更新状态
     state = disconnectFlag ? BotState::Disconnected : BotState::Idle;
 
-    // 2. 驱动底层 Client 重置
-    client->resetGame();
+    // 2. 驱动底层 Client 重置 (在分片线程执行; 信号计数也由分片线程上的中继写入，一并在此清零)
+    callInShard([this, disconnectFlag]() {
+        client->resetGame();
+        m_triggerCounts.clear();
 
-    // 3. 处理 BNET 链路
-    if (disconnectFlag && client->isConnected()) {
-        LOG_INFO(QString("   ├── 🔌 动作: 正在强制切断 Client-%1 的 BNET 链路...").arg(id));
-        client->disconnectFromHost();
-    }
+        // 3. 处理 BNET 链路
+        if (disconnectFlag && client->isConnected()) {
+            LOG_INFO(QString("   ├── 🔌 动作: 正在强制切断 Client-%1 的 BNET 链路...").arg(id));
+            client->disconnectFromHost();
+        }
+    });
 
     // 4. 重置 Bot 自身的业务数据
     gameInfo                = GameInfo();
@@ -52,8 +66,6 @@ void Bot::resetGame(bool disconnectFlag, const QString &context)
     pendingRemovalReason    = "None";
     firstResetGameTime      = QDateTime::currentMSecsSinceEpoch();
 
-    m_triggerCounts.clear();
-
     LOG_INFO(QString("   └─ ✅ Bot-%1 业务数据已完全归零").arg(id));
 }
 
@@ -273,6 +285,11 @@ void Bot::setupClient(NetManager *netManager, const QString &displayName)
                    emit protectionTimeout();
                }), "protectionTimeout");
 
+    // 20. 成员变动 (BotManager 据此维护全局成员索引)
+    checkRelay(connect(client, &Client::playerMembershipChanged, this, [this](const QString &clientId, const QString &playerName, bool joined){
+                   emit playerMembershipChanged(clientId, playerName, joined);
+               }), "playerMembershipChanged");
+
     LOG_INFO(QString("   └── ✅ Bot-%1 引擎构建及信号代理完成").arg(id));
 }
 
@@ -313,12 +330,13 @@ void Bot::setupGameInfo(const QString &host, const QString &name, const QString
     gameInfo.createTime = QDateTime::currentMSecsSinceEpoch();
 
     if (client) {
-        client->setSoloMode(isSolo);
-        if (client->getUdpSocket()) {
-            gameInfo.port = client->getUdpSocket()->localPort();
+        gameInfo.port = callInShard([this, isSolo]() -> quint16 {
+            client->setSoloMode(isSolo);
+            return client->getUdpSocket() ? client->getUdpSocket()->localPort() : 0;
+        });
+        if (gameInfo.port != 0) {
             LOG_INFO(QString("   ├─ 🔌 端口捕获: %1 (来自底层 Socket)").arg(gameInfo.port));
         } else {
-            gameInfo.port = 0;
             LOG_WARNING(QString("   ├─ 🔌 端口捕获: 0 (⚠️ 警告: 底层 Socket 尚未就绪)"));
         }
     }
@@ -357,10 +375,15 @@ SignalAudit Bot::getAudit(const char* signalSignature)
     while (i < name.length() && name.at(i).isDigit()) i++;
     name = name.mid(i);
 
-    signalAudit.triggerCount = m_triggerCounts.value(name, 0);
+    signalAudit.triggerCount = callInShard([this, name]() { return m_triggerCounts.value(name, 0); });
     return signalAudit;
 }
 
 void Bot::incrementSignalCount(const QString &sigName) {
     m_triggerCounts[sigName]++;
 }
+
+void Bot::resetAuditCounts()
+{
+    postToShard([this]() { m_triggerCounts.clear(); });
+}
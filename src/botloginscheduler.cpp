@@ -0,0 +1,244 @@
+#include "botloginscheduler.h"
+#include "logger.h"
+#include "bot.h"
+#include <QRandomGenerator>
+
+namespace {
+
+// 调度节拍: 令牌补充、拨号与超时检查都在这一节拍上完成
+const int kPumpIntervalMs = 50;
+
+}
+
+BotLoginScheduler::BotLoginScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+    m_tokens = m_options.burst;
+
+    m_pumpTimer.setInterval(kPumpIntervalMs);
+    connect(&m_pumpTimer, &QTimer::timeout, this, &BotLoginScheduler::pump);
+}
+
+void BotLoginScheduler::setOptions(const BotLoginOptions &options)
+{
+    m_options = options;
+    m_options.maxInFlight = qMax(1, m_options.maxInFlight);
+    m_options.ratePerSec = qMax(0.1, m_options.ratePerSec);
+    m_options.burst = qMax(1, m_options.burst);
+    m_options.timeoutMs = qMax(1000, m_options.timeoutMs);
+    m_options.backoffBaseMs = qMax(100, m_options.backoffBaseMs);
+    m_options.backoffMaxMs = qMax(m_options.backoffBaseMs, m_options.backoffMaxMs);
+
+    m_tokens = qMin(m_tokens, double(m_options.burst));
+}
+
+bool BotLoginScheduler::enqueue(Bot *bot, int delayMs)
+{
+    if (!bot || m_entries.contains(bot)) return false;
+
+    const qint64 t = now();
+    if (!m_batchActive) {
+        m_batchActive = true;
+        m_batchStartedAt = t;
+        m_batchSucceeded = 0;
+        m_batchFailures = 0;
+    }
+
+    Entry entry;
+    entry.readyAt = t + qMax(0, delayMs);
+    m_entries.insert(bot, entry);
+    m_pending.insert(entry.readyAt, bot);
+
+    ensureRunning();
+    return true;
+}
+
+void BotLoginScheduler::reportSuccess(Bot *bot)
+{
+    auto it = m_entries.find(bot);
+    if (it == m_entries.end()) return;
+
+    if (it->inFlight) {
+        m_inFlight--;
+    } else {
+        // 排队期间经其他途径完成了登录，直接出队
+        removePending(bot, it->readyAt);
+    }
+
+    const qint64 elapsed = it->inFlight ? now() - it->startedAt : 0;
+    LOG_DEBUG(QString("🔐 [登录调度] %1 登录完成 (%2 ms, 此前失败 %3 次)")
+                  .arg(bot->username).arg(elapsed).arg(it->attempts));
+
+    m_entries.erase(it);
+    m_batchSucceeded++;
+    finishBatchIfIdle();
+}
+
+void BotLoginScheduler::reportFailure(Bot *bot, const QString &reason)
+{
+    auto it = m_entries.find(bot);
+    const qint64 t = now();
+
+    // 未被调度器跟踪的 Bot (例如断线) 也走退避重连
+    if (it == m_entries.end()) {
+        if (!m_batchActive) {
+            m_batchActive = true;
+            m_batchStartedAt = t;
+            m_batchSucceeded = 0;
+            m_batchFailures = 0;
+        }
+        it = m_entries.insert(bot, Entry());
+    } else if (!it->inFlight) {
+        // 已在退避队列中，重复的错误信号不再叠加
+        return;
+    } else {
+        it->inFlight = false;
+        m_inFlight--;
+    }
+
+    m_batchFailures++;
+    requeue(bot, *it, t);
+
+    LOG_INFO(QString("🔁 [登录调度] %1 登录失败 (%2) -> 第 %3 次重试将在 %4 ms 后进行")
+                 .arg(bot->username, reason)
+                 .arg(it->attempts)
+                 .arg(it->readyAt - t));
+
+    ensureRunning();
+}
+
+void BotLoginScheduler::remove(Bot *bot)
+{
+    auto it = m_entries.find(bot);
+    if (it == m_entries.end()) return;
+
+    if (it->inFlight) m_inFlight--;
+    else removePending(bot, it->readyAt);
+
+    m_entries.erase(it);
+    finishBatchIfIdle();
+}
+
+void BotLoginScheduler::clear()
+{
+    m_entries.clear();
+    m_pending.clear();
+    m_inFlight = 0;
+    m_batchActive = false;
+    m_pumpTimer.stop();
+}
+
+bool BotLoginScheduler::isInFlight(Bot *bot) const
+{
+    auto it = m_entries.constFind(bot);
+    return it != m_entries.constEnd() && it->inFlight;
+}
+
+void BotLoginScheduler::pump()
+{
+    const qint64 t = now();
+
+    // 1. 超时检查 (先于拨号，让超时的名额在本节拍内即可复用)
+    checkTimeouts(t);
+
+    // 2. 补充令牌
+    refillTokens(t);
+
+    // 3. 按到期时间依次拨号，直到名额、令牌或到期任务耗尽
+    while (!m_pending.isEmpty() && m_inFlight < m_options.maxInFlight && m_tokens >= 1.0) {
+        auto first = m_pending.begin();
+        if (first.key() > t) break;
+
+        Bot *bot = first.value();
+        m_pending.erase(first);
+
+        Entry &entry = m_entries[bot];
+        entry.inFlight = true;
+        entry.startedAt = t;
+        m_inFlight++;
+        m_tokens -= 1.0;
+
+        if (m_dispatcher) m_dispatcher(bot);
+    }
+
+    // 4. 空闲时停止节拍
+    if (m_pending.isEmpty() && m_inFlight == 0) {
+        m_pumpTimer.stop();
+    }
+}
+
+void BotLoginScheduler::refillTokens(qint64 now)
+{
+    const qint64 elapsed = now - m_lastRefill;
+    m_lastRefill = now;
+    if (elapsed <= 0) return;
+
+    m_tokens = qMin(double(m_options.burst), m_tokens + elapsed * m_options.ratePerSec / 1000.0);
+}
+
+void BotLoginScheduler::checkTimeouts(qint64 now)
+{
+    if (m_inFlight == 0) return;
+
+    QList<Bot*> expired;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (it->inFlight && now - it->startedAt >= m_options.timeoutMs) {
+            expired.append(it.key());
+        }
+    }
+
+    for (Bot *bot : qAsConst(expired)) {
+        LOG_WARNING(QString("⏱️ [登录调度] %1 登录超时 (%2 ms)，切断链路").arg(bot->username).arg(m_options.timeoutMs));
+        if (m_timeoutHandler) m_timeoutHandler(bot);
+        reportFailure(bot, "Login Timeout");
+    }
+}
+
+void BotLoginScheduler::requeue(Bot *bot, Entry &entry, qint64 now)
+{
+    entry.attempts++;
+    entry.readyAt = now + backoffDelay(entry.attempts);
+    m_pending.insert(entry.readyAt, bot);
+}
+
+void BotLoginScheduler::removePending(Bot *bot, qint64 readyAt)
+{
+    auto it = m_pending.find(readyAt);
+    while (it != m_pending.end() && it.key() == readyAt) {
+        if (it.value() == bot) {
+            m_pending.erase(it);
+            return;
+        }
+        ++it;
+    }
+}
+
+void BotLoginScheduler::ensureRunning()
+{
+    if (m_pumpTimer.isActive()) return;
+
+    // 从空闲恢复时不补发停机期间的令牌，避免超过突发上限
+    m_lastRefill = now();
+    m_pumpTimer.start();
+}
+
+void BotLoginScheduler::finishBatchIfIdle()
+{
+    if (!m_batchActive || !m_pending.isEmpty() || m_inFlight > 0) return;
+
+    m_batchActive = false;
+    LOG_INFO(QString("🔐 [登录调度] 全部机器人登录完成: %1 个 / 失败重试 %2 次, 耗时 %3 ms")
+                 .arg(m_batchSucceeded).arg(m_batchFailures).arg(now() - m_batchStartedAt));
+}
+
+int BotLoginScheduler::backoffDelay(int attempts) const
+{
+    // base * 2^(n-1)，封顶后再叠加 0~25% 抖动，避免一批 Bot 同时重连
+    qint64 delay = m_options.backoffBaseMs;
+    for (int i = 1; i < attempts && delay < m_options.backoffMaxMs; ++i) delay *= 2;
+    delay = qMin<qint64>(delay, m_options.backoffMaxMs);
+
+    const int jitter = QRandomGenerator::global()->bounded(int(delay / 4) + 1);
+    return int(delay) + jitter;
+}
@@ -1,12 +1,15 @@
 #include "botmanager.h"
+#include "revisioncache.h"
 #include "logger.h"
 #include <QDir>
+#include <QSet>
 #include <QThread>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QRandomGenerator>
 #include <QCoreApplication>
+#include <algorithm>
 
 // =========================================================
 // 扩充的拟人化词库 (DotA 深度定制版)
@@ -113,16 +116,117 @@ static const QStringList s_prefixes = {
     "Captain", "Carry", "Support", "Mid", "Jungle", "Best", "Top", "Only"
 };
 
+// =========================================================
+// 跨线程玩家快照
+// ---------------------------------------------------------
+// PlayerTable 是定长数组，整表按值拷贝会复制全部 16 个 PlayerData 槽位。
+// BotManager 在主线程只需要名字 / ClientId / 几个状态位，
+// 因此在分片线程内直接遍历玩家表，只摘出这些字段带回主线程。
+// =========================================================
+struct PlayerBrief {
+    quint8      pid                 = 0;
+    bool        isVisualHost        = false;
+    bool        isRealConnection    = false;
+    JoinSource  joinSource          = Unknown;
+    QString     name;
+    QString     clientId;
+};
+
+// 必须在 Client 所属的分片线程调用
+static QVector<PlayerBrief> briefPlayers(const PlayerTable &players)
+{
+    QVector<PlayerBrief> briefs;
+    briefs.reserve(players.size());
+    for (auto it = players.constBegin(); it != players.constEnd(); ++it) {
+        PlayerBrief brief;
+        brief.pid = it.key();
+        brief.isVisualHost = it->isVisualHost;
+        brief.isRealConnection = it->isRealConnection;
+        brief.joinSource = it->joinSource;
+        brief.name = it->name;
+        brief.clientId = it->clientId;
+        briefs.append(brief);
+    }
+    return briefs;
+}
+
 BotManager::BotManager(QObject *parent) : QObject(parent)
 {
+    // Bot 运行在分片线程上，其信号以排队方式投递到 BotManager
+    qRegisterMetaType<GameState>("GameState");
+    qRegisterMetaType<GameCreationStatus>("GameCreationStatus");
+    qRegisterMetaType<QMap<quint8, quint32>>("QMap<quint8,quint32>");
+
     QTimer *timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &BotManager::onBotPendingTaskTimeout);
     timer->start(1000);
+
+    // 登录调度: 拨号与超时切断都投递到 Bot 所在的分片线程
+    m_loginScheduler = new BotLoginScheduler(this);
+    m_loginScheduler->setDispatcher([this](Bot *bot) {
+        if (!isBotActive(bot, "LoginDispatch")) {
+            m_loginScheduler->remove(bot);
+            return;
+        }
+        bot->state = BotState::Unregistered;
+        LOG_INFO(QString("[%1] 发起连接...").arg(bot->username));
+        QString server = m_targetServer;
+        quint16 port = m_targetPort;
+        bot->postToShard([bot, server, port]() { bot->client->connectToHost(server, port); });
+    });
+    m_loginScheduler->setTimeoutHandler([this](Bot *bot) {
+        if (!isBotActive(bot, "LoginTimeout")) return;
+        bot->state = BotState::Disconnected;
+        bot->postToShard([bot]() { bot->client->disconnectFromHost(); });
+    });
 }
 
 BotManager::~BotManager()
 {
     cleanup();
+    stopWorkerThreads();
+}
+
+void BotManager::setupWorkerThreads(int count)
+{
+    if (!m_workerThreads.isEmpty()) return;
+
+    if (count < 0) count = QThread::idealThreadCount();
+    if (count > 64) count = 64;
+
+    if (count == 0) {
+        LOG_INFO("   ├─ 🧵 分片线程: 未启用 (全部 Bot 运行于主线程)");
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("BotShard-%1").arg(i));
+        thread->start();
+        m_workerThreads.append(thread);
+    }
+    m_nextWorkerIndex = 0;
+
+    LOG_INFO(QString("   ├─ 🧵 分片线程: %1 个工作线程已启动").arg(count));
+}
+
+void BotManager::stopWorkerThreads()
+{
+    for (QThread *thread : qAsConst(m_workerThreads)) {
+        thread->quit();
+        thread->wait();
+    }
+    qDeleteAll(m_workerThreads);
+    m_workerThreads.clear();
+}
+
+QThread *BotManager::nextWorkerThread()
+{
+    if (m_workerThreads.isEmpty()) return nullptr;
+
+    QThread *thread = m_workerThreads[m_nextWorkerIndex % m_workerThreads.size()];
+    m_nextWorkerIndex++;
+    return thread;
 }
 
 void BotManager::initializeBots(quint32 initialCount, const QString &configPath)
@@ -150,10 +254,23 @@ void BotManager::initializeBots(quint32 initialCount, const QString &configPath)
     QSettings settings(configPath, QSettings::IniFormat);
     m_targetServer = settings.value("bnet/server", "127.0.0.1").toString();
     m_targetPort = settings.value("bnet/port", 6112).toUInt();
+    bool persistRevision = settings.value("bnet/revision_cache_persist", true).toBool();
+    CheckRevisionCache::setPersistent(persistRevision);
 
     m_botDisplayName = settings.value("bots/display_name", "CC.Dota.XXX").toString();
     bool autoGenerate = settings.value("bots/auto_generate", false).toBool();
     int listNumber = settings.value("bots/list_number", 1).toInt();
+    int workerThreads = settings.value("bots/worker_threads", -1).toInt();
+
+    BotLoginOptions loginOptions;
+    loginOptions.maxInFlight = settings.value("bots/login_concurrency", loginOptions.maxInFlight).toInt();
+    loginOptions.ratePerSec = settings.value("bots/login_rate", loginOptions.ratePerSec).toDouble();
+    loginOptions.burst = settings.value("bots/login_burst", loginOptions.burst).toInt();
+    loginOptions.timeoutMs = settings.value("bots/login_timeout", loginOptions.timeoutMs).toInt();
+    loginOptions.backoffBaseMs = settings.value("bots/login_backoff_base", loginOptions.backoffBaseMs).toInt();
+    loginOptions.backoffMaxMs = settings.value("bots/login_backoff_max", loginOptions.backoffMaxMs).toInt();
+    m_loginScheduler->setOptions(loginOptions);
+    loginOptions = m_loginScheduler->options();
 
     m_initialLoginCount = initialCount;
     if (listNumber < 1) listNumber = 1;
@@ -161,9 +278,15 @@ void BotManager::initializeBots(quint32 initialCount, const QString &configPath)
 
     LOG_INFO(QString("   ├─ ⚙️ 加载配置: %1").arg(QFileInfo(configPath).fileName()));
     LOG_INFO(QString("   │  ├─ 🖥️ 服务器: %1:%2").arg(m_targetServer).arg(m_targetPort));
+    LOG_INFO(QString("   │  ├─ 🧮 版本校验缓存: %1").arg(persistRevision ? "内存 + 磁盘 (checkrevision.idx)" : "仅内存"));
     LOG_INFO(QString("   │  ├─ 👤 显示名: %1").arg(m_botDisplayName));
     LOG_INFO(QString("   │  ├─ 🏭 自动生成: %1").arg(autoGenerate ? "✅ 开启" : "⛔ 关闭"));
-    LOG_INFO(QString("   │  └─ 📑 列表编号: #%1 (仅加载 bots_auto_%2.json)").arg(listNumber).arg(listNumber, 2, 10, QChar('0')));
+    LOG_INFO(QString("   │  ├─ 📑 列表编号: #%1 (仅加载 bots_auto_%2.json)").arg(listNumber).arg(listNumber, 2, 10, QChar('0')));
+    LOG_INFO(QString("   │  └─ 🔐 登录调度: 并发 %1 / 速率 %2 个/秒 (突发 %3) / 超时 %4 ms / 退避 %5~%6 ms")
+                 .arg(loginOptions.maxInFlight).arg(loginOptions.ratePerSec).arg(loginOptions.burst)
+                 .arg(loginOptions.timeoutMs).arg(loginOptions.backoffBaseMs).arg(loginOptions.backoffMaxMs));
+
+    setupWorkerThreads(workerThreads);
 
     // 4. 生成或加载文件
     bool isNewFiles = createBotAccountFilesIfNotExist(autoGenerate, listNumber);
@@ -347,35 +470,41 @@ const QVector<Bot*>& BotManager::getAllBots() const
 
 void BotManager::startAllBots()
 {
-    int delay = 0;
-
+    // 交给登录调度器按并发上限与令牌桶节奏拨号 (已在队列或登录中的 Bot 自动忽略)
+    int queued = 0;
     for (Bot *bot : qAsConst(m_bots)) {
         if (!isBotActive(bot, "StartAllBots")) continue;
-        QTimer::singleShot(delay, this, [this, bot]() {
-            if (isBotActive(bot, "StartAllBots")) {
-                bot->state = BotState::Unregistered;
-                LOG_INFO(QString("[%1] 发起连接...").arg(bot->username));
-                bot->client->connectToHost(m_targetServer, m_targetPort);
-            }
-        });
-
-        delay += 200;
+        if (m_loginScheduler->enqueue(bot)) queued++;
     }
+
+    LOG_INFO(QString("🔐 [登录调度] 已排队 %1 个机器人 (并发上限 %2)")
+                 .arg(queued).arg(m_loginScheduler->options().maxInFlight));
 }
 
 void BotManager::cleanup()
 {
     LOG_INFO("[BotManager] 停止所有机器人...");
+    if (m_loginScheduler) m_loginScheduler->clear();
     for (Bot *bot : qAsConst(m_bots)) {
         if (bot->client) {
-            bot->client->disconnect(this);
-            bot->client->disconnectFromHost();
-            bot->client->deleteLater();
+            bot->callInShard([this, bot]() {
+                bot->client->disconnect(this);
+                bot->client->disconnectFromHost();
+                bot->client->deleteLater();
+                bot->client = nullptr;
+            });
         }
         bot->state = BotState::Disconnected;
+
+        // 分片线程上的 Bot 必须由其所属线程析构
+        if (bot->isInShardThread()) delete bot;
+        else bot->deleteLater();
     }
-    qDeleteAll(m_bots);
     m_bots.clear();
+    m_memberClientIdToBot.clear();
+    m_memberNameToBot.clear();
+    m_commandCooldowns.clear();
+    m_commandCooldownWheel.clear();
 }
 
 void BotManager::addBotInstance(const QString& username, const QString& password)
@@ -384,11 +513,17 @@ void BotManager::addBotInstance(const QString& username, const QString& password
 
     Bot *bot = new Bot(this, m_globalBotIdCounter++, username, password);
 
+    // 分配分片线程 (Client 及其 Socket/定时器将在该线程上创建)
+    if (QThread *shard = nextWorkerThread()) {
+        bot->moveToThread(shard);
+        LOG_INFO(QString("   ├─ 🧵 分片线程: %1").arg(shard->objectName()));
+    }
+
     // 先添加机器人，否则无法创建游戏。
     m_bots.append(bot);
 
     LOG_INFO(QString("   ├─ ⚙️ 步骤1: 执行 bot->setupClient..."));
-    bot->setupClient(m_netManager, m_botDisplayName);
+    bot->callInShard([this, bot]() { bot->setupClient(m_netManager, m_botDisplayName); });
 
     LOG_INFO(QString("   ├─ 🔗 步骤2: 执行 setupBotConnections..."));
     setupBotConnections(bot);
@@ -543,6 +678,11 @@ void BotManager::setupBotConnections(Bot *bot)
                      onBotProtectionTimeout(bot);
                  }), "playerTransitioned");
 
+    // 19. 房间成员变动
+    checkConnect(connect(bot, &Bot::playerMembershipChanged, this, [this, bot](const QString &clientId, const QString &playerName, bool joined) {
+                     onBotPlayerMembershipChanged(bot, clientId, playerName, joined);
+                 }), "playerMembershipChanged");
+
     LOG_INFO(QString("   │  ✅ Bot-%1 全部信号隧道建立完毕").arg(bot->id));
 }
 
@@ -568,7 +708,7 @@ bool BotManager::createGame(const QString &hostName, const QString &gameName, co
 
         SignalAudit authAudit = bot->getAudit(SIGNAL(authenticated()));
         SignalAudit chatAudit = bot->getAudit(SIGNAL(enteredChat()));
-        QString connectString = (bot->client && bot->client->isConnected()) ? "🌐 Online" : "🔌 Offline";
+        QString connectString = bot->isClientConnected() ? "🌐 Online" : "🔌 Offline";
         LOG_INFO(QString("   │  [%1] %2 | %3 | 状态: %4 | 任务: %5")
                      .arg(i + 1, 2)
                      .arg(bot->username.leftJustified(12), connectString,
@@ -589,7 +729,7 @@ bool BotManager::createGame(const QString &hostName, const QString &gameName, co
                                 bot->state == BotState::InLobby ||
                                 bot->state == BotState::Authenticated);
 
-        if (isProtocolReady && bot->client && bot->client->isConnected() && !bot->pendingTask.hasTask) {
+        if (isProtocolReady && !bot->pendingTask.hasTask && bot->isClientConnected()) {
             targetBot = bot;
             LOG_INFO(QString("   ✅ [P1-就绪指派] 选中在线机器人: [%1]").arg(targetBot->username));
             break;
@@ -633,16 +773,19 @@ bool BotManager::createGame(const QString &hostName, const QString &gameName, co
     if (targetBot) {
         targetBot->state = BotState::Creating;
         targetBot->setupGameInfo(hostName, gameName, gameMode, commandSource, clientId, isSolo);
-        if (targetBot->client && targetBot->client->isConnected()) {
+        if (targetBot->isClientConnected()) {
             if (targetBot->state == BotState::Authenticated ||
                 targetBot->state == BotState::Creating ||
                 targetBot->state == BotState::InLobby ||
                 targetBot->state == BotState::Idle) {
-                targetBot->client->setHost(hostName);
-                targetBot->client->setBotDisplayName(m_botDisplayName);
-                targetBot->client->createGame(gameName, "", Provider_TFT_New,
-                                              Game_TFT_Custom, SubType_None, Ladder_None,
-                                              commandSource);
+                QString displayName = m_botDisplayName;
+                targetBot->postToShard([targetBot, hostName, displayName, gameName, commandSource]() {
+                    targetBot->client->setHost(hostName);
+                    targetBot->client->setBotDisplayName(displayName);
+                    targetBot->client->createGame(gameName, "", Provider_TFT_New,
+                                                  Game_TFT_Custom, SubType_None, Ladder_None,
+                                                  commandSource);
+                });
 
                 LOG_INFO(QString("   🚀 [同步执行] 模式已设为 %1 | 发送 0x1C | 端口: %2 [%3]")
                              .arg(isSolo ? "SOLO" : "NORMAL")
@@ -656,9 +799,11 @@ bool BotManager::createGame(const QString &hostName, const QString &gameName, co
         }
         else {
             targetBot->setupPendingTask(hostName, gameName, gameMode, clientId, commandSource, isSolo);
-            targetBot->setupClient(m_netManager, m_botDisplayName);
             targetBot->state = BotState::Connecting;
-            targetBot->client->connectToHost(m_targetServer, m_targetPort);
+            targetBot->callInShard([this, targetBot]() {
+                targetBot->setupClient(m_netManager, m_botDisplayName);
+                targetBot->client->connectToHost(m_targetServer, m_targetPort);
+            });
 
             LOG_INFO(QString("   🔌 [重新拨号] 发起全新连接并预约 SOLO 任务 [%1]").arg(targetBot->username));
         }
@@ -734,7 +879,7 @@ void BotManager::removeGame(Bot *bot, bool disconnectFlag, const QString &reason
     // D. 执行最后的协议层面取消动作
     if (bot->client) {
         LOG_INFO(QString("   └─ 📡 协议动作: 调用底层 Client::cancelGame"));
-        bot->client->cancelGame();
+        bot->postToShard([bot]() { if (bot->client) bot->client->cancelGame(); });
     }
 }
 
@@ -743,13 +888,18 @@ void BotManager::rejectCommandWithNotice(Bot *bot, const QString &clientId, cons
     LOG_INFO(QString("🚫 [指令拒绝序列] 捕捉到非法操作: %1").arg(command));
 
     if (isBotActive(bot, "Reject Command With Notice")) {
-        quint8 myPid = bot->client->getPidByClientId(clientId);
+        quint8 myPid = 0;
+        QString myName = bot->callInShard([bot, clientId, command, &myPid]() -> QString {
+            myPid = bot->client->getPidByClientId(clientId);
+            if (myPid == 0) return QString();
+            bot->client->sendAccessDeniedMessage(myPid, command);
+            return bot->client->getPlayerNameByPid(myPid);
+        });
         if (myPid != 0) {
             LOG_INFO(QString("   ├─ 👤 目标确认: %1 (PID: %2) @ %3")
-                         .arg(bot->client->getPlayerNameByPid(myPid))
+                         .arg(myName)
                          .arg(myPid)
                          .arg(bot->username));
-            bot->client->sendAccessDeniedMessage(myPid, command);
         } else {
             LOG_INFO(QString("   ├─ 👤 目标定位失败: ClientId [%1] 当前不在房间中").arg(clientId));
         }
@@ -988,14 +1138,13 @@ Bot *BotManager::findBotByMemberClientId(const QString &clientId, bool onlyOccup
         }
     }
 
-    for (Bot *bot : qAsConst(m_bots)) {
-        if (isBotActive(bot, "FindMemberByClientId-Guest")) {
-            bool stateValid = !onlyOccupied || bot->isOccupied();
-            if (stateValid && !bot->gameInfo.gameName.isEmpty() && !bot->gameInfo.hostName.isEmpty()) {
-                if (bot->client->hasPlayerByClientId(clientId)) {
-                    return bot;
-                }
-            }
+    // 玩家可能同时在多个房间，取第一个满足条件的
+    for (auto it = m_memberClientIdToBot.constFind(clientId); it != m_memberClientIdToBot.constEnd() && it.key() == clientId; ++it) {
+        Bot *memberBot = it.value();
+        if (!isBotActive(memberBot, "FindMemberByClientId-Guest")) continue;
+        bool stateValid = !onlyOccupied || memberBot->isOccupied();
+        if (stateValid && !memberBot->gameInfo.gameName.isEmpty() && !memberBot->gameInfo.hostName.isEmpty()) {
+            return memberBot;
         }
     }
 
@@ -1015,14 +1164,13 @@ Bot *BotManager::findBotByMemberUserName(const QString &userName, bool onlyOccup
         }
     }
 
-    for (Bot *bot : qAsConst(m_bots)) {
-        if (isBotActive(bot, "FindMemberByUserName-Guest")) {
-            bool stateValid = !onlyOccupied || bot->isOccupied();
-            if (stateValid && !bot->gameInfo.gameName.isEmpty() && !bot->gameInfo.hostName.isEmpty()) {
-                if (bot->client->hasPlayerByUserName(userName)) {
-                    return bot;
-                }
-            }
+    // 玩家可能同时在多个房间，取第一个满足条件的
+    for (auto it = m_memberNameToBot.constFind(lowerName); it != m_memberNameToBot.constEnd() && it.key() == lowerName; ++it) {
+        Bot *memberBot = it.value();
+        if (!isBotActive(memberBot, "FindMemberByUserName-Guest")) continue;
+        bool stateValid = !onlyOccupied || memberBot->isOccupied();
+        if (stateValid && !memberBot->gameInfo.gameName.isEmpty() && !memberBot->gameInfo.hostName.isEmpty()) {
+            return memberBot;
         }
     }
 
@@ -1102,12 +1250,12 @@ bool BotManager::checkCooldown(const QString &clientId, const QString &command,
     qint64 requiredWait = cooldownRules.value(command, DEFAULT_COOLDOWN);
 
     // 2. 检查记录
-    if (m_commandCooldowns.contains(clientId)) {
-        qint64 lastExec = m_commandCooldowns[clientId].value(command, 0);
-        qint64 diff = now - lastExec;
+    auto clientIt = m_commandCooldowns.constFind(clientId);
+    if (clientIt != m_commandCooldowns.constEnd()) {
+        qint64 expireAt = clientIt.value().value(command, 0);
 
-        if (diff < requiredWait) {
-            quint32 remaining = static_cast<quint32>(requiredWait - diff);
+        if (now < expireAt) {
+            quint32 remaining = static_cast<quint32>(expireAt - now);
             QString flag = extractCommandName(command);
             // 通知客户端进入冷却
             m_netManager->sendMessageToClient(clientId, S_C_ERROR, ERR_COOLDOWN, remaining, flag, false);
@@ -1118,11 +1266,37 @@ bool BotManager::checkCooldown(const QString &clientId, const QString &command,
         }
     }
 
-    // 3. 更新时间戳并放行
-    m_commandCooldowns[clientId][command] = now;
+    // 3. 记录到期时间并放行 (该 clientId 的全部冷却到期后由时间轮整体移除)
+    const qint64 expireAt = now + requiredWait;
+    m_commandCooldowns[clientId][command] = expireAt;
+    if (m_commandCooldownWheel.deadline(clientId) < expireAt) {
+        m_commandCooldownWheel.schedule(clientId, expireAt);
+    }
     return true;
 }
 
+void BotManager::pruneCommandCooldowns(qint64 now)
+{
+    m_commandCooldownWheel.advance(now, [this, now](const QString &clientId) {
+        auto it = m_commandCooldowns.find(clientId);
+        if (it == m_commandCooldowns.end()) return;
+
+        // 时钟粒度内仍未到期的条目保留，并按最晚的到期时间重新登记
+        qint64 latest = 0;
+        for (auto cmdIt = it->begin(); cmdIt != it->end(); ) {
+            if (cmdIt.value() <= now) {
+                cmdIt = it->erase(cmdIt);
+            } else {
+                latest = qMax(latest, cmdIt.value());
+                ++cmdIt;
+            }
+        }
+
+        if (it->isEmpty()) m_commandCooldowns.erase(it);
+        else m_commandCooldownWheel.schedule(clientId, latest);
+    });
+}
+
 ErrorCode BotManager::checkStartCondition(Bot *bot, const QString &clientId, quint8 &current, quint8 &required)
 {
     if (!isBotActive(bot, "CheckStartCondition")) return ERR_UNKNOWN;
@@ -1136,8 +1310,25 @@ ErrorCode BotManager::checkStartCondition(Bot *bot, const QString &clientId, qui
     int scourgeHumans = 0;
     bool allReady = true;
 
-    const QVector<GameSlot> &gameSlots = bot->client->getGameSlots();
-    const QMap<quint8, PlayerData> &playerDataMap = bot->client->getPlayers();
+    // 从分片线程取房间快照
+    QVector<GameSlot> gameSlots;
+    QSet<quint8> unreadyPids;
+    QStringList unreadyNames;
+    bot->callInShard([bot, &gameSlots, &unreadyPids, &unreadyNames]() {
+        gameSlots = bot->client->getGameSlots();
+        const PlayerTable &players = bot->client->getPlayers();
+
+        // 未准备玩家的彩色名字 (Client 的着色依赖其房间状态，须在分片线程生成)
+        for (const GameSlot &slot : qAsConst(gameSlots)) {
+            if (slot.slotStatus == Occupied && slot.pid != 0 && slot.pid != 2) {
+                auto it = players.constFind(slot.pid);
+                if (it != players.constEnd() && !it->isReady) {
+                    unreadyPids.insert(slot.pid);
+                    unreadyNames << bot->client->getColoredTextByState(*it, it->name, true);
+                }
+            }
+        }
+    });
 
     for (const GameSlot &gameSlot : gameSlots) {
         if (gameSlot.slotStatus == Occupied && gameSlot.computer == Human && gameSlot.pid != 0 && gameSlot.pid != 2) {
@@ -1147,10 +1338,8 @@ ErrorCode BotManager::checkStartCondition(Bot *bot, const QString &clientId, qui
             else if (gameSlot.team == 1) scourgeHumans++;
 
             // B. 检查准备状态
-            if (playerDataMap.contains(gameSlot.pid)) {
-                if (!playerDataMap[gameSlot.pid].isReady) {
-                    allReady = false;
-                }
+            if (unreadyPids.contains(gameSlot.pid)) {
+                allReady = false;
             }
         }
     }
@@ -1166,7 +1355,7 @@ ErrorCode BotManager::checkStartCondition(Bot *bot, const QString &clientId, qui
             msg.add("zh_CN", "无法开始游戏。Solo模式需要对阵双方各就各位。")
                 .add("en", "Cannot start. Solo mode requires one player on each side.");
 
-            bot->client->broadcastChatMessage(msg);
+            bot->postToShard([bot, msg]() { bot->client->broadcastChatMessage(msg); });
             return ERR_NOT_ENOUGH_PLAYERS;
         }
     } else {
@@ -1176,22 +1365,13 @@ ErrorCode BotManager::checkStartCondition(Bot *bot, const QString &clientId, qui
             msg.add("zh_CN", QString("无法开始游戏。当前人数不足 (当前: %1, 所需: %2)。").arg(current).arg(required))
                 .add("en", QString("Cannot start. Not enough players (Current: %1, Required: %2).").arg(current).arg(required));
 
-            bot->client->broadcastChatMessage(msg);
+            bot->postToShard([bot, msg]() { bot->client->broadcastChatMessage(msg); });
             return ERR_NOT_ENOUGH_PLAYERS;
         }
     }
 
     // 4. 执行全员准备判定
     if (!allReady) {
-        QStringList unreadyNames;
-        for (const GameSlot &slot : gameSlots) {
-            if (slot.slotStatus == Occupied && slot.pid != 0 && slot.pid != 2) {
-                if (playerDataMap.contains(slot.pid) && !playerDataMap[slot.pid].isReady) {
-                    unreadyNames << bot->client->getColoredTextByState(slot.pid, playerDataMap[slot.pid].name, true);
-                }
-            }
-        }
-
         MultiLangMsg msg;
         QString namesText = unreadyNames.join(", ");
 
@@ -1199,7 +1379,7 @@ ErrorCode BotManager::checkStartCondition(Bot *bot, const QString &clientId, qui
             .add("en", "Cannot start. Waiting for: " + namesText);
 
         // 广播给所有人
-        bot->client->broadcastChatMessage(msg);
+        bot->postToShard([bot, msg]() { bot->client->broadcastChatMessage(msg); });
 
         return ERR_PLAYERS_NOT_READY;
     }
@@ -1226,23 +1406,26 @@ void BotManager::handleStartWar3(const QString &clientId, const QString& roomNam
         LOG_INFO(QString("   └─ ✅ 验证通过: 准备全员广播启动指令 (当前:%1/所需:%2)").arg(current).arg(required));
 
         if (bot->client) {
-            MultiLangMsg startMsg;
-            startMsg.add("zh_CN", bot->client->coloredGreenText("房主已在平台发起启动指令，正在调起全员魔兽进程..."))
-                .add("en",    bot->client->coloredGreenText("Host started the game via Launcher. Launching others..."));
-            bot->client->broadcastChatMessage(startMsg);
-
-            // A. 开启替换模式锁
-            bot->client->setIsLaunching(true);
+            // A. 广播启动消息并开启替换模式锁
+            // B. 获取房间内所有玩家数据 (连同机器人自身的 PID)
+            quint8 botPid = 0;
+            const QVector<PlayerBrief> players = bot->callInShard([bot, &botPid]() {
+                MultiLangMsg startMsg;
+                startMsg.add("zh_CN", bot->client->coloredGreenText("房主已在平台发起启动指令，正在调起全员魔兽进程..."))
+                    .add("en",    bot->client->coloredGreenText("Host started the game via Launcher. Launching others..."));
 
-            // B. 获取房间内所有玩家数据
-            const QMap<quint8, PlayerData> &players = bot->client->getPlayers();
+                bot->client->broadcastChatMessage(startMsg);
+                bot->client->setIsLaunching(true);
+                botPid = bot->client->getBotPid();
+                return briefPlayers(bot->client->getPlayers());
+            });
 
             // 提取并序列化授权玩家白名单
             QStringList whitelistNames;
-            for (auto it = players.begin(); it != players.end(); ++it) {
-                if (it.key() == bot->client->getBotPid()) continue; // 排除机器人
-                if (!it.value().name.isEmpty()) {
-                    whitelistNames << it.value().name;
+            for (const PlayerBrief &player : players) {
+                if (player.pid == botPid) continue; // 排除机器人
+                if (!player.name.isEmpty()) {
+                    whitelistNames << player.name;
                 }
             }
             QByteArray whitelistData = QJsonDocument(QJsonArray::fromStringList(whitelistNames)).toJson(QJsonDocument::Compact);
@@ -1250,11 +1433,9 @@ void BotManager::handleStartWar3(const QString &clientId, const QString& roomNam
             int broadcastCount = 0;
 
             // C. 循环发送给每一个 Launcher 玩家
-            for (auto it = players.begin(); it != players.end(); ++it) {
-                const PlayerData &playerData = it.value();
-
+            for (const PlayerBrief &playerData : players) {
                 // 跳过机器人
-                if (playerData.pid == bot->client->getBotPid()) continue;
+                if (playerData.pid == botPid) continue;
                 // 只有处于 Launcher (虚拟占座) 状态的玩家，才需要发调起指令
                 if (!playerData.clientId.isEmpty() && playerData.joinSource == Launcher) {
                     m_netManager->sendStartWar3(playerData.clientId, 1, ERR_OK, current, required, whitelistData);
@@ -1281,15 +1462,18 @@ void BotManager::handleStartWar3(const QString &clientId, const QString& roomNam
     }
     else {
         // 验证失败，向全房间广播启动失败的原因
-        if (bot->client) {
+        quint8 botPid = 0;
+        const QVector<PlayerBrief> players = bot->callInShard([bot, current, required, &botPid]() -> QVector<PlayerBrief> {
+            if (!bot->client) return {};
             bot->client->sendStartConditionFailedMessage(0, current, required);
-        }
+            botPid = bot->client->getBotPid();
+            return briefPlayers(bot->client->getPlayers());
+        });
 
         // 通知所有 Launcher 重置按钮状态 (status=0)
-        const QMap<quint8, PlayerData> &players = bot->client->getPlayers();
-        for (auto it = players.begin(); it != players.end(); ++it) {
-            if (it.key() != bot->client->getBotPid() && !it.value().clientId.isEmpty()) {
-                m_netManager->sendStartWar3(it.value().clientId, 0, err, current, required, QByteArray());
+        for (const PlayerBrief &player : players) {
+            if (player.pid != botPid && !player.clientId.isEmpty()) {
+                m_netManager->sendStartWar3(player.clientId, 0, err, current, required, QByteArray());
             }
         }
         LOG_ERROR(QString("   └─ ❌ 验证失败: 错误码 %1").arg(err));
@@ -1307,7 +1491,9 @@ void BotManager::handleReplaceSlot(const QString &clientId, const QString &userN
     }
 
     LOG_INFO(QString("   ├── 🎯 命中机器人房间: %1，开始执行物理接管流程").arg(targetBot->username));
-    targetBot->client->handlePlayerReplaceByClientId(clientId, userName);
+    targetBot->postToShard([targetBot, clientId, userName]() {
+        targetBot->client->handlePlayerReplaceByClientId(clientId, userName);
+    });
 }
 
 void BotManager::handleHostCommand(const QString &userName, const QString &clientId, const QString &text)
@@ -1412,9 +1598,11 @@ void BotManager::onBotAuthenticated(Bot *bot)
     bot->state = BotState::Authenticated;
     LOG_INFO(QString("🔑 [状态更新] Bot-%1 (%2) 验证通过，准备进入大厅").arg(bot->id).arg(bot->username));
 
+    m_loginScheduler->reportSuccess(bot);
+
     emit botStateChanged(bot->id, bot->username, bot->state);
 
-    bot->client->enterChat();
+    bot->postToShard([bot]() { bot->client->enterChat(); });
 }
 
 void BotManager::onBotAccountCreated(Bot *bot)
@@ -1484,8 +1672,10 @@ void BotManager::onBotCommandReceived(const QString &userName,
         bool isReady = (trimmedCommand == "/ready");
         LOG_DEBUG(QString("   └─ ⚙️ 执行状态变更: [%1] -> %2").arg(userName, isReady ? "READY" : "UNREADY"));
 
-        client->setPlayerReadyStates(clientId, userName, isReady);
-        client->syncPlayerReadyStates();
+        targetBot->postToShard([client, clientId, userName, isReady]() {
+            client->setPlayerReadyStates(clientId, userName, isReady);
+            client->syncPlayerReadyStates();
+        });
 
         LOG_INFO(QString("   └─ ✅ 执行成功: 玩家 %1 状态已同步为 [%2]")
                      .arg(userName, isReady ? "已准备" : "已取消准备"));
@@ -1494,27 +1684,29 @@ void BotManager::onBotCommandReceived(const QString &userName,
     else if (trimmedCommand == "/leave") {
         LOG_INFO(QString("   └─ 🚪 玩家 %1 请求离开房间 [%2]").arg(userName, targetBot->username));
 
-        bool success = client->disconnectPlayerByClientId(clientId);
-        if (!success) {
+        bool success = targetBot->callInShard([client, clientId, userName]() {
+            if (client->disconnectPlayerByClientId(clientId)) return true;
             LOG_INFO("   ├─ 🔍 ClientId 匹配失败，尝试通过 UserName 匹配...");
-            success = client->disconnectPlayerByUserName(userName);
-        }
+            return client->disconnectPlayerByUserName(userName);
+        });
 
         m_netManager->sendMessageToClient(clientId, S_C_MESSAGE, MSG_PLAYER_LEAVE_GAME, success ? 1 : 0);
         LOG_INFO(QString("   └─ %1 执行结果: %2").arg(success ? "✅" : "❌", success ? "已断开" : "未找到玩家"));
         return;
     }
     else if (trimmedCommand == "/swapself") {
-        quint8 myPid = client->getPidByClientId(clientId);
-        if (myPid == 0) myPid = client->getPidByPlayerName(userName);
-
-        if (myPid != 0) {
-            int mySlotIndex = client->getSlotIndexByPid(myPid);
-            if (mySlotIndex != -1) {
-                client->swapSlots(mySlotIndex + 1, mySlotIndex + 1);
-                LOG_INFO(QString("   └─ ✅ 执行成功: 玩家 %1 状态已刷新").arg(userName));
+        targetBot->postToShard([client, clientId, userName]() {
+            quint8 myPid = client->getPidByClientId(clientId);
+            if (myPid == 0) myPid = client->getPidByPlayerName(userName);
+
+            if (myPid != 0) {
+                int mySlotIndex = client->getSlotIndexByPid(myPid);
+                if (mySlotIndex != -1) {
+                    client->swapSlots(mySlotIndex + 1, mySlotIndex + 1);
+                    LOG_INFO(QString("   └─ ✅ 执行成功: 玩家 %1 状态已刷新").arg(userName));
+                }
             }
-        }
+        });
         return;
     }
     else if (trimmedCommand == "/swap") {
@@ -1526,18 +1718,22 @@ void BotManager::onBotCommandReceived(const QString &userName,
 
         int s1 = parts[0].toInt();
         int s2 = parts[1].toInt();
-        quint8 myPid = client->getPidByPlayerName(userName);
-        int myUserFriendlySlot = client->getSlotIndexByPid(myPid) + 1;
-
         bool isOwner = targetBot->isOwner(clientId);
-        bool involvesMe = (s1 == myUserFriendlySlot || s2 == myUserFriendlySlot);
-        bool targetOccupied = (s1 == myUserFriendlySlot) ? client->isSlotOccupied(s2) : client->isSlotOccupied(s1);
+        bool involvesMe = false;
 
         // 权限判定：房主随意换，普通玩家只能互换自己所在的空位
-        bool permissionAllowed = isOwner || (involvesMe && !targetOccupied);
+        bool permissionAllowed = targetBot->callInShard([client, userName, s1, s2, isOwner, &involvesMe]() {
+            quint8 myPid = client->getPidByPlayerName(userName);
+            int myUserFriendlySlot = client->getSlotIndexByPid(myPid) + 1;
+
+            involvesMe = (s1 == myUserFriendlySlot || s2 == myUserFriendlySlot);
+            bool targetOccupied = (s1 == myUserFriendlySlot) ? client->isSlotOccupied(s2) : client->isSlotOccupied(s1);
+            bool allowed = isOwner || (involvesMe && !targetOccupied);
+            if (allowed) client->swapSlots(s1, s2);
+            return allowed;
+        });
 
         if (permissionAllowed) {
-            client->swapSlots(s1, s2);
             LOG_INFO(QString("   └── ✅ 执行成功: 槽位对调完成 (%1 <-> %2)").arg(s1).arg(s2));
         } else {
             QString reason = !involvesMe ? "只能交换自己" : "目标槽位已被占用";
@@ -1575,14 +1771,15 @@ void BotManager::onBotCommandReceived(const QString &userName,
         if (err != ERR_OK) {
             // 校验失败逻辑：通知所有 Launcher 客户端重置 UI 状态
             if (client) {
-                const QMap<quint8, PlayerData> &players = client->getPlayers();
-                for (auto it = players.begin(); it != players.end(); ++it) {
-                    const PlayerData &playerData = it.value();
+                const QVector<PlayerBrief> players = targetBot->callInShard([client]() { return briefPlayers(client->getPlayers()); });
+                for (const PlayerBrief &playerData : players) {
                     if (playerData.pid != 2 && !playerData.clientId.isEmpty()) {
                         m_netManager->sendStartWar3(playerData.clientId, 0, err, current, required, QByteArray());
                     }
                 }
-                client->sendStartConditionFailedMessage(0, current, required);
+                targetBot->postToShard([client, current, required]() {
+                    client->sendStartConditionFailedMessage(0, current, required);
+                });
             }
             return;
         }
@@ -1590,25 +1787,28 @@ void BotManager::onBotCommandReceived(const QString &userName,
         // 2. 校验通过，执行启动序列
         if (client) {
             // 广播启动消息给魔兽大厅
-            MultiLangMsg startMsg;
-            startMsg.add("zh_CN", client->coloredGreenText("房主已发起启动指令，正在调起全员魔兽进程..."))
-                .add("en",    client->coloredGreenText("Host started the game. Launching all clients..."));
-            client->broadcastChatMessage(startMsg);
-
             // A-1. 开启替换模式锁并生成白名单
-            client->setIsLaunching(true);
-            const QMap<quint8, PlayerData> &players = client->getPlayers();
+            quint8 botPid = 0;
+            const QVector<PlayerBrief> players = targetBot->callInShard([client, &botPid]() {
+                MultiLangMsg startMsg;
+                startMsg.add("zh_CN", client->coloredGreenText("房主已发起启动指令，正在调起全员魔兽进程..."))
+                    .add("en",    client->coloredGreenText("Host started the game. Launching all clients..."));
+
+                client->broadcastChatMessage(startMsg);
+                client->setIsLaunching(true);
+                botPid = client->getBotPid();
+                return briefPlayers(client->getPlayers());
+            });
 
             QStringList whitelistNames;
-            for (auto it = players.begin(); it != players.end(); ++it) {
-                if (it.key() != 2 && !it.value().name.isEmpty()) whitelistNames << it.value().name;
+            for (const PlayerBrief &player : players) {
+                if (player.pid != 2 && !player.name.isEmpty()) whitelistNames << player.name;
             }
             QByteArray whitelistData = QJsonDocument(QJsonArray::fromStringList(whitelistNames)).toJson(QJsonDocument::Compact);
 
             bool everyoneIsReadyInGame = true;
-            for (auto it = players.begin(); it != players.end(); ++it) {
-                if (it.key() == client->getBotPid()) continue;
-                const PlayerData &playerData = it.value();
+            for (const PlayerBrief &playerData : players) {
+                if (playerData.pid == botPid) continue;
                 if (playerData.joinSource == Launcher && !playerData.isRealConnection) {
                     everyoneIsReadyInGame = false;
                     break;
@@ -1618,7 +1818,7 @@ void BotManager::onBotCommandReceived(const QString &userName,
             if (everyoneIsReadyInGame) {
                 // 场景 A: 全员就绪，直接开局
                 LOG_INFO("⚡ [即时启动] 检测到所有玩家已在魔兽内就绪，跳过调起流程，直接开局！");
-                client->startGame();
+                targetBot->postToShard([client]() { client->startGame(); });
                 targetBot->state = BotState::Starting;
                 emit botStateChanged(targetBot->id, targetBot->username, targetBot->state);
                 onBotGameStateChanged(targetBot, QString(), GAME_STATE_STARTING);
@@ -1628,22 +1828,22 @@ void BotManager::onBotCommandReceived(const QString &userName,
                 LOG_INFO(QString("🚀 [启动序列] 房主 [%1] 发起启动，正在调起待命玩家...").arg(userName));
 
                 // 向魔兽大厅发送广播回执
-                MultiLangMsg startMsg;
-                startMsg.add("zh_CN", client->coloredGreenText("房主已发起启动指令，正在调起全员魔兽进程..."))
-                    .add("en",    client->coloredGreenText("Host started the game. Launching all clients..."));
-                client->broadcastChatMessage(startMsg);
-
-                client->setIsLaunching(true);
+                targetBot->postToShard([client]() {
+                    MultiLangMsg startMsg;
+                    startMsg.add("zh_CN", client->coloredGreenText("房主已发起启动指令，正在调起全员魔兽进程..."))
+                        .add("en",    client->coloredGreenText("Host started the game. Launching all clients..."));
+                    client->broadcastChatMessage(startMsg);
+                    client->setIsLaunching(true);
+                });
 
                 // 生成白名单
                 QStringList whitelistNames;
-                for (auto it = players.begin(); it != players.end(); ++it) {
-                    if (it.key() != client->getBotPid() && !it.value().name.isEmpty()) whitelistNames << it.value().name;
+                for (const PlayerBrief &player : players) {
+                    if (player.pid != botPid && !player.name.isEmpty()) whitelistNames << player.name;
                 }
                 QByteArray whitelistData = QJsonDocument(QJsonArray::fromStringList(whitelistNames)).toJson(QJsonDocument::Compact);
 
-                for (auto it = players.begin(); it != players.end(); ++it) {
-                    const PlayerData &playerData = it.value();
+                for (const PlayerBrief &playerData : players) {
                     if (playerData.pid != 2 && !playerData.clientId.isEmpty()) {
                         if (playerData.joinSource == Launcher && !playerData.isRealConnection) {
                             m_netManager->sendStartWar3(playerData.clientId, 1, ERR_OK, current, required, whitelistData);
@@ -1673,20 +1873,25 @@ void BotManager::onBotCommandReceived(const QString &userName,
         bool isSlotNum;
         int slotNum = target.toInt(&isSlotNum);
 
-        if (isSlotNum) {
-            // A. 按槽位号踢人
-            int idx = slotNum - 1;
-            const QVector<GameSlot> &gameSlots = client->getGameSlots();
-
-            if (idx >= 0 && idx < gameSlots.size()) {
-                targetPid = gameSlots[idx].pid;
-                kickedPlayerName = client->getPlayerNameByPid(targetPid);
+        quint8 botPid = 0;
+        quint8 myPid = targetBot->callInShard([client, clientId, target, isSlotNum, slotNum, &targetPid, &kickedPlayerName, &botPid]() {
+            botPid = client->getBotPid();
+            if (isSlotNum) {
+                // A. 按槽位号踢人
+                int idx = slotNum - 1;
+                const QVector<GameSlot> gameSlots = client->getGameSlots();
+
+                if (idx >= 0 && idx < gameSlots.size()) {
+                    targetPid = gameSlots[idx].pid;
+                    kickedPlayerName = client->getPlayerNameByPid(targetPid);
+                }
+            } else {
+                // B. 按名字踢人
+                targetPid = client->getPidByPlayerName(target);
+                kickedPlayerName = target;
             }
-        } else {
-            // B. 按名字踢人
-            targetPid = client->getPidByPlayerName(target);
-            kickedPlayerName = target;
-        }
+            return client->getPidByClientId(clientId);
+        });
 
         // 2. 执行踢出前的安全检查
         if (targetPid == 0) {
@@ -1694,30 +1899,32 @@ void BotManager::onBotCommandReceived(const QString &userName,
             return;
         }
 
-        if (targetPid == client->getBotPid()) {
+        if (targetPid == botPid) {
             LOG_WARNING("   └─ 🛡️ [保护] 拦截到踢出机器人的操作");
             return;
         }
 
         // 防止房主踢出自己（可选）
-        if (client->getPidByClientId(clientId) == targetPid) {
+        if (myPid == targetPid) {
             LOG_WARNING("   └─ 🛡️ [保护] 房主尝试踢出自己，已忽略");
             return;
         }
 
         // 3. 执行物理断开
-        success = client->disconnectPlayerByPid(targetPid);
+        success = targetBot->callInShard([client, targetPid]() { return client->disconnectPlayerByPid(targetPid); });
 
         if (success) {
             LOG_INFO(QString("👞 [执行踢出] 房主 %1 踢出了玩家: %2 (PID: %3)")
                          .arg(userName, kickedPlayerName).arg(targetPid));
 
             // 4. 发送魔兽内多语言广播
-            MultiLangMsg msg;
-            QString coloredName = client->coloredRedText(kickedPlayerName);
-            msg.add("zh_CN", QString("玩家 [%1] 被房主踢出了房间。").arg(coloredName))
-                .add("en",    QString("Player [%1] was kicked by the host.").arg(coloredName));
-            client->broadcastChatMessage(msg);
+            targetBot->postToShard([client, kickedPlayerName]() {
+                MultiLangMsg msg;
+                QString coloredName = client->coloredRedText(kickedPlayerName);
+                msg.add("zh_CN", QString("玩家 [%1] 被房主踢出了房间。").arg(coloredName))
+                    .add("en",    QString("Player [%1] was kicked by the host.").arg(coloredName));
+                client->broadcastChatMessage(msg);
+            });
         }
 
         return;
@@ -1730,7 +1937,7 @@ void BotManager::onBotCommandReceived(const QString &userName,
         int val = text.toInt();
         if (val >= 10 && val <= 100) {
             LOG_INFO(QString("   └─ 🚀 执行动作: 修改延迟为 %1ms").arg(val));
-            client->setGameTickInterval((quint16)val);
+            targetBot->postToShard([client, val]() { client->setGameTickInterval((quint16)val); });
         }
     }
     else {
@@ -1764,8 +1971,12 @@ void BotManager::onBotGameCreateSuccess(Bot *bot, bool isHotRefresh)
     }
 
     // 3. 提取网络指令参数
-    quint16 botListenPort = bot->client->getListenPort();
-    quint32 serverMapCrc = bot->client->getMapCRC();
+    quint16 botListenPort = 0;
+    quint32 serverMapCrc = 0;
+    bot->callInShard([bot, &botListenPort, &serverMapCrc]() {
+        botListenPort = bot->client->getListenPort();
+        serverMapCrc = bot->client->getMapCRC();
+    });
     QString clientId = bot->gameInfo.clientId;
 
     // 4. 打印详细树状日志
@@ -1882,14 +2093,19 @@ void BotManager::onBotRoomHostChanged(Bot *bot, const quint8 heirPid)
         return;
     }
 
-    const auto &players = bot->client->getPlayers();
-    if (!players.contains(heirPid)) return;
+    quint8 botPid = 0;
+    const QVector<PlayerBrief> players = bot->callInShard([bot, &botPid]() {
+        botPid = bot->client->getBotPid();
+        return briefPlayers(bot->client->getPlayers());
+    });
+    auto heir = std::find_if(players.cbegin(), players.cend(), [heirPid](const PlayerBrief &p) { return p.pid == heirPid; });
+    if (heir == players.cend()) return;
 
     QString oldClientId = bot->gameInfo.clientId;
     QString oldHostName = bot->hostname;
 
-    QString newHostName = players[heirPid].name;
-    QString newClientId = players[heirPid].clientId;
+    QString newHostName = heir->name;
+    QString newClientId = heir->clientId;
 
     // 1. 注销全局搜索映射表
     unregisterBotMappings(oldClientId, oldHostName, "");
@@ -1907,9 +2123,9 @@ void BotManager::onBotRoomHostChanged(Bot *bot, const quint8 heirPid)
                  .arg(bot->id).arg(oldHostName, newHostName));
 
     // 4. 通知房间内所有玩家房主变了
-    for (auto it = players.begin(); it != players.end(); ++it) {
-        if (it.key() == bot->client->getBotPid()) continue;
-        m_netManager->sendMessageToClient(it.value().clientId, S_C_MESSAGE, MSG_ROOM_HOST_CHANGE, heirPid);
+    for (const PlayerBrief &player : players) {
+        if (player.pid == botPid) continue;
+        m_netManager->sendMessageToClient(player.clientId, S_C_MESSAGE, MSG_ROOM_HOST_CHANGE, heirPid);
     }
 }
 
@@ -1930,14 +2146,14 @@ void BotManager::onBotVisualHostLeft(Bot *bot)
     QString newClientId = "";
     quint8 newHostPid = 0;
 
-    const QMap<quint8, PlayerData> &players = bot->client->getPlayers();
+    const QVector<PlayerBrief> players = bot->callInShard([bot]() { return briefPlayers(bot->client->getPlayers()); });
 
     // 1. 寻找继承人 (在 Client 侧已经处理过 isVisualHost 标记)
-    for (auto it = players.begin(); it != players.end(); ++it) {
-        if (it.key() != 2 && it.value().isVisualHost) {
-            newClientId = it.value().clientId;
-            newHostName = it.value().name;
-            newHostPid = it.key();
+    for (const PlayerBrief &player : players) {
+        if (player.pid != 2 && player.isVisualHost) {
+            newClientId = player.clientId;
+            newHostName = player.name;
+            newHostPid = player.pid;
             break;
         }
     }
@@ -1990,6 +2206,7 @@ void BotManager::onBotHostJoinedGame(Bot *bot, const QString &hostName)
 void BotManager::onBotPendingTaskTimeout()
 {
     quint64 now = QDateTime::currentMSecsSinceEpoch();
+    pruneCommandCooldowns((qint64)now);
     const quint64 TASK_TIMEOUT_MS = 12000;               // 12秒创建超时
     const quint64 HOST_JOIN_TIMEOUT_MS = 10000;          // 10秒进房超时
 
@@ -2071,13 +2288,13 @@ void BotManager::onBotRoomPingReceived(const QHostAddress &addr, quint16 port, c
     }
 
     // 3. 树状日志记录
-    LOG_INFO(QString("   ├── 👤 来源地址: %1:%2").arg(addr.toString()).arg(port));
-    LOG_INFO(QString("   ├── 🔍 匹配模式: %1").arg(modeTag));
-    LOG_INFO(QString("   ├── 🆔 搜索标识: %1").arg(identifier));
+    LOG_INFO_F("   ├── 👤 来源地址: %1:%2", addr.toString(), port);
+    LOG_INFO_F("   ├── 🔍 匹配模式: %1", modeTag);
+    LOG_INFO_F("   ├── 🆔 搜索标识: %1", identifier);
 
     if (isHit) {
-        LOG_INFO(QString("   ├── 🎯 命中目标: %1").arg(bot->gameInfo.gameName));
-        LOG_INFO(QString("   ├── 📊 房间状态: %1 / %2").arg(current).arg(max));
+        LOG_INFO_F("   ├── 🎯 命中目标: %1", bot->gameInfo.gameName);
+        LOG_INFO_F("   ├── 📊 房间状态: %1 / %2", current, max);
     } else {
         LOG_WARNING("   ├── ⚠️  查找结果: 未找到匹配的活跃 Bot");
     }
@@ -2094,8 +2311,8 @@ void BotManager::onBotRoomPingReceived(const QHostAddress &addr, quint16 port, c
 
         m_netManager->sendRoomPong(addr, port, clientTime, current, max, outHost, outClientId);
 
-        LOG_INFO(QString("   └── ✅ 动作执行: 已回发 Pong (Host:%1 | ClientId:%2)")
-                     .arg(outHost.isEmpty() ? "N/A" : outHost, outClientId.isEmpty() ? "N/A" : outClientId));
+        LOG_INFO_F("   └── ✅ 动作执行: 已回发 Pong (Host:%1 | ClientId:%2)",
+                   outHost.isEmpty() ? QString("N/A") : outHost, outClientId.isEmpty() ? QString("N/A") : outClientId);
     }
 }
 
@@ -2111,6 +2328,21 @@ void BotManager::onBotRejoinRejected(Bot *bot, const QString &clientId, quint32
     }
 }
 
+void BotManager::onBotPlayerMembershipChanged(Bot *bot, const QString &clientId, const QString &playerName, bool joined)
+{
+    const QString lowerName = playerName.toLower();
+
+    // 同一玩家可能同时出现在多个房间: 每个 (键, Bot) 各记一条，离开时只摘掉对应的那一条
+    if (joined) {
+        if (!clientId.isEmpty() && !m_memberClientIdToBot.contains(clientId, bot)) m_memberClientIdToBot.insert(clientId, bot);
+        if (!lowerName.isEmpty() && !m_memberNameToBot.contains(lowerName, bot)) m_memberNameToBot.insert(lowerName, bot);
+        return;
+    }
+
+    if (!clientId.isEmpty()) m_memberClientIdToBot.remove(clientId, bot);
+    if (!lowerName.isEmpty()) m_memberNameToBot.remove(lowerName, bot);
+}
+
 void BotManager::onBotPlayerTransitioned(Bot *bot, const QString &clientId, quint8 pid, const QString &playerName)
 {
     if (!isBotActive(bot, "PlayerTransitioned")) return;
@@ -2119,9 +2351,14 @@ void BotManager::onBotPlayerTransitioned(Bot *bot, const QString &clientId, quin
                  .arg(bot->username, bot->gameInfo.gameName)
                  .arg(pid).arg(playerName));
 
-    if (bot->client->getPlayers().contains(pid)) {
-        QTcpSocket* war3Socket = bot->client->getPlayers()[pid].socket;
-        bot->client->sendHandshakeSequence(pid, war3Socket);
+    bool handshakeSent = bot->callInShard([bot, pid]() {
+        const PlayerTable &players = bot->client->getPlayers();
+        auto it = players.constFind(pid);
+        if (it == players.constEnd()) return false;
+        bot->client->sendHandshakeSequence(pid, it->socket);
+        return true;
+    });
+    if (handshakeSent) {
         LOG_INFO(QString("   ├─ 🎮 已驱动 Client 发送 W3GS 握手序列 (0x04, 0x06, 0x3D, 0x09)"));
     }
 
@@ -2137,11 +2374,14 @@ void BotManager::onBotProtectionTimeout(Bot *bot)
 
     LOG_INFO(QString("📢 [同步] 正在通知所有 Launcher 解除 DLL 拦截保护: [%1]").arg(bot->gameInfo.gameName));
 
-    const QMap<quint8, PlayerData> &players = bot->client->getPlayers();
+    quint8 botPid = 0;
+    const QVector<PlayerBrief> players = bot->callInShard([bot, &botPid]() {
+        botPid = bot->client->getBotPid();
+        return briefPlayers(bot->client->getPlayers());
+    });
 
-    for (auto it = players.begin(); it != players.end(); ++it) {
-        const PlayerData &playerData = it.value();
-        if (playerData.pid == bot->client->getBotPid() || playerData.clientId.isEmpty()) continue;
+    for (const PlayerBrief &playerData : players) {
+        if (playerData.pid == botPid || playerData.clientId.isEmpty()) continue;
         m_netManager->sendMessageToClient(playerData.clientId, S_C_MESSAGE, MSG_STOP_PROTECTION);
     }
 }
@@ -2151,11 +2391,8 @@ void BotManager::onBotRoomPingsUpdated(Bot *bot, const QMap<quint8, quint32> &pi
     if(!isBotActive(bot, "RoomPingsUpdated")) return;
 
     QVariantMap vMap;
-    QString summary;
     for (auto it = pings.constBegin(); it != pings.constEnd(); ++it) {
         vMap.insert(QString::number(it.key()), it.value());
-        if (!summary.isEmpty()) summary += ", ";
-        summary += QString("P%1:%2ms").arg(it.key()).arg(it.value());
     }
 
     QSet<QString> targetClientIds;
@@ -2165,17 +2402,25 @@ void BotManager::onBotRoomPingsUpdated(Bot *bot, const QMap<quint8, quint32> &pi
         targetClientIds.insert(bot->gameInfo.clientId);
     }
 
-    // B. 加入房间内所有已识别的玩家
-    const QMap<quint8, PlayerData> &players = bot->client->getPlayers();
-    for (const auto &player : players) {
-        if (!player.clientId.isEmpty()) {
-            targetClientIds.insert(player.clientId);
+    // B. 加入房间内所有已识别的玩家 (在分片线程直接遍历玩家表)
+    bot->callInShard([bot, &targetClientIds]() {
+        for (const auto &player : bot->client->getPlayers()) {
+            if (!player.clientId.isEmpty()) {
+                targetClientIds.insert(player.clientId);
+            }
         }
-    }
+    });
 
-    LOG_INFO(QString("📡 [延迟同步序列] 房间: %1").arg(bot->gameInfo.gameName));
-    LOG_INFO(QString("   ├── 📊 实时数据: [%1]").arg(summary.isEmpty() ? "空" : summary));
-    LOG_INFO(QString("   ├── 👥 接收目标: %1 个实例").arg(targetClientIds.size()));
+    LOG_INFO_F("📡 [延迟同步序列] 房间: %1", bot->gameInfo.gameName);
+    if (Logger::instance()->shouldLog(Logger::LOG_INFO)) {
+        // 摘要串只在需要输出时拼接
+        QStringList summary;
+        for (auto it = pings.constBegin(); it != pings.constEnd(); ++it) {
+            summary << QString("P%1:%2ms").arg(it.key()).arg(it.value());
+        }
+        LOG_INFO_F("   ├── 📊 实时数据: [%1]", summary.isEmpty() ? QString("空") : summary.join(", "));
+    }
+    LOG_INFO_F("   ├── 👥 接收目标: %1 个实例", targetClientIds.size());
 
     int sentCount = 0;
     int total = targetClientIds.size();
@@ -2184,7 +2429,7 @@ void BotManager::onBotRoomPingsUpdated(Bot *bot, const QMap<quint8, quint32> &pi
     for (const QString &clientId : targetClientIds) {
         i++;
         bool isLast = (i == total);
-        QString branch = isLast ? "   └── " : "   ├── ";
+        const char *branch = isLast ? "   └── " : "   ├── ";
 
         // 发送 TCP 指令
         if (m_netManager) {
@@ -2193,16 +2438,15 @@ void BotManager::onBotRoomPingsUpdated(Bot *bot, const QMap<quint8, quint32> &pi
             if (ok) {
                 sentCount++;
                 bool isRoomOwner = (clientId == bot->gameInfo.clientId);
-                LOG_INFO(QString("%1🚀 下发至 %2 [ClientId: %3]")
-                             .arg(branch, isRoomOwner ? "👑 房主" : "👤 玩家", clientId));
+                LOG_INFO_F("%1🚀 下发至 %2 [ClientId: %3]", branch, isRoomOwner ? "👑 房主" : "👤 玩家", clientId);
             } else {
-                LOG_INFO(QString("%1❌ 失败: 客户端 %2 已断开控制链路").arg(branch, clientId));
+                LOG_INFO_F("%1❌ 失败: 客户端 %2 已断开控制链路", branch, clientId);
             }
         }
     }
 
     if (sentCount > 0) {
-        LOG_INFO(QString("   ✨ 同步完成: 已成功通知 %1 个客户端").arg(sentCount));
+        LOG_INFO_F("   ✨ 同步完成: 已成功通知 %1 个客户端", sentCount);
     }
 }
 
@@ -2218,10 +2462,11 @@ void BotManager::onBotGameStateChanged(Bot *bot, const QString &clientId, GameSt
     } else {
         // 广播给所有人（房主 + 所有成员）
         if (!bot->gameInfo.clientId.isEmpty()) targetsClientId.insert(bot->gameInfo.clientId);
-        const QMap<quint8, PlayerData> &players = bot->client->getPlayers();
-        for (const auto &player : players) {
-            if (!player.clientId.isEmpty()) targetsClientId.insert(player.clientId);
-        }
+        bot->callInShard([bot, &targetsClientId]() {
+            for (const auto &player : bot->client->getPlayers()) {
+                if (!player.clientId.isEmpty()) targetsClientId.insert(player.clientId);
+            }
+        });
     }
 
     // 执行发送
@@ -2239,17 +2484,17 @@ void BotManager::onBotReadyStateChanged(Bot *bot, const QVariantMap &readyData)
 {
     if(!isBotActive(bot, "ReadyStateChanged")) return;
 
-    LOG_INFO(QString("📡 [状态广播序列] 开始处理数据同步 (双索引模式)..."));
-    LOG_INFO(QString("   ├─ 🏠 房间名称: %1").arg(bot->gameInfo.gameName));
-    LOG_INFO(QString("   ├─ 🤖 负责机器人: Bot-%1 (%2)").arg(bot->id).arg(bot->username));
+    LOG_INFO_F("📡 [状态广播序列] 开始处理数据同步 (双索引模式)...");
+    LOG_INFO_F("   ├─ 🏠 房间名称: %1", bot->gameInfo.gameName);
+    LOG_INFO_F("   ├─ 🤖 负责机器人: Bot-%1 (%2)", bot->id, bot->username);
 
     QVariantMap vMap = readyData;
 
-    LOG_INFO("   ├─ 📦 待下发玩家状态列表:");
+    LOG_INFO_F("   ├─ 📦 待下发玩家状态列表:");
 
     if (vMap.isEmpty()) {
         LOG_WARNING("   │  └─ ⚠️ [警告] 状态列表为空！");
-    } else {
+    } else if (Logger::instance()->shouldLog(Logger::LOG_INFO)) {
         int loggedCount = 0;
         int totalPlayers = 0;
 
@@ -2272,44 +2517,43 @@ void BotManager::onBotReadyStateChanged(Bot *bot, const QVariantMap &readyData)
 
             loggedCount++;
             bool isLast = (loggedCount >= totalPlayers);
-            QString prefix = isLast ? "   │  └─ " : "   │  ├─ ";
+            const char *prefix = isLast ? "   │  └─ " : "   │  ├─ ";
 
-            LOG_INFO(QString("%1[%2] PID:%3 -> { 状态: %4, 倒计时: %5s }")
-                         .arg(prefix)
-                         .arg(pName, -15)
-                         .arg(realPid)
-                         .arg(isReady ? "✅ 已就绪" : "⏳ 未准备")
-                         .arg(countdown));
+            LOG_INFO_F("%1[%2] PID:%3 -> { 状态: %4, 倒计时: %5s }",
+                       prefix, pName.leftJustified(15), realPid, isReady ? "✅ 已就绪" : "⏳ 未准备", countdown);
         }
     }
 
     // 2. 收集发送目标
     QSet<QString> targetClientIds;
-    LOG_INFO("   ├─ 🎯 正在构建广播目标列表...");
+    LOG_INFO_F("   ├─ 🎯 正在构建广播目标列表...");
 
     // 房主保底
     if (!bot->gameInfo.clientId.isEmpty()) {
         targetClientIds.insert(bot->gameInfo.clientId);
-        LOG_INFO(QString("   │  ├─ 🏠 房主(Creator) ID 已加入: %1").arg(bot->gameInfo.clientId));
+        LOG_INFO_F("   │  ├─ 🏠 房主(Creator) ID 已加入: %1", bot->gameInfo.clientId);
     } else {
         LOG_WARNING("   │  ├─ ⚠️ [警告] 机器人 gameInfo 中没有房主 ClientId");
     }
 
-    const QMap<quint8, PlayerData> &players = bot->client->getPlayers();
-    for (const auto &player : players) {
-        if (player.pid == bot->client->getBotPid()) continue;
+    quint8 botPid = 0;
+    const QVector<PlayerBrief> players = bot->callInShard([bot, &botPid]() {
+        botPid = bot->client->getBotPid();
+        return briefPlayers(bot->client->getPlayers());
+    });
+    for (const PlayerBrief &player : players) {
+        if (player.pid == botPid) continue;
 
         if (!player.clientId.isEmpty()) {
             targetClientIds.insert(player.clientId);
-            LOG_INFO(QString("   │  ├─ 👤 玩家 %1 (PID:%2) ID 已加入: %3")
-                         .arg(player.name, -15).arg(player.pid).arg(player.clientId));
+            LOG_INFO_F("   │  ├─ 👤 玩家 %1 (PID:%2) ID 已加入: %3", player.name.leftJustified(15), player.pid, player.clientId);
         } else {
             LOG_ERROR(QString("   │  ├─ ❌ [失败] 无法获取玩家 %1 (PID:%2) 的 ClientId，他将无法收到同步！")
                           .arg(player.name).arg(player.pid));
         }
     }
 
-    LOG_INFO(QString("   ├─ 📡 最终广播发送目标: %1 个去重后的终端").arg(targetClientIds.size()));
+    LOG_INFO_F("   ├─ 📡 最终广播发送目标: %1 个去重后的终端", targetClientIds.size());
 
     if (m_netManager && !targetClientIds.isEmpty()) {
         m_netManager->sendRoomReadyStates(targetClientIds, vMap);
@@ -2320,6 +2564,14 @@ void BotManager::onBotError(Bot *bot, QString error)
 {
     if (!isBotActive(bot, "Error")) return;
 
+    // 登录阶段的失败交由调度器退避重试
+    if (m_loginScheduler->isInFlight(bot)) {
+        LOG_WARNING(QString("⚠️ [登录失败] Bot-%1 登录过程中遇到错误: %2").arg(bot->id).arg(error));
+        bot->state = BotState::Disconnected;
+        m_loginScheduler->reportFailure(bot, error);
+        return;
+    }
+
     if (bot->state == BotState::Connecting) {
         LOG_WARNING(QString("⚠️ [连接失败] Bot-%1 拨号过程中遇到错误: %2").arg(bot->id).arg(error));
     } else {
@@ -2352,19 +2604,10 @@ void BotManager::onBotError(Bot *bot, QString error)
         removeGame(bot, true, "Bot Error: " + error);
     }
 
-    if (bot->state == BotState::Disconnected && (!bot->client || !bot->client->isConnected())) {
-
-        int retryDelay = 5000 + (bot->id * 1000);
-
-        LOG_INFO(QString("└── 动作: 计划于 %1ms 后尝试自动重连").arg(retryDelay));
+    if (bot->state == BotState::Disconnected && !bot->isClientConnected()) {
 
-        QTimer::singleShot(retryDelay, this, [this, bot]() {
-            if (m_bots.contains(bot) && bot->state == BotState::Disconnected) {
-                LOG_INFO(QString("🔄 [重连尝试] Bot-%1 (%2) 重新发起连接...").arg(bot->id).arg(bot->username));
-                bot->state = BotState::Connecting;
-                bot->client->connectToHost(m_targetServer, m_targetPort);
-            }
-        });
+        LOG_INFO("└── 动作: 交由登录调度器按退避策略自动重连");
+        m_loginScheduler->reportFailure(bot, error);
     } else {
         LOG_INFO("└── 动作: 流程结束 (Bot 已在线或状态不符合重连条件)");
     }
@@ -2413,17 +2656,21 @@ void BotManager::onBotEnteredChat(Bot *bot)
         bot->state = BotState::Creating;
 
         // 立即下发创建指令
-        bot->client->setHost(bot->gameInfo.hostName);
-        bot->client->setBotDisplayName(m_botDisplayName);
-        bot->client->createGame(
-            bot->gameInfo.gameName,
-            "",
-            Provider_TFT_New,
-            Game_TFT_Custom,
-            SubType_None,
-            Ladder_None,
-            bot->gameInfo.commandSource
-            );
+        GameInfo info = bot->gameInfo;
+        QString displayName = m_botDisplayName;
+        bot->postToShard([bot, info, displayName]() {
+            bot->client->setHost(info.hostName);
+            bot->client->setBotDisplayName(displayName);
+            bot->client->createGame(
+                info.gameName,
+                "",
+                Provider_TFT_New,
+                Game_TFT_Custom,
+                SubType_None,
+                Ladder_None,
+                info.commandSource
+                );
+        });
 
         // 清理任务标记
         bot->pendingTask.hasTask = false;
@@ -2490,7 +2737,7 @@ void BotManager::onBotGameStarted(Bot *bot)
     LOG_INFO(QString("   ├─ 🏠 房间: %1").arg(bot->gameInfo.gameName));
 
     // 获取当前人数
-    LOG_INFO(QString("   └─ 👥 玩家: %1").arg(bot->client->getSlotInfoString()));
+    LOG_INFO(QString("   └─ 👥 玩家: %1").arg(bot->callInShard([bot]() { return bot->client->getSlotInfoString(); })));
 
     emit botStateChanged(bot->id, bot->username, bot->state);
 }
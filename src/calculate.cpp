@@ -4,13 +4,15 @@
 
 quint16 calculateStandardCRC16(const QByteArray &data)
 {
-    quint16 crc = 0xFFFF;
+    return calculateStandardCRC16(data.constData(), data.size());
+}
 
-    // 获取数据长度
-    int len = data.size();
+quint16 calculateStandardCRC16(const char *data, int len)
+{
+    quint16 crc = 0xFFFF;
 
     // 获取无符号指针
-    const unsigned char *p = reinterpret_cast<const unsigned char*>(data.constData());
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(data);
 
     for (int i = 0; i < len; i++) {
         // 取出字节 (再次确保是无符号)
@@ -40,3 +42,10 @@ quint16 calculateCRC32Lower16(const QByteArray &data)
     // 4. 截断取低 16 位
     return static_cast<quint16>(result & 0xFFFF);
 }
+
+quint16 calculateCRC32Lower16(const char *data, int len)
+{
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(len));
+    return static_cast<quint16>(crc & 0xFFFF);
+}
@@ -3,6 +3,9 @@
 #include "bnethash.h"
 #include "bnetsrp3.h"
 #include "calculate.h"
+#include "revisioncache.h"
+#include "packetsigner.h"
+#include "udpbatchsocket.h"
 #include "bncsutil/checkrevision.h"
 
 #include <QDir>
@@ -13,19 +16,29 @@
 #include <QDataStream>
 #include <QRandomGenerator>
 #include <QCoreApplication>
-#include <QNetworkDatagram>
 #include <QNetworkInterface>
-#include <QCryptographicHash>
 #include <QRegularExpression>
 
 #include <zlib.h>
 
+#ifdef Q_OS_UNIX
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <errno.h>
+#endif
+
 const QString COLOR_YELLOW  = "|cffffff00";
 const QString COLOR_GREEN   = "|cff00ff00";
 const QString COLOR_BLUE    = "|cff0000ff";
 const QString COLOR_RED     = "|cffff0000";
 const QString COLOR_END     = "|r";
 
+// 离场后的重入冷却: 房主 1500ms，普通玩家 500ms
+static int rejoinCooldownMs(bool isVisualHost)
+{
+    return isVisualHost ? 1500 : 500;
+}
+
 // =========================================================
 // 1. 生命周期 (构造与析构)
 // =========================================================
@@ -56,8 +69,10 @@ Client::Client(QObject *parent)
     m_rotectionTimeoutTimer->setSingleShot(true);
     m_rotectionTimeoutTimer->setInterval(30000);
 
+    // 心跳定时器: 单次触发 + 按单调时钟的截止时刻重排，避免累积漂移
     m_gameTickTimer = new QTimer(this);
-    m_gameTickTimer->setInterval(m_gameTickInterval);
+    m_gameTickTimer->setSingleShot(true);
+    m_gameTickTimer->setTimerType(Qt::PreciseTimer);
 
     // 2. 信号槽连接
     connect(m_pingTimer, &QTimer::timeout, this, &Client::sendPingLoop);
@@ -73,7 +88,10 @@ Client::Client(QObject *parent)
     connect(m_tcpSocket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError){
         LOG_ERROR(QString("战网连接错误: %1").arg(m_tcpSocket->errorString()));
     });
-    connect(m_udpSocket, &QUdpSocket::readyRead, this, &Client::onUdpReadyRead);
+    m_udpIo = new UdpBatchSocket(m_udpSocket, [this](char *data, int size, const QHostAddress &sender, quint16 senderPort) {
+        // 槽位在下一轮 recvmmsg 时被覆盖，交给上层的必须是自有副本
+        handleW3GSUdpPacket(QByteArray(data, size), sender, senderPort);
+    }, this);
 
     LOG_INFO("   ├─ ⚙️ 环境构建: 定时器/Socket对象已创建，信号已连接");
 
@@ -117,6 +135,7 @@ Client::Client(QObject *parent)
                 // 尝试加载地图
                 if (m_war3Map.load(m_dota683dPath)) {
                     m_mapData = m_war3Map.getMapRawData();
+                    m_mapPartHeaders = m_war3Map.getMapPartHeaders();
                     m_mapSize = (quint32)m_mapData.size();
 
                     LOG_INFO(QString("         └─ ✅ 加载成功: %1 bytes").arg(m_mapSize));
@@ -158,6 +177,8 @@ Client::~Client()
         m_tcpSocket->close();
         delete m_tcpSocket;
     }
+    delete m_udpIo;
+    m_udpIo = nullptr;
     if (m_udpSocket) {
         m_udpSocket->close();
         delete m_udpSocket;
@@ -291,31 +312,11 @@ void Client::sendPacket(BNCSPacketID id, const QByteArray &payload)
 
     m_tcpSocket->write(packet);
 
-    // 1. 获取可读名称
-    QString packetName = getBnetPacketName(id);
-    QString idHex = QString("0x%1").arg((quint8)id, 2, 16, QChar('0')).toUpper();
-
-    // 2. 格式化 Hex
-    QString hexData = packet.toHex().toUpper();
-    QString formattedHex;
-    int maxPreviewBytes = 256;
-
-    int previewLen = qMin(packet.size(), maxPreviewBytes);
-    for (int i = 0; i < previewLen; ++i) {
-        formattedHex += hexData.mid(i * 2, 2) + " ";
-    }
-
-    if (packet.size() > maxPreviewBytes) {
-        formattedHex += "... (Total " + QString::number(packet.size()) + " bytes)";
-    } else {
-        formattedHex = formattedHex.trimmed();
-    }
-
-    // 3. 树状输出
-    LOG_INFO("📤 [BNET 协议发送]");
-    LOG_INFO(QString("   ├─ 🆔 指令: %1 [%2]").arg(packetName, idHex));
-    LOG_INFO(QString("   ├─ 📏 长度: %1 字节 (Payload: %2)").arg(packet.size()).arg(payload.size()));
-    LOG_INFO(QString("   └─ 📦 数据: %1").arg(formattedHex));
+    // 树状输出 (延迟格式化: 级别关闭时不产生任何 Hex/字符串开销)
+    LOG_INFO_F("📤 [BNET 协议发送]");
+    LOG_INFO_F("   ├─ 🆔 指令: %1 [0x%2]", getBnetPacketName(id), QString::number((quint8)id, 16).rightJustified(2, '0').toUpper());
+    LOG_INFO_F("   ├─ 📏 长度: %1 字节 (Payload: %2)", packet.size(), payload.size());
+    LOG_INFO_F("   └─ 📦 数据: %1", LogHex(packet, 256));
 }
 
 void Client::initiateMapDownload(quint8 pid)
@@ -327,6 +328,9 @@ void Client::initiateMapDownload(quint8 pid)
 
     LOG_INFO(QString("🚀 [下载流程] 触发初始化/重置下载 [pID: %1]").arg(pid));
 
+    // 先写出队列中的包，保证与直接写入的控制包顺序一致
+    flushPlayerOutbound(playerData);
+
     // --- 步骤 A: 发送开始信号 (0x3F) ---
     // 告诉客户端：你是下载者，去那个位置准备接收
     socket->write(createW3GSStartDownloadPacket(m_botPid));
@@ -375,6 +379,9 @@ void Client::sendNextMapPart(quint8 toPid, quint8 fromPid)
         return;
     }
 
+    // 分片直接写 socket，先排空队列保证包序
+    flushPlayerOutbound(playerData);
+
     while (playerData.socket->bytesToWrite() < 64 * 1024)
     {
         if (playerData.bytesSentThisSecond >= maxBytesPerSecond) break;
@@ -386,13 +393,34 @@ void Client::sendNextMapPart(quint8 toPid, quint8 fromPid)
 
         if (chunkSize <= 0) break;
 
-        QByteArray chunk = m_mapData.mid(playerData.currentDownloadOffset, chunkSize);
-        QByteArray packet = createW3GSMapPartPacket(toPid, fromPid, playerData.currentDownloadOffset, chunk);
-
-        if (playerData.socket->write(packet) > 0) {
+        // 兜底: 分片缓存缺失或偏移未对齐时走逐块构建
+        if (m_mapPartHeaders.isEmpty() || playerData.currentDownloadOffset % MAX_CHUNK_SIZE != 0) {
+            QByteArray chunk = m_mapData.mid(playerData.currentDownloadOffset, chunkSize);
+            QByteArray packet = createW3GSMapPartPacket(toPid, fromPid, playerData.currentDownloadOffset, chunk);
+            if (playerData.socket->write(packet) <= 0) {
+                playerData.isDownloadStart = false;
+                return;
+            }
             playerData.currentDownloadOffset += chunkSize;
             playerData.bytesSentThisSecond += packet.size();
             playerData.bytesSentInWindow += packet.size();
+            continue;
+        }
+
+        // 取共享的预构建包头并回填 PID，数据直接取自地图映射，避免逐块 mid() 与重算 CRC
+        int partIndex = playerData.currentDownloadOffset / MAX_CHUNK_SIZE;
+        int frameSize = MAP_PART_HEADER_SIZE + chunkSize;
+
+        char header[MAP_PART_HEADER_SIZE];
+        memcpy(header, m_mapPartHeaders.constData() + partIndex * MAP_PART_HEADER_SIZE, MAP_PART_HEADER_SIZE);
+        header[MAP_PART_TOPID_OFFSET] = (char)toPid;
+        header[MAP_PART_FROMPID_OFFSET] = (char)fromPid;
+
+        if (playerData.socket->write(header, MAP_PART_HEADER_SIZE) == MAP_PART_HEADER_SIZE &&
+            playerData.socket->write(m_mapData.constData() + playerData.currentDownloadOffset, chunkSize) > 0) {
+            playerData.currentDownloadOffset += chunkSize;
+            playerData.bytesSentThisSecond += frameSize;
+            playerData.bytesSentInWindow += frameSize;
         } else {
             playerData.isDownloadStart = false;
             return;
@@ -514,11 +542,9 @@ void Client::handleBNETTcpPacket(BNCSPacketID id, const QByteArray &data)
     case SID_CHATCOMMAND: // 0x0E
     {
         LOG_INFO(QString("   └─ [协议追踪] Bot-%1 收到聊天命令消息(0x0E)").arg(m_user));
-        QString cmdText = QString::fromUtf8(data).trimmed();
-        QString hexData = data.toHex(' ').toUpper();
-        LOG_INFO("💬 [BNET] 捕获到聊天/指令包 (SID_CHATCOMMAND - 0x0E)");
-        LOG_INFO(QString("   ├─ 📦 原始 Hex: %1").arg(hexData));
-        LOG_INFO(QString("   ├─ 📝 文本内容: %1").arg(cmdText.isEmpty() ? "<空>" : cmdText));
+        LOG_INFO_F("💬 [BNET] 捕获到聊天/指令包 (SID_CHATCOMMAND - 0x0E)");
+        LOG_INFO_F("   ├─ 📦 原始 Hex: %1", LogHex(data, 0));
+        LOG_INFO_F("   ├─ 📝 文本内容: %1", data.trimmed().isEmpty() ? QString("<空>") : QString::fromUtf8(data).trimmed());
         LOG_INFO("   └─ ℹ️ 状态: 仅记录日志，跳过逻辑处理");
     }
     break;
@@ -832,8 +858,7 @@ void Client::handleW3GSPacket(QTcpSocket *socket, quint8 id, const QByteArray &p
             qint64 now = QDateTime::currentMSecsSinceEpoch();
             qint64 elapsed = now - playerRejoin.leaveTime;
 
-            // 房主限制 1500ms，普通玩家 500ms
-            int cooldownLimit = playerRejoin.isVisualHost ? 1500 : 500;
+            int cooldownLimit = rejoinCooldownMs(playerRejoin.isVisualHost);
 
             if (elapsed < cooldownLimit) {
                 quint32 remaining = static_cast<quint32>(cooldownLimit - elapsed);
@@ -848,17 +873,14 @@ void Client::handleW3GSPacket(QTcpSocket *socket, quint8 id, const QByteArray &p
                 return;
             } else {
                 m_rejoinCooldowns.remove(identifier);
+                m_rejoinWheel.cancel(identifier);
             }
         }
 
         if (m_isLaunching) {
-            quint8 existingPid = 0;
-            for(auto it = m_players.begin(); it != m_players.end(); ++it) {
-                if (it.value().name.compare(clientPlayerName, Qt::CaseInsensitive) == 0 &&
-                    it.value().joinSource == Launcher) {
-                    existingPid = it.key();
-                    break;
-                }
+            quint8 existingPid = getPidByPlayerName(clientPlayerName);
+            if (existingPid != 0 && m_players.value(existingPid).joinSource != Launcher) {
+                existingPid = 0;
             }
 
             if (existingPid != 0) {
@@ -880,7 +902,9 @@ void Client::handleW3GSPacket(QTcpSocket *socket, quint8 id, const QByteArray &p
                 }
 
                 // B. 连接新的物理 Socket
+                m_pidBySocket.remove(playerData.socket);
                 playerData.socket = socket;
+                m_pidBySocket.insert(socket, existingPid);
                 playerData.extIp = socket->peerAddress();
                 playerData.extPort = socket->peerPort();
                 playerData.intIp = QHostAddress(qToBigEndian(clientInternalIP));
@@ -1099,6 +1123,7 @@ void Client::handleW3GSPacket(QTcpSocket *socket, quint8 id, const QByteArray &p
         }
 
         m_players.insert(newPid, playerData);
+        indexPlayer(playerData);
         emit gameStateChanged(currentClientId, GAME_STATE_INROOM);
 
         LOG_INFO(QString("   ├─ 💾 玩家注册: PID %1 (Slot %2)").arg(newPid).arg(slotIndex));
@@ -1166,30 +1191,23 @@ void Client::handleW3GSPacket(QTcpSocket *socket, quint8 id, const QByteArray &p
             return;
         }
 
-        QByteArray crcData = payload.left(4);
-        QDataStream crcStream(crcData);
-        quint32 crcValue;
-
-        crcStream.setByteOrder(QDataStream::LittleEndian);
-        crcStream >> crcValue;
+        quint32 crcValue = qFromLittleEndian<quint32>(payload.constData());
+        const int actionSize = payload.size() - 4;
 
-        QByteArray actionData = payload.mid(4);
-
-        if (!actionData.isEmpty()) {
-            m_actionQueue.append({currentPid, actionData});
+        if (actionSize > 0) {
+            // 直接追加到本周期的 0x0C 缓冲区，不再单独持有一份动作数据
+            appendIncomingAction(currentPid, payload.constData() + 4, actionSize);
             m_players[currentPid].lastResponseTime = QDateTime::currentMSecsSinceEpoch();
 
-            static int logCount = 0;
+            static thread_local int logCount = 0;
             bool shouldLog = (logCount == 0 || logCount % m_actionLogFrequency < m_actionLogShowLines);
 
             if (shouldLog) {
-                QString hexData = actionData.toHex().toUpper();
-                if (hexData.length() > 50) hexData = hexData.left(47) + "...";
-                LOG_INFO(QString("🎮 [游戏动作] 收到玩家指令 (0x26)"));
-                LOG_INFO(QString("   ├─ 👤 来源: %1 (PID: %2)").arg(playerName).arg(currentPid));
-                LOG_INFO(QString("   ├─ 🛡️ CRC32: 0x%1").arg(QString::number(crcValue, 16).toUpper().rightJustified(8, '0')));
-                LOG_INFO(QString("   ├─ 📦 数据: %1 (%2 bytes)").arg(hexData).arg(actionData.size()));
-                LOG_INFO(QString("   └─ 📥 状态: 已加入广播队列 (当前队列深度: %1)").arg(m_actionQueue.size()));
+                LOG_INFO_F("🎮 [游戏动作] 收到玩家指令 (0x26)");
+                LOG_INFO_F("   ├─ 👤 来源: %1 (PID: %2)", playerName, currentPid);
+                LOG_INFO_F("   ├─ 🛡️ CRC32: 0x%1", QString::number(crcValue, 16).toUpper().rightJustified(8, '0'));
+                LOG_INFO_F("   ├─ 📦 数据: %1 (%2 bytes)", LogHex(payload.mid(4), 24, false), actionSize);
+                LOG_INFO_F("   └─ 📥 状态: 已加入广播队列 (当前队列深度: %1)", m_actionCount);
             }
 
             logCount++;
@@ -1550,8 +1568,7 @@ void Client::handleW3GSPacket(QTcpSocket *socket, quint8 id, const QByteArray &p
                 broadcastSlotInfo();
 
                 // 发送完成确认包
-                playerData.socket->write(createW3GSSlotInfoPacket());
-                playerData.socket->flush();
+                queuePacket(playerData, createW3GSSlotInfoPacket());
                 return;
             }
 
@@ -1580,7 +1597,6 @@ void Client::handleW3GSPacket(QTcpSocket *socket, quint8 id, const QByteArray &p
     case W3GS_MAPPARTNOTOK: // [0x45] 客户端报告失败
     {
         quint32 unknownValue = 0;
-        QString rawHex = payload.toHex().toUpper();
 
         if (payload.size() >= 4) {
             QDataStream in(payload);
@@ -1592,7 +1608,7 @@ void Client::handleW3GSPacket(QTcpSocket *socket, quint8 id, const QByteArray &p
         LOG_INFO(QString("   ├─ ❓ [Unknown] Value: %1 (0x%2)")
                      .arg(unknownValue)
                      .arg(unknownValue, 8, 16, QChar('0')).toUpper());
-        LOG_INFO(QString("   ├─ 📦 [Payload] Raw: %1").arg(rawHex));
+        LOG_INFO_F("   ├─ 📦 [Payload] Raw: %1", LogHex(payload, 0, false));
 
         LOG_INFO("   └─ 可能原因: (以下错误会跳转到 Game.dll + 67FBF9) [v1.26.0.6401]");
         LOG_INFO("      ├─ ❶ [Game.dll + 67FA78] 状态异常: 客户端期望偏移量 >= 地图总大小");
@@ -1717,8 +1733,7 @@ void Client::handleChatCommand(quint8 senderPid, const QString &fullMsg)
 
             QByteArray msgBytes = content.toUtf8();
             QByteArray pkt = createW3GSChatFromHostPacket(msgBytes, senderPid, targetPid, ChatFlag::Message);
-            m_players[targetPid].socket->write(pkt);
-            m_players[targetPid].socket->flush();
+            queuePacket(m_players[targetPid], pkt);
         } else {
             LOG_INFO(QString("   └─ ❌ 找不到目标玩家: %1").arg(targetName));
         }
@@ -1731,6 +1746,7 @@ bool Client::disconnectPlayerByPid(quint8 pid)
     if (m_players.contains(pid)) {
         QTcpSocket *socket = m_players[pid].socket;
         if (socket) {
+            flushPlayerOutbound(m_players[pid]);    // 先写出排队中的踢出提示，ClosingState 下不再写
             socket->disconnectFromHost();
             return true;
         }
@@ -1751,6 +1767,7 @@ bool Client::disconnectPlayerByClientId(const QString &clientId)
         if (socket && socket->state() == QAbstractSocket::ConnectedState) {
             LOG_INFO(QString("🔌 [主动断开] 匹配 ClientId: [%1] | 玩家: %2 (PID: %3)")
                          .arg(clientId, m_players[pid].name).arg(pid));
+            flushPlayerOutbound(m_players[pid]);
             socket->disconnectFromHost();
             return true;
         } else {
@@ -1776,6 +1793,7 @@ bool Client::disconnectPlayerByUserName(const QString &userName)
         if (socket && socket->state() == QAbstractSocket::ConnectedState) {
             LOG_INFO(QString("🔌 [主动断开] 匹配 UserName: [%1] (PID: %2)")
                          .arg(userName).arg(pid));
+            flushPlayerOutbound(m_players[pid]);
             socket->disconnectFromHost();
             return true;
         } else {
@@ -1809,16 +1827,12 @@ void Client::onPlayerDisconnected()
     QString clientIdToRemove = "";
     bool wasVisualHost = false;
 
-    auto it = m_players.begin();
-    while (it != m_players.end()) {
-        if (it.value().socket == socket) {
-            pidToRemove = it.key();
-            nameToRemove = it.value().name;
-            clientIdToRemove = it.value().clientId;
-            wasVisualHost = it.value().isVisualHost;
-            break;
-        }
-        ++it;
+    auto it = m_players.constFind(getPidBySocket(socket));
+    if (it != m_players.constEnd()) {
+        pidToRemove = it.key();
+        nameToRemove = it.value().name;
+        clientIdToRemove = it.value().clientId;
+        wasVisualHost = it.value().isVisualHost;
     }
 
     if (pidToRemove == 0) return;
@@ -1834,6 +1848,7 @@ void Client::onPlayerDisconnected()
 
         m_playerSockets.removeAll(socket);
         m_playerBuffers.remove(socket);
+        m_pidBySocket.remove(socket);
         m_players[pidToRemove].socket = nullptr;
 
         socket->deleteLater();
@@ -1851,6 +1866,7 @@ void Client::onPlayerDisconnected()
         pr.leaveTime = QDateTime::currentMSecsSinceEpoch();
         pr.isVisualHost = wasVisualHost;
         m_rejoinCooldowns.insert(identifier, pr);
+        m_rejoinWheel.schedule(identifier, pr.leaveTime + rejoinCooldownMs(wasVisualHost));
 
         LOG_INFO(QString("⏳ [冷却启动] 玩家 %1 离开，已记录重入限制").arg(nameToRemove));
     }
@@ -1880,6 +1896,7 @@ void Client::onPlayerDisconnected()
     }
 
     // --- 5. 执行物理移除 ---
+    unindexPlayer(m_players.value(pidToRemove));
     m_players.remove(pidToRemove);
     m_playerSockets.removeAll(socket);
     m_playerBuffers.remove(socket);
@@ -2026,20 +2043,39 @@ void Client::onGameTick()
         return;
     }
 
-    QByteArray packet = createW3GSIncomingActionPacket(m_gameTickInterval);
+    // 1. 计算实际经过时间与相对计划时刻的延迟
+    const qint64 nowNs = m_tickClock.nsecsElapsed();
+    const qint64 intervalNs = (qint64)m_gameTickInterval * 1000000;
+    m_tickJitter.record((nowNs - m_nextTickDeadlineNs) / 1000);
+
+    // 被阻塞错过的周期合并为一个包: sendInterval 携带真实间隔，客户端游戏时间随之追平
+    m_nextTickDeadlineNs += intervalNs;
+    while (m_nextTickDeadlineNs <= nowNs) {
+        m_nextTickDeadlineNs += intervalNs;
+        m_tickJitter.missedTicks++;
+    }
+
+    // 以整毫秒累计已下发的游戏时间，舍入误差留到下一周期，长局内不随墙钟漂移
+    const qint64 nowMs = nowNs / 1000000;
+    quint16 sendInterval = (quint16)qBound<qint64>(1, nowMs - m_lastTickSentMs, 0xFFFF);
+    m_lastTickSentMs += sendInterval;
+
+    scheduleNextGameTick();
+
+    QByteArray packet = createW3GSIncomingActionPacket(sendInterval);
 
-    static int logCount = 0;
+    static thread_local int logCount = 0;
 
     bool hasAction = (packet.size() > 8);
     bool shouldLog = (logCount == 0 || hasAction || (logCount % m_actionLogFrequency < m_actionLogShowLines));
 
-    if (shouldLog) {
-        LOG_INFO(QString("⏰ [GameTick] 周期 #%1 执行中... (粘合模式)").arg(logCount));
+    // 级别关闭时整块跳过 (逐玩家状态串的拼接同样有开销)
+    if (shouldLog && Logger::instance()->shouldLog(Logger::LOG_INFO)) {
+        LOG_INFO_F("⏰ [GameTick] 周期 #%1 执行中... (粘合模式)", logCount);
 
         // [A] 包内容分析
-        QString hexData = packet.toHex().toUpper();
-        LOG_INFO(QString("   ├─ 📦 总发送数据: %1 bytes").arg(packet.size()));
-        LOG_INFO(QString("   ├─ 🔢 HEX: %1").arg(hexData));
+        LOG_INFO_F("   ├─ 📦 总发送数据: %1 bytes", packet.size());
+        LOG_INFO_F("   ├─ 🔢 HEX: %1", LogHex(packet, 0, false));
 
         if (hasAction)
             LOG_INFO("   ├─ ⚡ 类型: [动作包]");
@@ -2047,7 +2083,7 @@ void Client::onGameTick()
             LOG_INFO("   ├─ 💓 类型: [空心跳]");
 
         // [B] 发送通道检查
-        LOG_INFO(QString("   └─ 📡 广播目标检查 (当前玩家数: %1):").arg(m_players.size() - 1));
+        LOG_INFO_F("   └─ 📡 广播目标检查 (当前玩家数: %1):", m_players.size() - 1);
 
         int validTargets = 0;
         bool canSend = false;
@@ -2074,9 +2110,7 @@ void Client::onGameTick()
                 validTargets++;
             }
 
-            LOG_INFO(QString("      ├─ 🎯 玩家 [%1] %2 -> %3")
-                         .arg(pid)
-                         .arg(playerData.name, statusStr));
+            LOG_INFO_F("      ├─ 🎯 玩家 [%1] %2 -> %3", pid, playerData.name, statusStr);
         }
 
         if (validTargets == 0 || !canSend) {
@@ -2090,6 +2124,14 @@ void Client::onGameTick()
     broadcastPacket(packet, 0);
 }
 
+void Client::scheduleNextGameTick()
+{
+    // 按截止时刻换算剩余等待时间 (向上取整到毫秒)
+    qint64 remainNs = m_nextTickDeadlineNs - m_tickClock.nsecsElapsed();
+    int waitMs = remainNs > 0 ? (int)((remainNs + 999999) / 1000000) : 0;
+    m_gameTickTimer->start(waitMs);
+}
+
 void Client::onStartLagFinished()
 {
     // 树状日志接续
@@ -2111,7 +2153,11 @@ void Client::onStartLagFinished()
     LOG_INFO(QString("   ├─ ✅ 状态: 客户端应已进入画面"));
     LOG_INFO(QString("   └─ 🚀 动作: 正式开启 GameTick 循环 (Interval: %1 ms)").arg(m_gameTickInterval));
 
-    m_gameTickTimer->start();
+    m_tickJitter.reset();
+    m_tickClock.start();
+    m_lastTickSentMs = 0;
+    m_nextTickDeadlineNs = (qint64)m_gameTickInterval * 1000000;
+    scheduleNextGameTick();
     emit gameStateChanged("", GAME_STATE_INGAME);
 }
 
@@ -2130,14 +2176,6 @@ void Client::onProtectionTimeout()
 // 4. UDP 核心处理
 // =========================================================
 
-void Client::onUdpReadyRead()
-{
-    while (m_udpSocket->hasPendingDatagrams()) {
-        QNetworkDatagram datagram = m_udpSocket->receiveDatagram();
-        handleW3GSUdpPacket(datagram.data(), datagram.senderAddress(), datagram.senderPort());
-    }
-}
-
 void Client::handleW3GSUdpPacket(const QByteArray &data, const QHostAddress &sender, quint16 senderPort)
 {
     // 1. 基础长度校验
@@ -2163,19 +2201,11 @@ void Client::handleW3GSUdpPacket(const QByteArray &data, const QHostAddress &sen
     if (header != 0xF7) return;
 
     // 3. 打印根节点信息
-    LOG_INFO(QString("📨 [UDP] 收到数据包: 0x%1").arg(QString::number(msgId, 16).toUpper()));
-    LOG_INFO(QString("   ├─ 🌍 来源: %1:%2 (Len: %3)")
-                 .arg(sender.toString()).arg(senderPort).arg(data.size()));
-
-    // 4. 格式化 Hex 字符串 (每字节加空格)
-    QString hexStr = data.toHex().toUpper();
-    for(int i = 2; i < hexStr.length(); i += 3) hexStr.insert(i, " ");
+    LOG_INFO_F("📨 [UDP] 收到数据包: 0x%1", QString::number(msgId, 16).toUpper());
+    LOG_INFO_F("   ├─ 🌍 来源: %1:%2 (Len: %3)", sender.toString(), senderPort, data.size());
 
-    // 如果包太大，截断显示，防止日志刷屏
-    if (hexStr.length() > 60) {
-        hexStr = hexStr.left(57) + "...";
-    }
-    LOG_INFO(QString("   ├─ 📦 内容: %1").arg(hexStr));
+    // 4. Hex 预览 (截断显示，防止日志刷屏)
+    LOG_INFO_F("   ├─ 📦 内容: %1", LogHex(data, 20));
 
     // 5. 分发处理
     switch (msgId) {
@@ -2189,7 +2219,7 @@ void Client::handleW3GSUdpPacket(const QByteArray &data, const QHostAddress &sen
         LOG_INFO(QString("   ├─ 📝 消息: %1").arg(msg));
 
         // 回显数据
-        m_udpSocket->writeDatagram(data, sender, senderPort);
+        m_udpIo->send(data, sender, senderPort);
 
         LOG_INFO("   └─ 🚀 动作: 已执行 Echo 回显");
     }
@@ -2243,7 +2273,7 @@ void Client::handlePlatformUdpPacket(const QByteArray &data, const QHostAddress
         QByteArray response = createPlatformPacket(PacketType::S_C_ROOM_PONG, &resp, sizeof(resp));
 
         // 原路返回数据包
-        m_udpSocket->writeDatagram(response, sender, senderPort);
+        m_udpIo->send(response, sender, senderPort);
 
         // 4. 打印完成日志
         LOG_INFO(QString("   ├── 📊 房间状态: %1 / %2 (实时同步)").arg(current).arg(max));
@@ -2283,13 +2313,8 @@ QByteArray Client::createPlatformPacket(PacketType type, const void *payload, qu
     // 4. 计算标准 CRC16 校验
     header->checksum = calculateStandardCRC16(buffer);
 
-    // 5. 计算安全签名
-    QByteArray secret = "CC_War3_@#_Platform_2026_SecureKey";
-    QByteArray signSource = buffer + secret;
-    QByteArray fullHash = QCryptographicHash::hash(signSource, QCryptographicHash::Sha256);
-
-    // 取 Hash 的前 16 字节作为签名
-    memcpy(header->signature, fullHash.constData(), 16);
+    // 5. 计算安全签名 (SHA-256(包 || 密钥) 的前 16 字节)
+    PacketSigner::sign(buffer.constData(), buffer.size(), header->signature);
 
     // 6. 打印构建日志
     LOG_DEBUG(QString("📦 [Bot-Packet] 构建完成: Type=0x%1, Size=%2, Seq=%3")
@@ -2405,15 +2430,20 @@ void Client::handleAuthCheck(const QByteArray &data)
     LOG_INFO(QString("   │  ├─ MPQ File:     %1").arg(QString(mpqFileName)));
     LOG_INFO(QString("   │  └─ Formula:      %1").arg(QString(formulaString)));
 
-    // 3. 执行哈希计算
-    unsigned long checkSum = 0;
+    // 3. 执行哈希计算 (同一 formula/MPQ/文件组合进程内只计算一次)
+    quint32 checkSum = 0;
     if (QFile::exists(m_war3ExePath)) {
-        checkRevisionFlat(formulaString.constData(), m_war3ExePath.toUtf8().constData(),
-                          m_stormDllPath.toUtf8().constData(), m_gameDllPath.toUtf8().constData(),
-                          mpqNumber, &checkSum);
+        bool cacheHit = false;
+        if (!CheckRevisionCache::checkRevision(formulaString, m_war3ExePath, m_stormDllPath, m_gameDllPath,
+                                               mpqNumber, &checkSum, &cacheHit)) {
+            LOG_ERROR("   ├─ ❌ [版本校验] checkRevision 计算失败 (请检查 Storm.dll / Game.dll)");
+        }
 
         LOG_INFO("   ├─ 🧮 [版本校验]");
         LOG_INFO(QString("   │  ├─ Core Path: %1").arg(m_war3ExePath));
+        LOG_INFO(QString("   │  ├─ Cache:     %1 (命中 %2 / 未命中 %3)")
+                     .arg(cacheHit ? "HIT" : "MISS")
+                     .arg(CheckRevisionCache::hits()).arg(CheckRevisionCache::misses()));
         LOG_INFO(QString("   │  └─ Checksum:  0x%1").arg(QString::number(checkSum, 16).toUpper()));
     } else {
         LOG_CRITICAL(QString("   └─ ❌ [严重错误] War3.exe 缺失: %1").arg(m_war3ExePath));
@@ -2425,7 +2455,7 @@ void Client::handleAuthCheck(const QByteArray &data)
     QDataStream out(&response, QIODevice::WriteOnly);
     out.setByteOrder(QDataStream::LittleEndian);
     quint32 exeVersion = 0x011a0001;
-    out << m_clientToken << exeVersion << (quint32)checkSum << (quint32)1 << (quint32)0;
+    out << m_clientToken << exeVersion << checkSum << (quint32)1 << (quint32)0;
     out << (quint32)20 << (quint32)18 << (quint32)0 << (quint32)0;
     out.writeRawData(QByteArray(20, 0).data(), 20);
 
@@ -2816,8 +2846,10 @@ void Client::resetGame()
 
     // 3. 清空容器
     m_playerBuffers.clear();
-    m_actionQueue.clear();
-    m_players.clear();
+    m_actionArena.clear();
+    m_actionCount = 0;
+    m_actionArenaSent = false;
+    clearPlayers();
 
     // 4. 槽位状态重置
     initSlots();
@@ -3082,6 +3114,13 @@ void Client::setMapData(const QByteArray &data)
     m_mapData = data; // 浅拷贝
     m_mapSize = (quint32)m_mapData.size();
 
+    // 优先复用 War3Map 共享的预构建包头，数据不一致时才本地构建
+    if (m_war3Map.getMapRawData().constData() == m_mapData.constData()) {
+        m_mapPartHeaders = m_war3Map.getMapPartHeaders();
+    } else {
+        m_mapPartHeaders = War3Map::buildMapPartHeaders(m_mapData);
+    }
+
     // 可选：打印日志
     if (m_mapSize > 0) {
         LOG_INFO(QString("🗺️ [Client] 地图数据初始化完成，大小: %1").arg(m_mapSize));
@@ -3328,49 +3367,57 @@ QByteArray Client::createW3GSCountdownEndPacket()
     return packet;
 }
 
-QByteArray Client::createW3GSIncomingActionPacket(quint16 sendInterval)
+void Client::resetActionArena()
 {
-    // 1. 处理空包 (严格 6 字节)
-    if (m_actionQueue.isEmpty()) {
-        QByteArray packet;
-        QDataStream out(&packet, QIODevice::WriteOnly);
-        out.setByteOrder(QDataStream::LittleEndian);
-        out << (quint8)0xF7 << (quint8)0x0C << (quint16)6 << (quint16)sendInterval;
-        return packet;
+    // 上一周期的包发出后 (发送队列已释放引用) 缓冲区不再共享，此处原地复用不触发拷贝
+    m_actionArena.resize(8);
+    if (m_actionArena.capacity() < ACTION_ARENA_RESERVE) {
+        m_actionArena.reserve(ACTION_ARENA_RESERVE);
     }
+    m_actionCount = 0;
+    m_actionArenaSent = false;
+}
 
-    // 2. 准备 Payload (动作块集合)
-    // 所有的 PID, Length, Data 必须连续写入，且不能发生指针覆盖
-    QByteArray payload;
-    QDataStream ds(&payload, QIODevice::WriteOnly);
-    ds.setByteOrder(QDataStream::LittleEndian);
-
-    // 备份并清空队列
-    auto currentActions = m_actionQueue;
-    m_actionQueue.clear();
-
-    for (const auto &act : currentActions) {
-        ds << (quint8)act.pid;
-        ds << (quint16)act.data.size();
-        // 关键：必须使用流写入数据，确保 ds 的指针向后移动
-        ds.writeRawData(act.data.constData(), act.data.size());
+void Client::appendIncomingAction(quint8 pid, const char *data, int len)
+{
+    if (m_actionArenaSent || m_actionArena.isEmpty()) {
+        resetActionArena();
     }
 
-    // 3. 计算 CRC (范围：仅针对上面生成的全部 Payload)
-    quint16 crcVal = calculateCRC32Lower16(payload);
-
-    // 4. 组装最终发出的 TCP 包
-    QByteArray packet;
-    QDataStream out(&packet, QIODevice::WriteOnly);
-    out.setByteOrder(QDataStream::LittleEndian);
-
-    out << (quint8)0xF7 << (quint8)0x0C;                    // 2 bytes
-    out << (quint16)(8 + payload.size());                   // 2 bytes (Total Length)
-    out << (quint16)sendInterval;                           // 2 bytes
-    out << (quint16)crcVal;                                 // 2 bytes
-    out.writeRawData(payload.constData(), payload.size());  // N bytes (Actions)
+    // 动作块: [PID] [Len(2)] [Data]
+    char blockHeader[3];
+    blockHeader[0] = (char)pid;
+    qToLittleEndian<quint16>((quint16)len, reinterpret_cast<uchar*>(blockHeader + 1));
+    m_actionArena.append(blockHeader, 3);
+    m_actionArena.append(data, len);
+    m_actionCount++;
+}
 
-    return packet;
+QByteArray Client::createW3GSIncomingActionPacket(quint16 sendInterval)
+{
+    // 1. 处理空包 (严格 6 字节)
+    if (m_actionCount == 0 || m_actionArenaSent) {
+        char packet[6];
+        packet[0] = (char)0xF7;
+        packet[1] = (char)0x0C;
+        qToLittleEndian<quint16>(6, reinterpret_cast<uchar*>(packet + 2));
+        qToLittleEndian<quint16>(sendInterval, reinterpret_cast<uchar*>(packet + 4));
+        return QByteArray(packet, 6);
+    }
+
+    // 2. 原地回填包头: F7 0C [Len] [SendInterval] [CRC16]
+    //    动作块已按线格式拼接在 8 字节包头之后，CRC 直接在缓冲区上计算
+    uchar *head = reinterpret_cast<uchar*>(m_actionArena.data());
+    const int payloadSize = m_actionArena.size() - 8;
+    head[0] = 0xF7;
+    head[1] = 0x0C;
+    qToLittleEndian<quint16>((quint16)m_actionArena.size(), head + 2);
+    qToLittleEndian<quint16>(sendInterval, head + 4);
+    qToLittleEndian<quint16>(calculateCRC32Lower16(m_actionArena.constData() + 8, payloadSize), head + 6);
+
+    // 3. 直接交出缓冲区 (隐式共享)，下个周期首次追加时再复位
+    m_actionArenaSent = true;
+    return m_actionArena;
 }
 
 QByteArray Client::createW3GSChatFromHostPacket(const QByteArray &rawBytes, quint8 senderPid, quint8 toPid, ChatFlag flag, quint32 extraData)
@@ -3411,13 +3458,10 @@ QByteArray Client::createW3GSChatFromHostPacket(const QByteArray &rawBytes, quin
     lenStream.skipRawData(2);
     lenStream << totalSize;
 
-    // 格式化 Hex 用于日志
-    QString hexPreview = QString(rawBytes.toHex().toUpper());
-
-    LOG_INFO(QString("📦 [构建包] 聊天/控制 (0x0F)"));
-    LOG_INFO(QString("   ├─ 🎯 目标: %1 -> %2").arg(senderPid).arg(toPid));
-    LOG_INFO(QString("   ├─ 🚩 类型: 0x%1 (Extra: %2)").arg(QString::number((int)flag, 16)).arg(extraData));
-    LOG_INFO(QString("   └─ 📝 数据: %1").arg(hexPreview));
+    LOG_INFO_F("📦 [构建包] 聊天/控制 (0x0F)");
+    LOG_INFO_F("   ├─ 🎯 目标: %1 -> %2", senderPid, toPid);
+    LOG_INFO_F("   ├─ 🚩 类型: 0x%1 (Extra: %2)", QString::number((int)flag, 16), extraData);
+    LOG_INFO_F("   └─ 📝 数据: %1", LogHex(rawBytes, 0, false));
 
     return packet;
 }
@@ -3579,8 +3623,7 @@ void Client::sendChatMessage(quint8 targetPid, const MultiLangMsg& msg)
         ChatFlag::Message
         );
 
-    playerData.socket->write(chatPacket);
-    playerData.socket->flush();
+    queuePacket(playerData, chatPacket);
 }
 
 void Client::sendAccessDeniedMessage(quint8 targetPid, const QString &command)
@@ -3690,8 +3733,7 @@ void Client::broadcastChatMessage(const MultiLangMsg& msg, quint8 excludePid)
             ChatFlag::Message
             );
 
-        socket->write(chatPacket);
-        socket->flush();
+        queuePacket(playerData, chatPacket);
     }
 }
 
@@ -3722,9 +3764,90 @@ void Client::broadcastPacket(const QByteArray &packet, quint8 pid, bool includeO
             continue;
         }
 
-        // 执行发送
-        playerData.socket->write(packet);
-        playerData.socket->flush();
+        // 入队，本轮事件循环结束后统一写出
+        queuePacket(it.value(), packet);
+    }
+}
+
+void Client::queuePacket(PlayerData &playerData, const QByteArray &packet)
+{
+    if (packet.isEmpty()) return;
+    playerData.outboundQueue.append(packet); // 隐式共享，不拷贝数据
+
+    if (!m_outboundFlushScheduled) {
+        m_outboundFlushScheduled = true;
+        QMetaObject::invokeMethod(this, &Client::flushOutbound, Qt::QueuedConnection);
+    }
+}
+
+void Client::flushOutbound()
+{
+    m_outboundFlushScheduled = false;
+    for (auto it = m_players.begin(); it != m_players.end(); ++it) {
+        if (!it.value().outboundQueue.isEmpty()) {
+            flushPlayerOutbound(it.value());
+        }
+    }
+}
+
+void Client::flushPlayerOutbound(PlayerData &playerData)
+{
+    if (playerData.outboundQueue.isEmpty()) return;
+
+    QVector<QByteArray> queue;
+    queue.swap(playerData.outboundQueue);
+
+    QTcpSocket *socket = playerData.socket;
+    if (!socket || socket->state() != QAbstractSocket::ConnectedState) return;
+
+    int index = 0;
+    qint64 skip = 0;
+
+#if defined(Q_OS_UNIX) && defined(MSG_NOSIGNAL)
+    // 1. Qt 写缓冲为空时直接 sendmsg 聚合写出 (一次系统调用)，否则必须排在缓冲之后
+    if (socket->bytesToWrite() == 0 && socket->socketDescriptor() != -1) {
+        const int maxIov = 64;
+        while (index < queue.size()) {
+            struct iovec iov[maxIov];
+            int count = 0;
+            qint64 batchBytes = 0;
+            for (int i = index; i < queue.size() && count < maxIov; ++i, ++count) {
+                iov[count].iov_base = const_cast<char*>(queue[i].constData());
+                iov[count].iov_len = (size_t)queue[i].size();
+                batchBytes += queue[i].size();
+            }
+
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+
+            ssize_t sent = ::sendmsg((int)socket->socketDescriptor(), &msg, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                break; // EAGAIN 等: 剩余部分交给 Qt 缓冲
+            }
+
+            // 定位到第一个未写完的包
+            qint64 remain = sent;
+            while (index < queue.size() && remain >= queue[index].size()) {
+                remain -= queue[index].size();
+                ++index;
+            }
+            skip = remain;
+            if (sent < batchBytes) break;
+        }
+    }
+#endif
+
+    // 2. 剩余部分 (或不支持聚合写时的全部) 交给 Qt 写缓冲，每玩家只 flush 一次
+    if (index < queue.size()) {
+        for (int i = index; i < queue.size(); ++i) {
+            const QByteArray &packet = queue[i];
+            socket->write(packet.constData() + skip, packet.size() - skip);
+            skip = 0;
+        }
+        socket->flush();
     }
 }
 
@@ -3798,6 +3921,9 @@ void Client::sendHandshakeSequence(quint8 targetPid, QTcpSocket *socket)
 {
     if (!socket || socket->state() != QAbstractSocket::ConnectedState) return;
 
+    // 保持与之前已入队数据的先后顺序
+    if (m_players.contains(targetPid)) flushPlayerOutbound(m_players[targetPid]);
+
     QByteArray finalPacket;
     QHostAddress hostIp = socket->peerAddress();
     quint16 hostPort = m_udpSocket->localPort();
@@ -3839,7 +3965,7 @@ void Client::initSlots(quint8 maxPlayers)
 
     m_gameSlots.clear();
     m_gameSlots.resize(maxPlayers);
-    m_players.clear();
+    clearPlayers();
 
     for (auto socket : qAsConst(m_playerSockets)) {
         if (socket->state() == QAbstractSocket::ConnectedState) socket->disconnectFromHost();
@@ -4148,48 +4274,27 @@ quint8 Client::findFreePid() const
 quint8 Client::getPidBySocket(QTcpSocket *socket) const
 {
     if (!socket) return 0;
-
-    for (auto it = m_players.constBegin(); it != m_players.constEnd(); ++it) {
-        if (it.value().socket == socket) {
-            return it.key();
-        }
-    }
-
-    return 0;
+    return m_pidBySocket.value(socket, 0);
 }
 
 quint8 Client::getPidByPlayerName(const QString &PlayerName) const
 {
-    for (auto it = m_players.constBegin(); it != m_players.constEnd(); ++it) {
-        if (it.value().name.compare(PlayerName, Qt::CaseInsensitive) == 0) {
-            return it.key();
-        }
-    }
-    return 0;
+    if (PlayerName.isEmpty()) return 0;
+    return m_pidByName.value(PlayerName.toLower(), 0);
 }
 
 quint8 Client::getPidByClientId(const QString &clientId) const
 {
     if (clientId.isEmpty()) return 0;
-
-    for (auto it = m_players.constBegin(); it != m_players.constEnd(); ++it) {
-        if (it.value().clientId == clientId) {
-            return it.key();
-        }
-    }
-    return 0;
+    return m_pidByClientId.value(clientId, 0);
 }
 
 QString Client::getPlayerNameBySocket(QTcpSocket *socket) const
 {
     if (!socket) return QString();
 
-    for (auto it = m_players.constBegin(); it != m_players.constEnd(); ++it) {
-        if (it.value().socket == socket) {
-            return it.value().name;
-        }
-    }
-    return QString();
+    auto it = m_players.constFind(getPidBySocket(socket));
+    return (it != m_players.constEnd()) ? it.value().name : QString();
 }
 
 QString Client::getPlayerNameByPid(quint8 pid) const
@@ -4208,10 +4313,9 @@ QTextCodec* Client::getCodecBySocket(QTcpSocket *socket) const
 
     if (!socket) return defaultCodec;
 
-    for (auto it = m_players.constBegin(); it != m_players.constEnd(); ++it) {
-        if (it.value().socket == socket) {
-            return it.value().codec ? it.value().codec : defaultCodec;
-        }
+    auto it = m_players.constFind(getPidBySocket(socket));
+    if (it != m_players.constEnd() && it.value().codec) {
+        return it.value().codec;
     }
 
     return defaultCodec;
@@ -4241,7 +4345,7 @@ QString Client::getSlotInfoString() const
     return QString("(%1/%2)").arg(getOccupiedSlots()).arg(getTotalSlots());
 }
 
-const QMap<quint8, PlayerData> &Client::getPlayers() const
+const PlayerTable &Client::getPlayers() const
 {
     return m_players;
 }
@@ -4266,13 +4370,7 @@ bool Client::isHostJoined()
         return false;
     }
 
-    for (auto it = m_players.begin(); it != m_players.end(); ++it) {
-        const QString &existingName = it.value().name;
-        if (existingName.compare(m_host, Qt::CaseInsensitive) == 0) {
-            return true;
-        }
-    }
-    return false;
+    return getPidByPlayerName(m_host) != 0;
 }
 
 void Client::initBotPlayerData()
@@ -4289,10 +4387,74 @@ void Client::initBotPlayerData()
     bot.intIp               = QHostAddress("0.0.0.0");
 
     m_players.insert(bot.pid, bot);
+    indexPlayer(bot);
 
     LOG_INFO(QString("🤖 Host Bot 注册完成 (PID: 2) | 状态: 自动就绪 | 显示名: %1").arg(m_botDisplayName));
 }
 
+void Client::indexPlayer(const PlayerData &playerData)
+{
+    if (playerData.pid == 0) return;
+
+    if (playerData.socket) m_pidBySocket.insert(playerData.socket, playerData.pid);
+    if (!playerData.clientId.isEmpty()) m_pidByClientId.insert(playerData.clientId, playerData.pid);
+
+    // 重名时保留先加入者 (与原先按 PID 顺序查找的结果一致)
+    const QString nameKey = playerData.name.toLower();
+    if (!nameKey.isEmpty() && !m_pidByName.contains(nameKey)) m_pidByName.insert(nameKey, playerData.pid);
+
+    if (playerData.pid != m_botPid) {
+        // 首次到期时按实际状态计算下一次复查时间
+        m_playerTimeoutWheel.schedule(playerData.pid, playerData.lastResponseTime);
+        emit playerMembershipChanged(playerData.clientId, playerData.name, true);
+    }
+}
+
+void Client::unindexPlayer(const PlayerData &playerData)
+{
+    if (playerData.pid == 0) return;
+
+    if (playerData.socket && m_pidBySocket.value(playerData.socket) == playerData.pid) {
+        m_pidBySocket.remove(playerData.socket);
+    }
+    if (!playerData.clientId.isEmpty() && m_pidByClientId.value(playerData.clientId) == playerData.pid) {
+        m_pidByClientId.remove(playerData.clientId);
+    }
+
+    const QString nameKey = playerData.name.toLower();
+    if (!nameKey.isEmpty() && m_pidByName.value(nameKey) == playerData.pid) {
+        m_pidByName.remove(nameKey);
+
+        // 同名的其他玩家顶上 (极少发生，最多 12 人)
+        for (auto it = m_players.constBegin(); it != m_players.constEnd(); ++it) {
+            if (it.key() != playerData.pid && it.value().name.toLower() == nameKey) {
+                m_pidByName.insert(nameKey, it.key());
+                break;
+            }
+        }
+    }
+
+    if (playerData.pid != m_botPid) {
+        m_playerTimeoutWheel.cancel(playerData.pid);
+        emit playerMembershipChanged(playerData.clientId, playerData.name, false);
+    }
+}
+
+void Client::clearPlayers()
+{
+    for (auto it = m_players.constBegin(); it != m_players.constEnd(); ++it) {
+        if (it.key() != m_botPid && it.value().pid != 0) {
+            emit playerMembershipChanged(it.value().clientId, it.value().name, false);
+        }
+    }
+
+    m_players.clear();
+    m_pidBySocket.clear();
+    m_pidByClientId.clear();
+    m_pidByName.clear();
+    m_playerTimeoutWheel.clear();
+}
+
 void Client::checkAllPlayersLoaded()
 {
     if (m_gameTickTimer->isActive() || m_startLagTimer->isActive()) return;
@@ -4335,10 +4497,6 @@ void Client::setGameTickInterval(quint16 interval)
     if (m_gameTickInterval != interval) {
         m_gameTickInterval = interval;
 
-        if (m_gameTickTimer) {
-            m_gameTickTimer->setInterval(m_gameTickInterval);
-        }
-
         LOG_INFO(QString("⚙️ [设置时间] 游戏心跳间隔调整为: %1 ms").arg(m_gameTickInterval));
     }
 }
@@ -4348,6 +4506,11 @@ quint16 Client::getGameTickInterval() const
     return m_gameTickInterval;
 }
 
+TickJitterStats Client::getTickJitterStats() const
+{
+    return m_tickJitter;
+}
+
 // =========================================================
 // 14. 辅助工具函数
 // =========================================================
@@ -4475,6 +4638,11 @@ void Client::sendPingLoop()
     updateCountdowns();
     checkPlayerTimeout();
 
+    // 到期的重入冷却记录出表 (否则 m_rejoinCooldowns 只增不减)
+    m_rejoinWheel.advance(QDateTime::currentMSecsSinceEpoch(), [this](const QString &identifier) {
+        m_rejoinCooldowns.remove(identifier);
+    });
+
     if (!isConnected() || m_players.isEmpty()) {
         return;
     }
@@ -4484,7 +4652,7 @@ void Client::sendPingLoop()
     for (auto it = m_players.begin(); it != m_players.end(); ++it) {
         PlayerData &playerData = it.value();
         if (playerData.socket && playerData.socket->state() == QAbstractSocket::ConnectedState) {
-            playerData.socket->write(pingPacket);
+            queuePacket(playerData, pingPacket);
         }
     }
 }
@@ -4536,6 +4704,7 @@ void Client::updateCountdowns()
             broadcastChatMessage(kickMsg);
 
             if (playerData.socket) {
+                flushPlayerOutbound(playerData);    // 被踢者也要先收到这条广播
                 playerData.socket->disconnectFromHost();
             }
         }
@@ -4754,22 +4923,12 @@ void Client::checkRealConnection()
 }
 
 bool Client::hasPlayerByClientId(const QString &clientId) const {
-    for (const auto &player : m_players) {
-        if (player.clientId == clientId) return true;
-    }
-    return false;
+    return getPidByClientId(clientId) != 0;
 }
 
 bool Client::hasPlayerByUserName(const QString &userName) const
 {
-    if (userName.isEmpty()) return false;
-
-    for (auto it = m_players.constBegin(); it != m_players.constEnd(); ++it) {
-        if (it.value().name.compare(userName, Qt::CaseInsensitive) == 0) {
-            return true;
-        }
-    }
-    return false;
+    return getPidByPlayerName(userName) != 0;
 }
 
 void Client::checkPlayerTimeout()
@@ -4787,20 +4946,27 @@ void Client::checkPlayerTimeout()
     const qint64 GRACE_PERIOD           = 10000;
     const qint64 TIMEOUT_DOWNLOADING    = 60000; // 60秒
     const qint64 TIMEOUT_LOBBY_IDLE     = 10000; // 10秒
+    const qint64 RECHECK_INTERVAL       = m_pingTimer->interval();
 
     QList<quint8> pidsToKick;
 
-    for (auto it = m_players.begin(); it != m_players.end(); ++it) {
-        quint8 pid = it.key();
-        PlayerData &playerData = it.value();
+    // 只处理复查时间已到的玩家; 未触发超时的按当前状态登记下一次复查时间
+    m_playerTimeoutWheel.advance(now, [&](quint8 pid) {
+        if (!m_players.contains(pid)) return;
+        PlayerData &playerData = m_players[pid];
 
-        if (pid == m_botPid || playerData.isVisualHost) continue;
+        // 房主不参与检测，但身份可能移交，稍后再看
+        if (pid == m_botPid || playerData.isVisualHost) {
+            m_playerTimeoutWheel.schedule(pid, now + TIMEOUT_LOBBY_IDLE);
+            return;
+        }
 
         bool kick = false;
         QString reasonCategory = "";
 
         qint64 timeSinceLastResponse = now - playerData.lastResponseTime;
         qint64 timeSinceLastDownload = now - playerData.lastDownloadTime;
+        qint64 nextCheck = 0;
 
         if (playerData.isDownloadStart) {
             if (timeSinceLastDownload > TIMEOUT_DOWNLOADING) {
@@ -4810,34 +4976,43 @@ void Client::checkPlayerTimeout()
 
             qint64 downloadDuration = now - playerData.downloadStartTime;
 
-            // 只有下载超过 10 秒后，才开始检查速度
+            // 只有下载超过 10 秒后，才开始检查速度 (之后每个 Ping 周期复查一次)
             if (downloadDuration > GRACE_PERIOD) {
-                if (playerData.currentSpeedKBps < MIN_DOWNLOAD_SPEED) {
+                if (!kick && playerData.currentSpeedKBps < MIN_DOWNLOAD_SPEED) {
                     LOG_INFO(QString("👢 [速度淘汰] 踢出玩家 %1 (PID: %2) - 速度太慢: %3 KB/s")
-                                 .arg(playerData.name).arg(it.key())
+                                 .arg(playerData.name).arg(pid)
                                  .arg(playerData.currentSpeedKBps, 0, 'f', 1));
-                    pidsToKick.append(it.key());
+                    pidsToKick.append(pid);
                 }
+                nextCheck = now + RECHECK_INTERVAL;
+            } else {
+                nextCheck = playerData.downloadStartTime + GRACE_PERIOD + 1;
             }
+            nextCheck = qMin(nextCheck, playerData.lastDownloadTime + TIMEOUT_DOWNLOADING + 1);
         } else {
             if (timeSinceLastResponse > TIMEOUT_LOBBY_IDLE) {
                 kick = true;
                 reasonCategory = QString("房间无响应 (%1ms)").arg(timeSinceLastResponse);
             }
+            nextCheck = playerData.lastResponseTime + TIMEOUT_LOBBY_IDLE + 1;
         }
 
         if (kick) {
             LOG_INFO(QString("👢 [超时裁判] 标记移除: %1 (PID: %2) - 原因: %3")
                          .arg(playerData.name).arg(pid).arg(reasonCategory));
             pidsToKick.append(pid);
+            nextCheck = now + TIMEOUT_LOBBY_IDLE;   // 断开未能移除玩家时兜底复查
         }
-    }
+
+        m_playerTimeoutWheel.schedule(pid, qMax(nextCheck, now + 1));
+    });
 
     for (quint8 pid : pidsToKick) {
         if (m_players.contains(pid)) {
             PlayerData &playerData = m_players[pid];
             if (playerData.socket && playerData.pid != m_botPid) {
                 LOG_INFO(QString("🔌 [执行踢出] 断开 PID %1 的连接").arg(pid));
+                flushPlayerOutbound(playerData);
                 playerData.socket->disconnectFromHost();
             }
         }
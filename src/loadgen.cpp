@@ -0,0 +1,1082 @@
+#include "loadgen.h"
+#include "calculate.h"
+#include "protocol.h"
+#include "packetsigner.h"
+#include "logger.h"
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QUdpSocket>
+#include <QEventLoop>
+#include <QDateTime>
+#include <QDataStream>
+#include <QtEndian>
+#include <QTimer>
+#include <QTextCodec>
+#include <QFile>
+
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+
+const int LOADGEN_SETUP_TIMEOUT_MS  = 30000;    // 注册 -> 开局的最长等待
+const int LOADGEN_STEP_COOLDOWN_MS  = 3000;     // 阶梯之间留给服务端回收机器人的时间
+const int LOADGEN_DRAIN_MS          = 500;      // 离场报文发出后再析构套接字
+
+// =========================================================
+// 1. 报文构造
+// =========================================================
+
+// BNCS (0xFF) / W3GS (0xF7) 共用的 [引导符][ID][总长度 u16] 帧格式
+QByteArray buildFramedPacket(quint8 lead, quint8 id, const QByteArray &payload)
+{
+    QByteArray packet(4, Qt::Uninitialized);
+    packet[0] = (char)lead;
+    packet[1] = (char)id;
+    qToLittleEndian<quint16>((quint16)(4 + payload.size()), reinterpret_cast<uchar*>(packet.data() + 2));
+    packet.append(payload);
+    return packet;
+}
+
+// 控制协议封包
+// 签名覆盖 checksum / signature 均为 0 的整包，写入签名后再计算 CRC，
+// 与 NetManager::handleIncomingDatagram 的校验顺序一致
+QByteArray buildControlPacket(PacketType type, quint32 sessionId, quint64 seq, const void *payload, int payloadLen)
+{
+    QByteArray buffer(sizeof(PacketHeader) + payloadLen, '\0');
+    PacketHeader *header = reinterpret_cast<PacketHeader*>(buffer.data());
+    header->magic = PROTOCOL_MAGIC;
+    header->version = PROTOCOL_VERSION;
+    header->command = static_cast<quint8>(type);
+    header->sessionId = sessionId;
+    header->seq = seq;
+    header->payloadLen = (quint16)payloadLen;
+    header->checksum = 0;
+
+    if (payloadLen > 0 && payload != nullptr) {
+        memcpy(buffer.data() + sizeof(PacketHeader), payload, payloadLen);
+    }
+
+    PacketSigner::sign(buffer.constData(), buffer.size(), header->signature);
+    header->checksum = calculateStandardCRC16(buffer);
+    return buffer;
+}
+
+template <size_t N>
+void copyField(char (&dst)[N], const QString &value)
+{
+    qstrncpy(dst, value.toUtf8().constData(), N);
+}
+
+double percentile(QVector<double> values, double p)
+{
+    if (values.isEmpty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, (int)std::ceil(p * values.size()) - 1, values.size() - 1);
+    return values[index];
+}
+
+double average(const QVector<double> &values)
+{
+    if (values.isEmpty()) return 0.0;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return sum / values.size();
+}
+
+// 目标进程累计 CPU 时间 (用户态 + 内核态, 毫秒)，不可用时返回 -1
+double readProcessCpuMs(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    if (pid <= 0) return -1.0;
+    QFile file(QString("/proc/%1/stat").arg(pid));
+    if (!file.open(QIODevice::ReadOnly)) return -1.0;
+
+    // comm 字段可能含空格，从最后一个 ')' 之后切分: [0] 为第 3 字段 state，utime / stime 为第 14 / 15 字段
+    const QByteArray stat = file.readAll();
+    const int pos = stat.lastIndexOf(')');
+    if (pos < 0) return -1.0;
+    const QList<QByteArray> fields = stat.mid(pos + 2).split(' ');
+    if (fields.size() < 13) return -1.0;
+
+    const qint64 ticks = fields[11].toLongLong() + fields[12].toLongLong();
+    return ticks * 1000.0 / sysconf(_SC_CLK_TCK);
+#else
+    Q_UNUSED(pid);
+    return -1.0;
+#endif
+}
+
+// =========================================================
+// 2. 模拟玩家: 控制通道 + W3GS 连接
+// =========================================================
+
+class LoadGenRoom;
+
+class LoadGenPlayer
+{
+public:
+    LoadGenPlayer(LoadGenRoom *room, const LoadGenOptions &options, const QString &name, const QString &nonce, bool isHost);
+
+    void start();
+    void sendCommand(const QString &command, const QString &text = QString());
+    void joinGame(const QString &roomName, const QString &hostName, quint16 botPort);
+    void leave();
+
+    const QString &name() const         { return m_name; }
+    bool isHost() const                 { return m_isHost; }
+    bool isControlReady() const         { return m_controlReady; }
+    bool isJoined() const               { return m_joined; }
+    bool isDownloaded() const           { return m_downloaded; }
+    bool isInGame() const               { return m_inGame; }
+
+    double                  joinLatencyMs   = -1.0;
+    double                  downloadMBps    = -1.0;
+    QVector<double>         tickJitterMs;
+    qint64                  ticksReceived   = 0;
+    qint64                  actionsSent     = 0;
+
+private:
+    void sendControl(PacketType type, const void *payload, int payloadLen, bool viaUdp);
+    void sendGame(quint8 id, const QByteArray &payload = QByteArray());
+    void onUdpReadyRead();
+    void onControlReadyRead();
+    void onGameReadyRead();
+    void handleControlPacket(const PacketHeader *header, const char *payload);
+    void handleGamePacket(quint8 id, const QByteArray &payload);
+    void sendAction();
+
+    LoadGenRoom            *m_room;
+    const LoadGenOptions   &m_options;
+    QString                 m_name;
+    QString                 m_clientId;
+    QString                 m_hardwareId;
+    bool                    m_isHost;
+
+    QUdpSocket              m_udp;
+    QTcpSocket              m_control;
+    QTcpSocket              m_game;
+    QTimer                  m_actionTimer;
+    QByteArray              m_controlBuffer;
+    QByteArray              m_gameBuffer;
+    QByteArray              m_actionPayload;
+
+    quint32                 m_sessionId     = 0;
+    quint64                 m_seq           = 0;
+    quint16                 m_botPort       = 0;
+    quint8                  m_pid           = 0;
+    quint32                 m_mapSize       = 0;
+    qint64                  m_lastTickNs    = -1;
+    QElapsedTimer           m_joinTimer;
+    QElapsedTimer           m_downloadTimer;
+    QElapsedTimer           m_tickTimer;
+
+    bool                    m_controlReady  = false;
+    bool                    m_joinRequested = false;
+    bool                    m_joined        = false;
+    bool                    m_downloaded    = false;
+    bool                    m_loadedSent    = false;
+    bool                    m_inGame        = false;
+    bool                    m_left          = false;
+};
+
+// =========================================================
+// 3. 模拟房间: 房主开房 -> 成员加入 -> 下载 -> 准备 -> 开局 -> 采样
+// =========================================================
+
+class LoadGenRoom
+{
+public:
+    LoadGenRoom(const LoadGenOptions &options, const QString &nonce, int stepIndex, int roomIndex, std::function<void()> onDone);
+
+    void start();
+    void collect(LoadGenStepResult &result) const;
+
+    void onControlReady(LoadGenPlayer *player);
+    void onGameCreated(quint16 botPort);
+    void onJoined(LoadGenPlayer *player);
+    void onDownloaded(LoadGenPlayer *player);
+    void onInGame(LoadGenPlayer *player);
+    void onFailed(LoadGenPlayer *player, const QString &reason);
+
+private:
+    void finish(bool started, const QString &reason);
+    LoadGenPlayer *host() const         { return m_players.front().get(); }
+
+    const LoadGenOptions                            &m_options;
+    QString                                         m_roomName;
+    std::vector<std::unique_ptr<LoadGenPlayer>>     m_players;
+    std::function<void()>                           m_onDone;
+    QTimer                                          m_phaseTimer;
+    quint16                                         m_botPort   = 0;
+    bool                                            m_startSent = false;
+    bool                                            m_measuring = false;
+    bool                                            m_started   = false;
+    bool                                            m_done      = false;
+};
+
+LoadGenPlayer::LoadGenPlayer(LoadGenRoom *room, const LoadGenOptions &options, const QString &name, const QString &nonce, bool isHost)
+    : m_room(room)
+    , m_options(options)
+    , m_name(name)
+    , m_isHost(isHost)
+{
+    m_clientId = QString("loadgen-%1-%2").arg(nonce, name);
+    m_hardwareId = QCryptographicHash::hash(m_clientId.toUtf8(), QCryptographicHash::Sha256).toHex().left(32);
+
+    // 动作块内容固定: [CRC u32][动作数据]，服务端只做转发不解析
+    m_actionPayload = QByteArray(4 + qMax(1, options.actionBytes), '\0');
+    for (int i = 4; i < m_actionPayload.size(); ++i) m_actionPayload[i] = (char)(i * 31);
+
+    m_actionTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&m_actionTimer, &QTimer::timeout, &m_actionTimer, [this]() { sendAction(); });
+    QObject::connect(&m_udp, &QUdpSocket::readyRead, &m_udp, [this]() { onUdpReadyRead(); });
+    QObject::connect(&m_control, &QTcpSocket::readyRead, &m_control, [this]() { onControlReadyRead(); });
+    QObject::connect(&m_game, &QTcpSocket::readyRead, &m_game, [this]() { onGameReadyRead(); });
+
+    // 控制通道建立后先发一次心跳: 服务端按首个带 SessionID 的包绑定 TCP 通道，之后的指令按序处理
+    QObject::connect(&m_control, &QTcpSocket::connected, &m_control, [this]() {
+        sendControl(C_S_HEARTBEAT, nullptr, 0, false);
+        m_controlReady = true;
+        m_room->onControlReady(this);
+    });
+
+    QObject::connect(&m_game, &QTcpSocket::connected, &m_game, [this]() {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out << (quint32)0 << (quint32)0 << (quint8)0 << (quint16)6112 << (quint32)0;
+        out.writeRawData(m_name.toUtf8().constData(), m_name.toUtf8().size());
+        out << (quint8)0 << (quint32)0 << (quint16)6112 << (quint32)0;
+
+        m_joinTimer.start();
+        sendGame(0x1E, payload);        // W3GS_REQJOIN
+    });
+
+    QObject::connect(&m_control, &QTcpSocket::errorOccurred, &m_control, [this](QAbstractSocket::SocketError) {
+        if (!m_left) m_room->onFailed(this, "控制通道错误: " + m_control.errorString());
+    });
+    QObject::connect(&m_game, &QTcpSocket::errorOccurred, &m_game, [this](QAbstractSocket::SocketError) {
+        if (!m_left) m_room->onFailed(this, "W3GS 连接错误: " + m_game.errorString());
+    });
+}
+
+void LoadGenPlayer::start()
+{
+    m_udp.bind(QHostAddress::LocalHost, 0);
+
+    CSRegisterPacket reg;
+    memset(&reg, 0, sizeof(reg));
+    copyField(reg.clientId, m_clientId);
+    copyField(reg.hardwareId, m_hardwareId);
+    copyField(reg.username, m_name);
+    copyField(reg.localIp, "127.0.0.1");
+    copyField(reg.publicIp, "127.0.0.1");
+    reg.localPort = m_udp.localPort();
+    reg.publicPort = m_udp.localPort();
+    reg.natType = 0;
+
+    sendControl(C_S_REGISTER, &reg, sizeof(reg), true);
+}
+
+void LoadGenPlayer::sendControl(PacketType type, const void *payload, int payloadLen, bool viaUdp)
+{
+    const QByteArray packet = buildControlPacket(type, m_sessionId, ++m_seq, payload, payloadLen);
+    if (viaUdp) {
+        m_udp.writeDatagram(packet, QHostAddress(m_options.host), m_options.controlPort);
+    } else if (m_control.state() == QAbstractSocket::ConnectedState) {
+        m_control.write(packet);
+    }
+}
+
+void LoadGenPlayer::sendGame(quint8 id, const QByteArray &payload)
+{
+    if (m_game.state() != QAbstractSocket::ConnectedState) return;
+    m_game.write(buildFramedPacket(0xF7, id, payload));
+}
+
+void LoadGenPlayer::sendCommand(const QString &command, const QString &text)
+{
+    CSCommandPacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    copyField(pkt.clientId, m_clientId);
+    copyField(pkt.username, m_name);
+    copyField(pkt.command, command);
+    copyField(pkt.text, text);
+    sendControl(C_S_COMMAND, &pkt, sizeof(pkt), false);
+}
+
+void LoadGenPlayer::joinGame(const QString &roomName, const QString &hostName, quint16 botPort)
+{
+    if (m_joinRequested) return;
+    m_joinRequested = true;
+    m_botPort = botPort;
+
+    // 先申报加入意向，REQJOIN 时服务端才能按玩家名找回 ClientId
+    CSPreJoinRoomPacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.source = 0x02;      // War3Client: 直接从游戏列表进入，开局时视为真实连接
+    copyField(pkt.userName, m_name);
+    copyField(pkt.roomName, roomName);
+    copyField(pkt.hostName, hostName);
+    copyField(pkt.clientId, m_clientId);
+    sendControl(C_S_PREJOINROOM, &pkt, sizeof(pkt), false);
+}
+
+void LoadGenPlayer::leave()
+{
+    if (m_left) return;
+    m_left = true;
+    m_actionTimer.stop();
+
+    if (m_game.state() == QAbstractSocket::ConnectedState) {
+        QByteArray reason(4, '\0');
+        qToLittleEndian<quint32>(0x07, reinterpret_cast<uchar*>(reason.data()));   // PLAYERLEAVE_LOBBY
+        sendGame(0x21, reason);                                                     // W3GS_LEAVEREQ
+        m_game.disconnectFromHost();
+    }
+    if (m_control.state() == QAbstractSocket::ConnectedState) {
+        m_control.disconnectFromHost();
+    }
+    sendControl(C_S_UNREGISTER, nullptr, 0, true);
+}
+
+void LoadGenPlayer::onUdpReadyRead()
+{
+    while (m_udp.hasPendingDatagrams()) {
+        QByteArray data(m_udp.pendingDatagramSize(), Qt::Uninitialized);
+        m_udp.readDatagram(data.data(), data.size());
+        if (data.size() < (int)sizeof(PacketHeader)) continue;
+
+        const PacketHeader *header = reinterpret_cast<const PacketHeader*>(data.constData());
+        if (header->magic != PROTOCOL_MAGIC || header->command != S_C_REGISTER) continue;
+        if (data.size() < (int)(sizeof(PacketHeader) + sizeof(SCRegisterPacket)) || m_sessionId != 0) continue;
+
+        const SCRegisterPacket *resp = reinterpret_cast<const SCRegisterPacket*>(data.constData() + sizeof(PacketHeader));
+        if (resp->status != 2 || resp->sessionId == 0) {
+            m_room->onFailed(this, "注册被拒绝");
+            return;
+        }
+
+        m_sessionId = resp->sessionId;
+        m_control.connectToHost(m_options.host, m_options.controlPort);
+    }
+}
+
+void LoadGenPlayer::onControlReadyRead()
+{
+    m_controlBuffer.append(m_control.readAll());
+
+    while (m_controlBuffer.size() >= (int)sizeof(PacketHeader)) {
+        const PacketHeader *header = reinterpret_cast<const PacketHeader*>(m_controlBuffer.constData());
+        if (header->magic != PROTOCOL_MAGIC) {
+            m_room->onFailed(this, "控制通道魔数错误");
+            return;
+        }
+
+        const int total = sizeof(PacketHeader) + header->payloadLen;
+        if (m_controlBuffer.size() < total) return;
+
+        const QByteArray packet = m_controlBuffer.left(total);
+        m_controlBuffer.remove(0, total);
+        handleControlPacket(reinterpret_cast<const PacketHeader*>(packet.constData()), packet.constData() + sizeof(PacketHeader));
+        if (m_left) return;
+    }
+}
+
+void LoadGenPlayer::handleControlPacket(const PacketHeader *header, const char *payload)
+{
+    switch (header->command) {
+    case S_C_MESSAGE:
+    {
+        if (header->payloadLen < sizeof(SCMessagePacket)) return;
+        const SCMessagePacket *msg = reinterpret_cast<const SCMessagePacket*>(payload);
+        if (m_isHost && msg->code == MSG_HOST_CREATED_GAME) {
+            m_room->onGameCreated((quint16)msg->data);
+        }
+        break;
+    }
+
+    case S_C_ERROR:
+    {
+        if (header->payloadLen < sizeof(SCMessagePacket)) return;
+        const SCMessagePacket *msg = reinterpret_cast<const SCMessagePacket*>(payload);
+        // 开局前的人数/准备不足由服务端广播提示，这里只把开房阶段的错误视为失败
+        if (!m_joined) m_room->onFailed(this, QString("服务端错误码 %1").arg(msg->code));
+        break;
+    }
+
+    case S_C_PREJOINROOM:
+    {
+        if (header->payloadLen < sizeof(SCPreJoinRoomPacket)) return;
+        const SCPreJoinRoomPacket *resp = reinterpret_cast<const SCPreJoinRoomPacket*>(payload);
+        if (resp->status != 1) {
+            m_room->onFailed(this, QString("加入申报被拒绝 (错误码 %1)").arg(resp->errorCode));
+            return;
+        }
+        if (m_game.state() == QAbstractSocket::UnconnectedState) {
+            m_game.connectToHost(m_options.host, m_botPort);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void LoadGenPlayer::onGameReadyRead()
+{
+    m_gameBuffer.append(m_game.readAll());
+
+    while (m_gameBuffer.size() >= 4) {
+        if ((quint8)m_gameBuffer[0] != 0xF7) {
+            m_room->onFailed(this, "W3GS 引导符错误");
+            return;
+        }
+
+        const int length = qFromLittleEndian<quint16>(m_gameBuffer.constData() + 2);
+        if (length < 4) {
+            m_room->onFailed(this, "W3GS 长度字段错误");
+            return;
+        }
+        if (m_gameBuffer.size() < length) return;
+
+        const quint8 id = (quint8)m_gameBuffer[1];
+        const QByteArray payload = m_gameBuffer.mid(4, length - 4);
+        m_gameBuffer.remove(0, length);
+        handleGamePacket(id, payload);
+        if (m_left) return;
+    }
+}
+
+void LoadGenPlayer::handleGamePacket(quint8 id, const QByteArray &payload)
+{
+    switch (id) {
+    case 0x04: // W3GS_SLOTINFOJOIN: [块长 u16][槽位块][PID]...
+    {
+        if (payload.size() < 2) return;
+        const int slotBlockSize = qFromLittleEndian<quint16>(payload.constData());
+        if (payload.size() <= 2 + slotBlockSize) return;
+
+        m_pid = (quint8)payload[2 + slotBlockSize];
+        m_joined = true;
+        joinLatencyMs = m_joinTimer.nsecsElapsed() / 1e6;
+        m_room->onJoined(this);
+        break;
+    }
+
+    case 0x05: // W3GS_REJECTJOIN
+        m_room->onFailed(this, "REQJOIN 被拒绝");
+        break;
+
+    case 0x01: // W3GS_PING_FROM_HOST -> 原样回 0x46
+        sendGame(0x46, payload.left(4));
+        break;
+
+    case 0x3D: // W3GS_MAPCHECK: [u32][路径\0][大小 u32]...
+    {
+        const int pathEnd = payload.indexOf('\0', 4);
+        if (pathEnd < 0 || payload.size() < pathEnd + 5) return;
+        m_mapSize = qFromLittleEndian<quint32>(payload.constData() + pathEnd + 1);
+
+        // 报告本地大小为 0，强制走完整下载以测量吞吐
+        QByteArray report(9, '\0');
+        qToLittleEndian<quint32>(1, reinterpret_cast<uchar*>(report.data()));
+        report[4] = 1;
+        m_downloadTimer.start();
+        sendGame(0x42, report);         // W3GS_MAPSIZE
+        break;
+    }
+
+    case 0x43: // W3GS_MAPPART: [to][from][u32][偏移 u32][CRC u32][数据]
+    {
+        if (payload.size() < 14 || m_downloaded) return;
+        const quint8 fromPid = (quint8)payload[1];
+        const quint32 offset = qFromLittleEndian<quint32>(payload.constData() + 6);
+        const quint32 received = offset + (quint32)(payload.size() - 14);
+
+        QByteArray ack(10, '\0');
+        ack[0] = (char)m_pid;
+        ack[1] = (char)fromPid;
+        qToLittleEndian<quint32>(1, reinterpret_cast<uchar*>(ack.data() + 2));
+        qToLittleEndian<quint32>(received, reinterpret_cast<uchar*>(ack.data() + 6));
+        sendGame(0x44, ack);            // W3GS_MAPPARTOK
+
+        if (m_mapSize > 0 && received >= m_mapSize) {
+            QByteArray report(9, '\0');
+            qToLittleEndian<quint32>(1, reinterpret_cast<uchar*>(report.data()));
+            report[4] = 1;
+            qToLittleEndian<quint32>(m_mapSize, reinterpret_cast<uchar*>(report.data() + 5));
+            sendGame(0x42, report);
+
+            const double seconds = qMax<qint64>(1, m_downloadTimer.nsecsElapsed()) / 1e9;
+            downloadMBps = (m_mapSize / (1024.0 * 1024.0)) / seconds;
+            m_downloaded = true;
+            m_room->onDownloaded(this);
+        }
+        break;
+    }
+
+    case 0x0A: // W3GS_COUNTDOWN_START
+    case 0x0B: // W3GS_COUNTDOWN_END
+        if (!m_loadedSent) {
+            m_loadedSent = true;
+            sendGame(0x23);             // W3GS_GAMELOADED_SELF
+        }
+        break;
+
+    case 0x0C: // W3GS_INCOMING_ACTION: [发送间隔 u16]...
+    {
+        if (payload.size() < 2) return;
+        const quint16 sendInterval = qFromLittleEndian<quint16>(payload.constData());
+
+        if (!m_tickTimer.isValid()) m_tickTimer.start();
+        const qint64 nowNs = m_tickTimer.nsecsElapsed();
+        if (m_lastTickNs >= 0 && m_inGame) {
+            const double deltaMs = (nowNs - m_lastTickNs) / 1e6;
+            tickJitterMs.append(std::fabs(deltaMs - sendInterval));
+            ticksReceived++;
+        }
+        m_lastTickNs = nowNs;
+
+        // 每个节拍回一次 0x27 保活，避免被判定为掉线/卡顿
+        QByteArray keepAlive(5, '\0');
+        sendGame(0x27, keepAlive);      // W3GS_OUTGOING_KEEPALIVE
+
+        if (!m_inGame) {
+            m_inGame = true;
+            m_actionTimer.start(qMax(1, m_options.actionIntervalMs));
+            m_room->onInGame(this);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void LoadGenPlayer::sendAction()
+{
+    sendGame(0x26, m_actionPayload);    // W3GS_OUTGOING_ACTION
+    actionsSent++;
+}
+
+LoadGenRoom::LoadGenRoom(const LoadGenOptions &options, const QString &nonce, int stepIndex, int roomIndex, std::function<void()> onDone)
+    : m_options(options)
+    , m_onDone(std::move(onDone))
+{
+    // 魔兽玩家名最长 15 字节: lg + 3 位随机前缀 + 阶梯 + 房间 + 玩家序号
+    m_roomName = QString("lg%1s%2r%3").arg(nonce).arg(stepIndex).arg(roomIndex);
+    const int players = qMax(1, options.playersPerRoom);
+    for (int i = 0; i < players; ++i) {
+        const QString name = QString("lg%1%2r%3p%4").arg(nonce).arg(stepIndex).arg(roomIndex).arg(i);
+        m_players.emplace_back(new LoadGenPlayer(this, options, name, nonce, i == 0));
+    }
+
+    m_phaseTimer.setSingleShot(true);
+    QObject::connect(&m_phaseTimer, &QTimer::timeout, &m_phaseTimer, [this]() {
+        if (m_measuring) finish(true, QString());
+        else finish(false, m_startSent ? "开局超时" : "准备阶段超时");
+    });
+}
+
+void LoadGenRoom::start()
+{
+    m_phaseTimer.start(LOADGEN_SETUP_TIMEOUT_MS);
+    for (auto &player : m_players) player->start();
+}
+
+void LoadGenRoom::onControlReady(LoadGenPlayer *player)
+{
+    if (player->isHost()) {
+        player->sendCommand("/host", QString("%1 %2").arg(m_options.mode, m_roomName));
+    } else if (host()->isJoined()) {
+        player->joinGame(m_roomName, host()->name(), m_botPort);
+    }
+}
+
+void LoadGenRoom::onGameCreated(quint16 botPort)
+{
+    if (m_botPort != 0) return;
+    m_botPort = botPort;
+    // 房主必须先进场，服务端才会放行其他玩家
+    host()->joinGame(m_roomName, host()->name(), botPort);
+}
+
+void LoadGenRoom::onJoined(LoadGenPlayer *player)
+{
+    if (!player->isHost()) return;
+    for (auto &member : m_players) {
+        if (!member->isHost() && member->isControlReady()) {
+            member->joinGame(m_roomName, host()->name(), m_botPort);
+        }
+    }
+}
+
+void LoadGenRoom::onDownloaded(LoadGenPlayer *)
+{
+    for (const auto &player : m_players) {
+        if (!player->isDownloaded()) return;
+    }
+    if (m_startSent) return;
+    m_startSent = true;
+
+    // 全员下载完成: 各自 /ready，稍后由房主 /start
+    for (auto &player : m_players) player->sendCommand("/ready");
+    QTimer::singleShot(500, &m_phaseTimer, [this]() {
+        if (!m_done) host()->sendCommand("/start");
+    });
+}
+
+void LoadGenRoom::onInGame(LoadGenPlayer *)
+{
+    for (const auto &player : m_players) {
+        if (!player->isInGame()) return;
+    }
+    if (m_measuring) return;
+
+    m_measuring = true;
+    m_phaseTimer.start(qMax(1, m_options.durationMs));
+}
+
+void LoadGenRoom::onFailed(LoadGenPlayer *player, const QString &reason)
+{
+    finish(false, QString("%1: %2").arg(player->name(), reason));
+}
+
+void LoadGenRoom::finish(bool started, const QString &reason)
+{
+    if (m_done) return;
+    m_done = true;
+    m_started = started;
+    m_phaseTimer.stop();
+
+    if (!started) {
+        fprintf(stderr, "   │  ├─ ❌ 房间 %s 失败: %s\n", qPrintable(m_roomName), qPrintable(reason));
+    }
+
+    if (host()->isControlReady()) host()->sendCommand("/unhost");
+    for (auto &player : m_players) player->leave();
+
+    m_onDone();
+}
+
+void LoadGenRoom::collect(LoadGenStepResult &result) const
+{
+    if (m_started) result.roomsStarted++;
+    else result.roomsFailed++;
+
+    for (const auto &player : m_players) {
+        if (player->joinLatencyMs >= 0) result.joinLatencyMs.append(player->joinLatencyMs);
+        else result.joinsFailed++;
+        if (player->downloadMBps >= 0) result.downloadMBps.append(player->downloadMBps);
+        result.tickJitterMs += player->tickJitterMs;
+        result.ticksReceived += player->ticksReceived;
+        result.actionsSent += player->actionsSent;
+    }
+}
+
+// 在事件循环中等待一段时间 (让离场报文与服务端回收有机会完成)
+void waitEvents(int msecs)
+{
+    QEventLoop loop;
+    QTimer::singleShot(msecs, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+}
+
+// =========================================================
+// 4. BNET 桩服务
+// =========================================================
+
+LoadGenStubBnet::LoadGenStubBnet()
+{
+    QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this]() { onNewConnection(); });
+}
+
+LoadGenStubBnet::~LoadGenStubBnet()
+{
+    m_server.close();
+}
+
+bool LoadGenStubBnet::listen(quint16 port)
+{
+    return m_server.listen(QHostAddress::Any, port);
+}
+
+void LoadGenStubBnet::onNewConnection()
+{
+    while (m_server.hasPendingConnections()) {
+        QTcpSocket *socket = m_server.nextPendingConnection();
+        m_sessions.insert(socket, Session());
+
+        QObject::connect(socket, &QTcpSocket::readyRead, &m_server, [this, socket]() { onReadyRead(socket); });
+        QObject::connect(socket, &QTcpSocket::disconnected, &m_server, [this, socket]() {
+            m_sessions.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void LoadGenStubBnet::onReadyRead(QTcpSocket *socket)
+{
+    auto it = m_sessions.find(socket);
+    if (it == m_sessions.end()) return;
+    QByteArray &buffer = it->buffer;
+    buffer.append(socket->readAll());
+
+    while (buffer.size() >= 4) {
+        // 连接首字节为协议选择字节 (0x01)，其余非 0xFF 字节同样跳过
+        if ((quint8)buffer[0] != 0xFF) {
+            buffer.remove(0, 1);
+            continue;
+        }
+
+        const int length = qFromLittleEndian<quint16>(buffer.constData() + 2);
+        if (length < 4) {
+            socket->disconnectFromHost();
+            return;
+        }
+        if (buffer.size() < length) return;
+
+        const quint8 id = (quint8)buffer[1];
+        const QByteArray payload = buffer.mid(4, length - 4);
+        buffer.remove(0, length);
+        handlePacket(socket, id, payload);
+
+        // 回调中可能已断开
+        it = m_sessions.find(socket);
+        if (it == m_sessions.end()) return;
+    }
+}
+
+void LoadGenStubBnet::handlePacket(QTcpSocket *socket, quint8 id, const QByteArray &payload)
+{
+    Session &session = m_sessions[socket];
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    switch (id) {
+    case 0x50: // SID_AUTH_INFO -> 版本校验挑战
+    {
+        static const char formula[] = "A=3845581634 B=880823580 C=1363937103 4 A=A-S B=B-C C=C-A A=A-B";
+        out << (quint32)2 << QRandomGenerator::global()->generate() << (quint32)0 << (quint64)0;
+        out.writeRawData("ver-IX86-1.mpq", 15);
+        out.writeRawData(formula, sizeof(formula));
+        break;
+    }
+
+    case 0x53: // SID_AUTH_ACCOUNTLOGON: [A 32][用户名\0] -> [状态][salt 32][B 32]
+    {
+        const int nameEnd = payload.indexOf('\0', 32);
+        session.username = payload.mid(32, nameEnd < 0 ? -1 : nameEnd - 32);
+        out << (quint32)0;
+        for (int i = 0; i < 64; ++i) out << (quint8)QRandomGenerator::global()->bounded(256);
+        break;
+    }
+
+    case 0x54: // SID_AUTH_ACCOUNTLOGONPROOF -> 直接放行
+        m_logins++;
+        out << (quint32)0;
+        out.writeRawData(QByteArray(20, '\0').constData(), 20);
+        out << (quint8)0;
+        break;
+
+    case 0x52: // SID_AUTH_ACCOUNTCREATE
+        out << (quint32)0;
+        break;
+
+    case 0x0A: // SID_ENTERCHAT: [唯一名\0][统计串\0][账号\0]
+        out.writeRawData(session.username.constData(), session.username.size());
+        out << (quint8)0;
+        out.writeRawData("PX3W", 4);
+        out << (quint8)0;
+        out.writeRawData(session.username.constData(), session.username.size());
+        out << (quint8)0;
+        break;
+
+    case 0x0B: // SID_GETCHANNELLIST
+        out.writeRawData("LoadGen", 7);
+        out << (quint8)0 << (quint8)0;
+        break;
+
+    case 0x0C: // SID_JOINCHANNEL -> SID_CHATEVENT 0x07 (进入频道)
+    {
+        out << (quint32)0x07 << (quint32)0 << (quint32)0 << (quint32)0 << (quint32)0 << (quint32)0;
+        out.writeRawData(session.username.constData(), session.username.size());
+        out << (quint8)0;
+        out.writeRawData("LoadGen", 7);
+        out << (quint8)0;
+        socket->write(buildFramedPacket(0xFF, 0x0F, reply));
+        return;
+    }
+
+    case 0x1C: // SID_STARTADVEX3 -> 创建成功
+        m_games++;
+        out << (quint32)0;
+        break;
+
+    default:
+        // 0x51 版本校验结果、0x02 停止广播、0x45 端口汇报、0x0E 聊天等无需应答
+        return;
+    }
+
+    socket->write(buildFramedPacket(0xFF, id, reply));
+}
+
+// =========================================================
+// 5. 阶梯执行与报告
+// =========================================================
+
+War3BotLoadGen::War3BotLoadGen(const LoadGenOptions &options)
+    : m_options(options)
+{
+    m_nonce = QString::number(QRandomGenerator::global()->bounded(0x1000), 16).rightJustified(3, '0');
+}
+
+War3BotLoadGen::~War3BotLoadGen() = default;
+
+int War3BotLoadGen::runStubBnet(quint16 port)
+{
+    LoadGenStubBnet stub;
+    if (!stub.listen(port)) {
+        fprintf(stderr, "❌ [LoadGen] BNET 桩服务监听失败: 端口 %u\n", port);
+        return 1;
+    }
+    fprintf(stderr, "🧪 [LoadGen] BNET 桩服务已启动: 0.0.0.0:%u (Ctrl+C 退出)\n", stub.port());
+    return QCoreApplication::exec();
+}
+
+LoadGenStepResult War3BotLoadGen::runStep(int stepIndex, int rooms)
+{
+    LoadGenStepResult result;
+    result.rooms = rooms;
+
+    QEventLoop loop;
+    int remaining = rooms;
+    std::vector<std::unique_ptr<LoadGenRoom>> roomList;
+    roomList.reserve(rooms);
+    for (int i = 0; i < rooms; ++i) {
+        roomList.emplace_back(new LoadGenRoom(m_options, m_nonce, stepIndex, i, [&remaining, &loop]() {
+            if (--remaining == 0) loop.quit();
+        }));
+    }
+
+    const double cpuBefore = readProcessCpuMs(m_options.serverPid);
+    QElapsedTimer wall;
+    wall.start();
+
+    for (auto &room : roomList) room->start();
+    if (remaining > 0) loop.exec();
+
+    result.wallMs = wall.elapsed();
+    const double cpuAfter = readProcessCpuMs(m_options.serverPid);
+    if (cpuBefore >= 0 && cpuAfter >= 0) result.cpuMs = cpuAfter - cpuBefore;
+
+    for (const auto &room : roomList) room->collect(result);
+
+    waitEvents(LOADGEN_DRAIN_MS);
+    return result;
+}
+
+int War3BotLoadGen::run(const QString &outputPath, quint16 stubBnetPort)
+{
+    // 负载期间关闭本进程日志，避免污染标准输出的 JSON
+    Logger::instance()->setDisabled(true);
+
+    if (stubBnetPort > 0) {
+        m_stubBnet.reset(new LoadGenStubBnet());
+        if (!m_stubBnet->listen(stubBnetPort)) {
+            fprintf(stderr, "❌ [LoadGen] BNET 桩服务监听失败: 端口 %u\n", stubBnetPort);
+            Logger::instance()->setDisabled(false);
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "🧪 [War3BotLoadGen] 目标 %s:%u | 模式 %s | 每房 %d 人 | 采样 %d ms | 前缀 lg%s\n",
+            qPrintable(m_options.host), m_options.controlPort, qPrintable(m_options.mode),
+            m_options.playersPerRoom, m_options.durationMs, qPrintable(m_nonce));
+
+    for (int i = 0; i < m_options.roomSteps.size(); ++i) {
+        const int rooms = qMax(1, m_options.roomSteps[i]);
+        fprintf(stderr, "   ├─ 📈 阶梯 %d: %d 个房间\n", i, rooms);
+
+        const LoadGenStepResult step = runStep(i, rooms);
+        m_results.append(step);
+
+        fprintf(stderr, "   │  ├─ 开局 %d / 失败 %d | 加入 p50 %.2f ms p99 %.2f ms | 下载均值 %.2f MB/s\n",
+                step.roomsStarted, step.roomsFailed,
+                percentile(step.joinLatencyMs, 0.50), percentile(step.joinLatencyMs, 0.99), average(step.downloadMBps));
+        if (step.cpuMs >= 0) {
+            fprintf(stderr, "   │  └─ 节拍抖动 p50 %.2f ms p99 %.2f ms | CPU %.2f%% / 房间\n",
+                    percentile(step.tickJitterMs, 0.50), percentile(step.tickJitterMs, 0.99),
+                    step.cpuMs * 100.0 / qMax<qint64>(1, step.wallMs) / rooms);
+        } else {
+            fprintf(stderr, "   │  └─ 节拍抖动 p50 %.2f ms p99 %.2f ms | CPU 未统计 (需 --pid)\n",
+                    percentile(step.tickJitterMs, 0.50), percentile(step.tickJitterMs, 0.99));
+        }
+
+        if (i + 1 < m_options.roomSteps.size()) waitEvents(LOADGEN_STEP_COOLDOWN_MS);
+    }
+
+    if (m_stubBnet) {
+        fprintf(stderr, "   ├─ 🤖 BNET 桩服务: 登录 %d 次 / 开房 %d 次\n", m_stubBnet->loginCount(), m_stubBnet->gameCount());
+    }
+    fprintf(stderr, "   └─ ✅ 完成: %d 个阶梯\n", m_results.size());
+
+    Logger::instance()->setDisabled(false);
+
+    const QByteArray json = QJsonDocument(toJson()).toJson(QJsonDocument::Indented);
+    if (outputPath.isEmpty() || outputPath == "-") {
+        fwrite(json.constData(), 1, json.size(), stdout);
+        fflush(stdout);
+        return 0;
+    }
+
+    QFile out(outputPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        fprintf(stderr, "❌ 无法写入结果文件: %s\n", qPrintable(outputPath));
+        return 1;
+    }
+    out.write(json);
+    fprintf(stderr, "📄 结果已写入: %s\n", qPrintable(outputPath));
+    return 0;
+}
+
+QJsonObject War3BotLoadGen::toJson() const
+{
+    auto distribution = [](const QVector<double> &values) {
+        QJsonObject obj;
+        obj["count"] = values.size();
+        obj["mean"] = average(values);
+        obj["p50"] = percentile(values, 0.50);
+        obj["p95"] = percentile(values, 0.95);
+        obj["p99"] = percentile(values, 0.99);
+        obj["max"] = values.isEmpty() ? 0.0 : *std::max_element(values.begin(), values.end());
+        return obj;
+    };
+
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    context["target"] = QString("%1:%2").arg(m_options.host).arg(m_options.controlPort);
+    context["mode"] = m_options.mode;
+    context["players_per_room"] = m_options.playersPerRoom;
+    context["duration_ms"] = m_options.durationMs;
+    context["action_interval_ms"] = m_options.actionIntervalMs;
+    context["action_bytes"] = m_options.actionBytes;
+    context["server_pid"] = (double)m_options.serverPid;
+
+    QJsonArray steps;
+    for (const LoadGenStepResult &step : m_results) {
+        QJsonObject obj;
+        obj["rooms"] = step.rooms;
+        obj["rooms_started"] = step.roomsStarted;
+        obj["rooms_failed"] = step.roomsFailed;
+        obj["joins_failed"] = step.joinsFailed;
+        obj["join_latency_ms"] = distribution(step.joinLatencyMs);
+        obj["download_mb_per_sec"] = distribution(step.downloadMBps);
+        obj["tick_jitter_ms"] = distribution(step.tickJitterMs);
+        obj["ticks_received"] = (double)step.ticksReceived;
+        obj["actions_sent"] = (double)step.actionsSent;
+        obj["wall_ms"] = (double)step.wallMs;
+        if (step.cpuMs >= 0) {
+            obj["server_cpu_ms"] = step.cpuMs;
+            obj["server_cpu_percent_per_room"] = step.cpuMs * 100.0 / qMax<qint64>(1, step.wallMs) / step.rooms;
+        }
+        steps.append(obj);
+    }
+
+    QJsonObject root;
+    root["context"] = context;
+    root["steps"] = steps;
+    return root;
+}
+
+// =========================================================
+// 6. 入口 (独立的 War3BotLoadGen 可执行文件)
+// =========================================================
+
+int main(int argc, char *argv[])
+{
+    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("War3BotLoadGen");
+    QCoreApplication::setApplicationVersion("3.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("War3Bot 本地负载发生器");
+    parser.addHelpOption();
+
+    QCommandLineOption targetOption("target", "目标实例控制地址", "host:port", "127.0.0.1:6116");
+    parser.addOption(targetOption);
+
+    QCommandLineOption roomsOption("rooms", "房间数阶梯 (逗号分隔，如 1,2,4,8)", "list", "1");
+    parser.addOption(roomsOption);
+
+    QCommandLineOption playersOption("players", "每个房间的模拟玩家数 (含房主)", "count", "2");
+    parser.addOption(playersOption);
+
+    QCommandLineOption modeOption("mode", "/host 使用的游戏模式", "mode", "solo");
+    parser.addOption(modeOption);
+
+    QCommandLineOption durationOption("duration", "开局后的采样时长 (毫秒)", "ms", "10000");
+    parser.addOption(durationOption);
+
+    QCommandLineOption actionOption("action-interval", "每个玩家发送 0x26 动作的间隔 (毫秒)", "ms", "100");
+    parser.addOption(actionOption);
+
+    QCommandLineOption pidOption("pid", "War3Bot 实例 PID (用于统计每房间 CPU)", "pid");
+    parser.addOption(pidOption);
+
+    QCommandLineOption outOption({"o", "out"}, "负载结果 JSON 输出文件 (默认: 标准输出)", "file", "-");
+    parser.addOption(outOption);
+
+    QCommandLineOption stubBnetOption("stub-bnet", "同进程启动 BNET 桩服务代替 PvPGN", "port");
+    parser.addOption(stubBnetOption);
+
+    QCommandLineOption stubOnlyOption("stub-only", "只运行 BNET 桩服务并常驻 (先于 War3Bot 实例启动)");
+    parser.addOption(stubOnlyOption);
+
+    parser.process(app);
+
+    const quint16 stubBnetPort = parser.value(stubBnetOption).toUShort();
+    if (parser.isSet(stubOnlyOption)) {
+        return War3BotLoadGen::runStubBnet(stubBnetPort);
+    }
+
+    LoadGenOptions options;
+    const QStringList target = parser.value(targetOption).split(':');
+    options.host = target.value(0, "127.0.0.1");
+    options.controlPort = target.value(1, "6116").toUShort();
+    options.roomSteps.clear();
+    for (const QString &step : parser.value(roomsOption).split(',', Qt::SkipEmptyParts)) {
+        if (step.trimmed().toInt() > 0) options.roomSteps << step.trimmed().toInt();
+    }
+    if (options.roomSteps.isEmpty()) options.roomSteps << 1;
+    options.playersPerRoom = qMax(1, parser.value(playersOption).toInt());
+    options.mode = parser.value(modeOption).toLower();
+    options.durationMs = parser.value(durationOption).toInt();
+    options.actionIntervalMs = parser.value(actionOption).toInt();
+    options.serverPid = parser.value(pidOption).toLongLong();
+
+    War3BotLoadGen loadGen(options);
+    return loadGen.run(parser.value(outOption), stubBnetPort);
+}
@@ -2,6 +2,8 @@
 #include <QDir>
 #include <QDebug>
 #include <QTextCodec>
+#include <cstdio>
+#include <vector>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -23,6 +25,72 @@ const QString WHITE   = "\033[37m";
 const QString BOLD    = "\033[1m";
 }
 
+// =========================================================
+// 有界 MPSC 环形队列 (每槽位序号法, 多生产者 CAS 抢位, 单消费者)
+// =========================================================
+struct LogRing
+{
+    struct Slot {
+        std::atomic<quint64> seq;
+        Logger::LogLevel level;
+        LogDeferred record;     // format 为空时 args[0] 即已格式化的整行
+    };
+
+    explicit LogRing(quint64 capacity)
+        : slots(capacity), mask(capacity - 1)
+    {
+        for (quint64 i = 0; i < capacity; ++i) {
+            slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(Logger::LogLevel level, LogDeferred &record)
+    {
+        quint64 pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &slots[pos & mask];
+            quint64 seq = slot->seq.load(std::memory_order_acquire);
+            qint64 diff = (qint64)seq - (qint64)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // 已满
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->level = level;
+        slot->record = std::move(record);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅允许写线程调用
+    bool tryPop(Logger::LogLevel &level, LogDeferred &record)
+    {
+        Slot *slot = &slots[dequeuePos & mask];
+        if (slot->seq.load(std::memory_order_acquire) != dequeuePos + 1) return false;
+        level = slot->level;
+        record = std::move(slot->record);
+        slot->record = LogDeferred();
+        slot->seq.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        const Slot &slot = slots[dequeuePos & mask];
+        return slot.seq.load(std::memory_order_acquire) != dequeuePos + 1;
+    }
+
+    std::vector<Slot> slots;
+    const quint64 mask;
+    std::atomic<quint64> enqueuePos{0};
+    quint64 dequeuePos = 0;
+};
+
 Logger *Logger::m_instance = nullptr;
 
 Logger *Logger::instance()
@@ -54,6 +122,16 @@ Logger::Logger(QObject *parent)
     , m_maxFileSize(10 * 1024 * 1024)   // 默认10MB
     , m_backupCount(5)                  // 默认5个备份
     , m_disabled(false)
+    , m_ring(nullptr)
+    , m_producers(0)
+    , m_writerThread(nullptr)
+    , m_async(false)
+    , m_stopWriter(false)
+    , m_writerIdle(false)
+    , m_droppedCount(0)
+    , m_blockedCount(0)
+    , m_reportedDropped(0)
+    , m_overflowPolicy(Overflow_Drop)
 {
 #ifdef Q_OS_WIN
     // 1. 设置编码
@@ -76,6 +154,8 @@ Logger::Logger(QObject *parent)
 
 Logger::~Logger()
 {
+    stopAsyncWriter();
+
     if (m_stream) {
         m_stream->flush();
         delete m_stream;
@@ -248,50 +328,35 @@ void Logger::consoleOutput(const QString &message, bool isError)
     if (!m_consoleOutput) return;
 
     QString colorCode = isError ? Color::RED : Color::RESET;
-    QString coloredMessage = colorCode + message + Color::RESET;
-
-    QTextStream stream(isError ? stderr : stdout);
-    stream.setCodec("UTF-8");
-    stream << coloredMessage << "\n";
-    stream.flush();
+    writeConsole(colorCode + message + Color::RESET + "\n", isError);
 }
 
 void Logger::consoleOutput(LogLevel level, const QString &message)
 {
     if (!m_consoleOutput) return;
 
-    QString colorCode;
-    bool toStderr = false;
+    // 拼接颜色代码 + 消息 + 重置代码
+    writeConsole(levelColor(level) + message + Color::RESET + "\n", level >= LOG_ERROR);
+}
 
+QString Logger::levelColor(LogLevel level)
+{
     switch (level) {
-    case LOG_DEBUG:
-        colorCode = Color::CYAN;                    // 青色
-        break;
-    case LOG_INFO:
-        colorCode = Color::GREEN;                   // 绿色
-        break;
-    case LOG_WARNING:
-        colorCode = Color::YELLOW;                  // 黄色
-        break;
-    case LOG_ERROR:
-        colorCode = Color::RED;                     // 红色
-        toStderr = true;
-        break;
-    case LOG_CRITICAL:
-        colorCode = Color::MAGENTA + Color::BOLD;   // 紫红色加粗
-        toStderr = true;
-        break;
-    default:
-        colorCode = Color::RESET;
-        break;
+    case LOG_DEBUG:    return Color::CYAN;                      // 青色
+    case LOG_INFO:     return Color::GREEN;                     // 绿色
+    case LOG_WARNING:  return Color::YELLOW;                    // 黄色
+    case LOG_ERROR:    return Color::RED;                       // 红色
+    case LOG_CRITICAL: return Color::MAGENTA + Color::BOLD;     // 紫红色加粗
+    default:           return Color::RESET;
     }
+}
 
-    // 拼接颜色代码 + 消息 + 重置代码
-    QString coloredMessage = colorCode + message + Color::RESET;
-
+// 控制台输出的唯一出口 (同步日志与异步写线程共用同一编码处理)
+void Logger::writeConsole(const QString &text, bool toStderr)
+{
     QTextStream stream(toStderr ? stderr : stdout);
     stream.setCodec("UTF-8");
-    stream << coloredMessage << "\n";
+    stream << text;
     stream.flush();
 }
 
@@ -320,20 +385,55 @@ void Logger::critical(const QString &message)
     log(LOG_CRITICAL, message);
 }
 
-void Logger::log(LogLevel level, const QString &message, int depth)
-{
-    // 1. 快速过滤
-    if (level < m_logLevel || m_disabled) return;
-
-    QMutexLocker locker(&m_mutex);
+// =========================================================
+// 延迟格式化渲染
+// =========================================================
 
-    // 2. 检查并处理日志轮转
-    rotateLogFileIfNeeded();
+QString LogArg::render() const
+{
+    switch (type) {
+    case Int:    return QString::number(i);
+    case UInt:   return QString::number(u);
+    case Double: return QString::number(d);
+    case Latin:  return QString::fromUtf8(latin);
+    case Str:    return str;
+    case Hex: {
+        // bytes 已在 LogHex 中截断为要显示的前缀
+        QString hex = QString::fromLatin1(bytes.toHex(hexSpaced ? ' ' : '\0').toUpper());
+        if (bytes.size() < hexTotal) {
+            hex += QString(" ... (Total %1 bytes)").arg(hexTotal);
+        }
+        return hex;
+    }
+    }
+    return QString();
+}
 
-    // 如果没有设置日志文件且没有控制台输出，直接返回
-    if (!m_stream && !m_consoleOutput) return;
+QString LogDeferred::render() const
+{
+    if (!format) return args.isEmpty() ? QString() : args[0].render();
+
+    // 按 %1..%9 顺序替换，与 QString::arg 的占位写法保持一致
+    const QString fmt = QString::fromUtf8(format);
+    QString out;
+    out.reserve(fmt.size() + args.size() * 8);
+    for (int i = 0; i < fmt.size(); ++i) {
+        const QChar c = fmt.at(i);
+        if (c == QChar('%') && i + 1 < fmt.size() && fmt.at(i + 1).isDigit()) {
+            const int index = fmt.at(i + 1).digitValue() - 1;
+            if (index >= 0 && index < args.size()) {
+                out += args[index].render();
+                ++i;
+                continue;
+            }
+        }
+        out += c;
+    }
+    return out;
+}
 
-    // 3. 格式化消息内容
+QString Logger::formatMessage(LogLevel level, const QString &message, int depth, qint64 msecs) const
+{
     QString indent = QString(depth * 4, ' ');
     QString treeMessage = (depth > 0 ? "└─ " : "") + message;
 
@@ -347,15 +447,60 @@ void Logger::log(LogLevel level, const QString &message, int depth)
     default:           levelStr = "INFO"; break;
     }
 
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    QString logMessage = QString("[%1] [%2] %3%4").arg(timestamp, levelStr, indent, treeMessage);
+    QDateTime when = msecs > 0 ? QDateTime::fromMSecsSinceEpoch(msecs) : QDateTime::currentDateTime();
+    QString timestamp = when.toString("yyyy-MM-dd hh:mm:ss.zzz");
+    return QString("[%1] [%2] %3%4").arg(timestamp, levelStr, indent, treeMessage);
+}
+
+void Logger::log(LogLevel level, const QString &message, int depth)
+{
+    // 1. 快速过滤
+    if (level < m_logLevel || m_disabled) return;
+
+    // 2. 异步模式: 生产者只格式化 + 入队，不触碰文件与 m_mutex
+    if (m_async.load(std::memory_order_acquire)) {
+        LogDeferred record;
+        record.args.append(LogArg(formatMessage(level, message, depth)));
+        if (enqueueRecord(level, std::move(record))) return;
+        // 写线程正在关闭: 落回同步路径，不丢记录
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    // 3. 检查并处理日志轮转
+    rotateLogFileIfNeeded();
+
+    // 如果没有设置日志文件且没有控制台输出，直接返回
+    if (!m_stream && !m_consoleOutput) return;
+
+    // 4. 格式化并输出
+    writeRecord(level, formatMessage(level, message, depth));
+}
+
+void Logger::submitDeferred(LogLevel level, LogDeferred &&record)
+{
+    if (level < m_logLevel || m_disabled) return;
+
+    // 异步模式: 连格式化都交给写线程
+    if (m_async.load(std::memory_order_acquire)) {
+        if (enqueueRecord(level, std::move(record))) return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    rotateLogFileIfNeeded();
+    if (!m_stream && !m_consoleOutput) return;
+
+    writeRecord(level, formatMessage(level, record.render(), 0, record.msecs));
+}
 
-    // 4. 输出到控制台
+void Logger::writeRecord(LogLevel level, const QString &logMessage)
+{
+    // 输出到控制台
     if (m_consoleOutput) {
         consoleOutput(level, logMessage);
     }
 
-    // 5. 输出到文件
+    // 输出到文件
     if (m_stream && m_logFile && m_logFile->isOpen()) {
         *m_stream << logMessage << "\n";
         m_stream->flush();
@@ -365,3 +510,172 @@ void Logger::log(LogLevel level, const QString &message, int depth)
         }
     }
 }
+
+// =========================================================
+// 异步模式
+// =========================================================
+
+void Logger::setAsyncMode(bool enable, int queueSize, OverflowPolicy policy)
+{
+    // 先停掉旧的写线程 (会排空队列)
+    stopAsyncWriter();
+    if (!enable) return;
+
+    // 容量取 2 的幂，便于掩码定位
+    quint64 capacity = 64;
+    while (capacity < (quint64)qMax(queueSize, 64)) capacity <<= 1;
+
+    m_overflowPolicy = policy;
+    LogRing *ring = new LogRing(capacity);
+    m_stopWriter.store(false, std::memory_order_relaxed);
+    m_writerIdle.store(false, std::memory_order_relaxed);
+
+    m_writerThread = QThread::create([this, ring]() { writerLoop(ring); });
+    m_writerThread->setObjectName("LogWriter");
+    m_writerThread->start(QThread::LowPriority);
+
+    m_ring.store(ring, std::memory_order_seq_cst);
+    m_async.store(true, std::memory_order_release);
+
+    consoleOutput(QString("异步日志已启用 (队列: %1, 溢出策略: %2)")
+                      .arg(capacity).arg(policy == Overflow_Block ? "block" : "drop"));
+}
+
+void Logger::stopAsyncWriter()
+{
+    if (!m_writerThread) return;
+
+    // 1. 关闭入口: 之后进入 enqueueRecord 的生产者拿到空指针，改走同步路径
+    m_async.store(false, std::memory_order_release);
+    LogRing *ring = m_ring.exchange(nullptr, std::memory_order_seq_cst);
+
+    // 2. 等已拿到队列指针的生产者全部入队完毕 (写线程仍在运行，Block 策略下不会卡死)
+    while (m_producers.load(std::memory_order_seq_cst) != 0) {
+        {
+            QMutexLocker locker(&m_wakeMutex);
+            m_wakeCond.wakeAll();
+        }
+        QThread::yieldCurrentThread();
+    }
+
+    // 3. 唤醒写线程，让其排空剩余记录再退出
+    m_stopWriter.store(true, std::memory_order_release);
+    {
+        QMutexLocker locker(&m_wakeMutex);
+        m_wakeCond.wakeAll();
+    }
+    m_writerThread->wait();
+    delete m_writerThread;
+    m_writerThread = nullptr;
+
+    delete ring;
+}
+
+// 返回 false 表示异步写入已关闭 (记录未被取走)，调用方应改走同步路径
+bool Logger::enqueueRecord(LogLevel level, LogDeferred &&record)
+{
+    // 先登记为在途生产者再取指针，与 stopAsyncWriter 的 "先摘指针再等计数" 配对:
+    // 要么这里看到空指针，要么关闭方看到计数非零并等待本次入队结束
+    m_producers.fetch_add(1, std::memory_order_seq_cst);
+    LogRing *ring = m_ring.load(std::memory_order_seq_cst);
+    if (!ring) {
+        m_producers.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    while (!ring->tryPush(level, record)) {
+        if (m_overflowPolicy == Overflow_Drop) {
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            m_producers.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+        // Block: 让出 CPU，等写线程腾出槽位
+        m_blockedCount.fetch_add(1, std::memory_order_relaxed);
+        {
+            QMutexLocker locker(&m_wakeMutex);
+            m_wakeCond.wakeOne();
+        }
+        QThread::yieldCurrentThread();
+    }
+    m_producers.fetch_sub(1, std::memory_order_release);
+
+    // 写线程空闲时才唤醒，避免每条日志一次系统调用
+    if (m_writerIdle.load(std::memory_order_acquire)) {
+        QMutexLocker locker(&m_wakeMutex);
+        m_wakeCond.wakeOne();
+    }
+    return true;
+}
+
+void Logger::writerLoop(LogRing *ring)
+{
+    QVector<QPair<LogLevel, QString>> batch;
+    batch.reserve(256);
+
+    for (;;) {
+        LogLevel level;
+        LogDeferred record;
+        while (batch.size() < 256 && ring->tryPop(level, record)) {
+            // 延迟格式化的记录在这里才真正拼接字符串
+            QString text = record.format ? formatMessage(level, record.render(), 0, record.msecs)
+                                         : record.render();
+            batch.append(qMakePair(level, std::move(text)));
+        }
+
+        if (!batch.isEmpty()) {
+            writeBatch(batch);
+            batch.clear();
+            continue;
+        }
+
+        if (m_stopWriter.load(std::memory_order_acquire)) break;
+
+        // 队列为空: 标记空闲后二次确认，防止丢失唤醒
+        QMutexLocker locker(&m_wakeMutex);
+        m_writerIdle.store(true, std::memory_order_release);
+        if (ring->isEmpty() && !m_stopWriter.load(std::memory_order_acquire)) {
+            m_wakeCond.wait(&m_wakeMutex, 200);
+        }
+        m_writerIdle.store(false, std::memory_order_release);
+    }
+}
+
+void Logger::writeBatch(const QVector<QPair<LogLevel, QString>> &batch)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 1. 轮转检查每批一次
+    rotateLogFileIfNeeded();
+
+    // 2. 汇报溢出丢弃
+    quint64 dropped = m_droppedCount.load(std::memory_order_relaxed);
+    if (dropped != m_reportedDropped) {
+        QString notice = formatMessage(LOG_WARNING, QString("⚠️ 日志队列溢出，已丢弃 %1 条 (累计 %2)")
+                                                        .arg(dropped - m_reportedDropped).arg(dropped), 0);
+        m_reportedDropped = dropped;
+        writeRecord(LOG_WARNING, notice);
+    }
+
+    // 3. 控制台: 每批合并为一次写入
+    if (m_consoleOutput) {
+        QString out;
+        QString err;
+        for (const auto &record : batch) {
+            (record.first >= LOG_ERROR ? err : out) += levelColor(record.first) + record.second + Color::RESET + "\n";
+        }
+        if (!out.isEmpty()) writeConsole(out, false);
+        if (!err.isEmpty()) writeConsole(err, true);
+    }
+
+    // 4. 文件: 每批一次 flush
+    if (m_stream && m_logFile && m_logFile->isOpen()) {
+        for (const auto &record : batch) {
+            *m_stream << record.second << "\n";
+        }
+        m_stream->flush();
+
+        if (m_stream->status() != QTextStream::Ok) {
+            consoleOutput(LOG_CRITICAL, "日志写入失败，磁盘空间可能已满或文件被锁定。");
+        }
+    }
+}
@@ -236,10 +236,11 @@ int main(int argc, char *argv[]) {
         QFile defaultConfig(writePath);
         if (defaultConfig.open(QIODevice::WriteOnly | QIODevice::Text)) {
             QTextStream out(&defaultConfig);
-            out << "[server]\nbroadcast_port=6112\nenable_broadcast=false\npeer_timeout=60000\ncleanup_interval=20000\nbroadcast_interval=10000\n";
-            out << "\n[log]\nlevel=info\nenable_console=true\nlog_file=/var/log/War3Bot/war3bot.log\nmax_size=5000000\nbackup_count=5\n";
-            out << "\n[bnet]\nserver=127.0.0.1\nport=6112\npassword=wxc123\n";
-            out << "\n[bots]\nlist_number=1\ninit_count=10\nauto_generate=false\ndisplay_name=CC.Dota.XXX\n";
+            out << "[server]\nbroadcast_port=6112\nenable_broadcast=false\npeer_timeout=60000\ncleanup_interval=20000\nbroadcast_interval=10000\ntrace_datagrams=false\nudp_workers=1\n";
+            out << "\n[log]\nlevel=info\nenable_console=true\nlog_file=/var/log/War3Bot/war3bot.log\nmax_size=5000000\nbackup_count=5\nasync=false\nqueue_size=8192\noverflow=block\n";
+            out << "\n[maps]\npreload=true\npreload_dirs=\npreload_threads=0\n";
+            out << "\n[bnet]\nserver=127.0.0.1\nport=6112\npassword=wxc123\nrevision_cache_persist=true\n";
+            out << "\n[bots]\nlist_number=1\ninit_count=10\nauto_generate=false\ndisplay_name=CC.Dota.XXX\nworker_threads=-1\nlogin_concurrency=8\nlogin_rate=5\nlogin_burst=5\nlogin_timeout=20000\nlogin_backoff_base=2000\nlogin_backoff_max=60000\n";
             out << "\n[mysql]\nhost=127.0.0.1\nport=3306\nuser=pvpgn\npass=Wxc@2409154\n";
             defaultConfig.close();
             configFile = writePath;
@@ -255,6 +256,9 @@ int main(int argc, char *argv[]) {
     QString logFilePath = configSettings.value("log/log_file", "/var/log/war3bot/war3bot.log").toString();
     qint64 maxLogSize = configSettings.value("log/max_size", 5000000).toLongLong();
     int backupCount = configSettings.value("log/backup_count", 5).toInt();
+    bool asyncLog = configSettings.value("log/async", false).toBool();
+    int asyncQueueSize = configSettings.value("log/queue_size", 8192).toInt();
+    QString overflowPolicy = configSettings.value("log/overflow", "block").toString();
 
     QFileInfo logFileInfo(logFilePath);
     if (!logFileInfo.dir().exists()) logFileInfo.dir().mkpath(".");
@@ -268,6 +272,7 @@ int main(int argc, char *argv[]) {
     Logger::instance()->enableConsoleOutput(enableConsole);
     Logger::instance()->setBackupCount(backupCount);
     Logger::instance()->setLogFile(logFilePath);
+    Logger::instance()->setAsyncMode(asyncLog, asyncQueueSize, Logger::overflowPolicyFromString(overflowPolicy));
 
     if (parser.isSet(logLevelOption)) {
         Logger::instance()->setLogLevel(Logger::logLevelFromString(parser.value(logLevelOption).toLower()));
@@ -403,7 +408,7 @@ int main(int argc, char *argv[]) {
                     // 不区分大小写比较
                     if (bot->username.compare(user, Qt::CaseInsensitive) == 0) {
                         found = true;
-                        if (bot->client->isConnected()) {
+                        if (bot->isClientConnected()) {
                             LOG_WARNING(QString("⚠️ 机器人 %1 已经在线 (状态: %2)，请先执行 stop 断开").arg(user).arg((int)bot->state));
                             break;
                         }
@@ -418,8 +423,12 @@ int main(int argc, char *argv[]) {
                         QString targetServer = server.isEmpty() ? "127.0.0.1" : server;
                         ushort targetPort = (port == 0) ? 6112 : port;
 
-                        bot->client->setCredentials(bot->username, bot->password, Protocol_SRP_0x53);
-                        bot->client->connectToHost(targetServer, targetPort);
+                        QString botUser = bot->username;
+                        QString botPass = bot->password;
+                        bot->postToShard([bot, botUser, botPass, targetServer, targetPort]() {
+                            bot->client->setCredentials(botUser, botPass, Protocol_SRP_0x53);
+                            bot->client->connectToHost(targetServer, targetPort);
+                        });
                         break;
                     }
                 }
@@ -493,7 +502,7 @@ int main(int argc, char *argv[]) {
                 LOG_INFO("🛑 正在停止 [所有] 机器人的广播...");
                 for (auto *bot : bots) {
                     if (bot && bot->client) {
-                        bot->client->cancelGame();
+                        bot->postToShard([bot]() { bot->client->cancelGame(); });
                         count++;
                     }
                 }
@@ -501,9 +510,9 @@ int main(int argc, char *argv[]) {
             } else {
                 bool found = false;
                 for (auto *bot : bots) {
-                    if (bot && bot->client && bot->client->isConnected()) {
+                    if (bot && bot->isClientConnected()) {
                         if (bot->username.compare(targetUser, Qt::CaseInsensitive) == 0) {
-                            bot->client->cancelGame();
+                            bot->postToShard([bot]() { bot->client->cancelGame(); });
                             LOG_INFO(QString("✅ 已停止 Bot-%1 (%2) 的广播").arg(bot->id).arg(bot->username));
                             found = true;
                             break;
@@ -513,8 +522,71 @@ int main(int argc, char *argv[]) {
                 if (!found) LOG_WARNING(QString("未找到指定的在线机器人: %1").arg(targetUser));
             }
         }
+        // ---------------------------------------------------------
+        // 命令: maps [cancel|bench] (地图缓存内存报告 / 取消预加载 / 哈希基准)
+        // ---------------------------------------------------------
+        else if (action == "maps") {
+            MapPreloader *preloader = war3bot.getMapPreloader();
+            QString sub = (parts.size() > 1) ? parts[1].toLower() : "";
+
+            // maps cancel: 取消后台预加载
+            if (sub == "cancel") {
+                if (preloader && preloader->isRunning()) {
+                    preloader->cancel();
+                } else {
+                    LOG_INFO("🗺️ [地图预加载] 当前没有进行中的预加载任务");
+                }
+                return;
+            }
+
+            // maps bench [轮数]: 在已缓存地图上对比暴雪哈希新旧实现
+            if (sub == "bench") {
+                int rounds = (parts.size() > 2) ? qBound(1, parts[2].toInt(), 100) : 5;
+                const QStringList lines = War3Map::benchmarkBlizzardHash(rounds);
+                LOG_INFO("🧮 [暴雪哈希] 基准测试");
+                for (int idx = 0; idx < lines.size(); ++idx) {
+                    LOG_INFO(QString("   %1 %2").arg(idx == lines.size() - 1 ? "└─" : "├─", lines[idx]));
+                }
+                return;
+            }
+
+            if (preloader && preloader->isRunning()) {
+                LOG_INFO(QString("🗺️ [地图预加载] 进行中: %1/%2 (输入 maps cancel 取消)")
+                             .arg(preloader->finishedCount()).arg(preloader->totalCount()));
+            }
+
+            const QStringList report = War3Map::memoryReport();
+            LOG_INFO("🗺️ [地图缓存] 内存报告");
+            for (int idx = 0; idx < report.size(); ++idx) {
+                LOG_INFO(QString("   %1 %2").arg(idx == report.size() - 1 ? "└─" : "├─", report[idx]));
+            }
+        }
+        // ---------------------------------------------------------
+        // 命令: ticks (各房间游戏心跳抖动统计)
+        // ---------------------------------------------------------
+        else if (action == "ticks") {
+            const auto &bots = botManager->getAllBots();
+            int count = 0;
+            LOG_INFO("⏱️ [心跳抖动] 游戏中房间统计 (延迟 = 实际触发 - 计划时刻)");
+            for (auto *bot : bots) {
+                if (!bot || !bot->client || bot->state != BotState::InGame) continue;
+
+                TickJitterStats stats = bot->callInShard([bot]() { return bot->client->getTickJitterStats(); });
+                if (stats.samples == 0) continue;
+
+                count++;
+                LOG_INFO(QString("   ├─ Bot-%1 [%2] | 样本: %3 | p50: %4 ms | p99: %5 ms | max: %6 ms | 合并: %7")
+                             .arg(bot->id).arg(bot->gameInfo.gameName)
+                             .arg(stats.samples)
+                             .arg(stats.percentileUs(0.50) / 1000.0, 0, 'f', 1)
+                             .arg(stats.percentileUs(0.99) / 1000.0, 0, 'f', 1)
+                             .arg(stats.maxLateUs / 1000.0, 0, 'f', 1)
+                             .arg(stats.missedTicks));
+            }
+            LOG_INFO(QString("   └─ 共 %1 个游戏中房间").arg(count));
+        }
         else {
-            LOG_INFO("未知命令。可用命令: connect, create, cancel, stop");
+            LOG_INFO("未知命令。可用命令: connect, create, cancel, stop, maps, ticks");
         }
     };
 
@@ -609,7 +681,7 @@ int main(int argc, char *argv[]) {
             const auto &bots = botManager->getAllBots();
             total = bots.size();
             for(auto *bot : bots) {
-                if (bot && bot->client &&bot->client->isConnected()) {
+                if (bot && bot->isClientConnected()) {
                     online++;
                     // 细分状态统计
                     switch (bot->state) {
@@ -684,6 +756,14 @@ int main(int argc, char *argv[]) {
                      .arg(finishing)        // %10
                      .arg(playerOnline)     // %11
                      .arg(playerDetails));  // %12
+
+        // 5. 异步日志溢出指标
+        if (Logger::instance()->isAsyncMode() &&
+            (Logger::instance()->droppedCount() > 0 || Logger::instance()->blockedCount() > 0)) {
+            LOG_INFO(QString("   └─ 📝 [日志队列] 丢弃: %1 | 阻塞等待: %2")
+                         .arg(Logger::instance()->droppedCount())
+                         .arg(Logger::instance()->blockedCount()));
+        }
     });
 
     // 设置间隔为 30 秒 (30000 毫秒)
@@ -0,0 +1,163 @@
+#include "mappreloader.h"
+#include "war3map.h"
+#include "logger.h"
+#include <QRegularExpression>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QRunnable>
+#include <QFileInfo>
+#include <QThread>
+#include <QSet>
+#include <QDir>
+#include <functional>
+
+namespace {
+
+// 单张地图的预加载任务
+class MapPreloadTask : public QRunnable
+{
+public:
+    MapPreloadTask(std::function<void()> fn) : m_fn(std::move(fn)) { setAutoDelete(true); }
+    void run() override { m_fn(); }
+
+private:
+    std::function<void()> m_fn;
+};
+
+}
+
+MapPreloader::MapPreloader(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setExpiryTimeout(5000);
+}
+
+MapPreloader::~MapPreloader()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+QStringList MapPreloader::resolveMapDirs(const QString &configValue)
+{
+    QStringList dirs;
+    const QStringList parts = configValue.split(QRegularExpression("[;,]"), Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        const QString trimmed = part.trimmed();
+        if (!trimmed.isEmpty()) dirs << trimmed;
+    }
+    if (!dirs.isEmpty()) return dirs;
+
+    // 与 Client 的 war3files 搜索路径保持一致
+    dirs << QCoreApplication::applicationDirPath() + "/war3files/maps";
+#ifdef Q_OS_LINUX
+    dirs << "/opt/War3Bot/war3files/maps";
+#endif
+    dirs << QDir::currentPath() + "/war3files/maps";
+    return dirs;
+}
+
+int MapPreloader::start(const QStringList &mapDirs, int threads)
+{
+    if (isRunning()) {
+        LOG_WARNING("🗺️ [地图预加载] 已在运行中，忽略重复启动");
+        return 0;
+    }
+
+    LOG_INFO("🗺️ [地图预加载] 扫描地图目录...");
+
+    // 1. 收集地图文件 (按绝对路径去重，多个搜索路径可能指向同一目录)
+    QStringList mapFiles;
+    QSet<QString> seen;
+    for (const QString &dirPath : mapDirs) {
+        QDir dir(dirPath);
+        if (!dir.exists()) continue;
+
+        int found = 0;
+        QDirIterator it(dir.absolutePath(), QStringList() << "*.w3x" << "*.w3m",
+                        QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString path = QFileInfo(it.next()).absoluteFilePath();
+            if (seen.contains(path)) continue;
+            seen.insert(path);
+            mapFiles << path;
+            found++;
+        }
+        LOG_INFO(QString("   ├─ 📂 %1 (%2 张)").arg(QDir::toNativeSeparators(dir.absolutePath())).arg(found));
+    }
+
+    if (mapFiles.isEmpty()) {
+        LOG_INFO("   └─ ⚠️ 未发现任何地图文件，跳过预加载");
+        return 0;
+    }
+
+    // 2. 重置状态
+    m_total = mapFiles.size();
+    m_progressStep = qMax(1, m_total / 10);
+    m_cancelled.store(false, std::memory_order_relaxed);
+    m_finished.store(0, std::memory_order_relaxed);
+    m_loaded.store(0, std::memory_order_relaxed);
+    m_failed.store(0, std::memory_order_relaxed);
+    m_skipped.store(0, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+    m_timer.start();
+
+    if (threads <= 0) threads = QThread::idealThreadCount();
+    m_pool.setMaxThreadCount(qBound(1, threads, m_total));
+
+    LOG_INFO(QString("   └─ 🚀 开始并行加载: %1 张地图 / %2 线程").arg(m_total).arg(m_pool.maxThreadCount()));
+
+    // 3. 提交任务
+    for (const QString &path : qAsConst(mapFiles)) {
+        m_pool.start(new MapPreloadTask([this, path]() { runTask(path); }));
+    }
+    return m_total;
+}
+
+void MapPreloader::runTask(const QString &mapPath)
+{
+    if (m_cancelled.load(std::memory_order_acquire)) {
+        m_skipped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // 临时对象析构后共享数据仍由 War3Map 缓存持有
+        War3Map map;
+        if (map.load(mapPath)) {
+            m_loaded.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_failed.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARNING(QString("🗺️ [地图预加载] 解析失败: %1").arg(QFileInfo(mapPath).fileName()));
+        }
+    }
+
+    const int done = m_finished.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (done % m_progressStep == 0 || done == m_total) {
+        LOG_INFO(QString("🗺️ [地图预加载] 进度 %1/%2").arg(done).arg(m_total));
+        emit progress(done, m_total);
+    }
+
+    // 最后一个完成的任务负责收尾
+    if (done == m_total) {
+        const qint64 elapsed = m_timer.elapsed();
+        const int loaded = m_loaded.load(std::memory_order_relaxed);
+        const int failed = m_failed.load(std::memory_order_relaxed);
+        const int skipped = m_skipped.load(std::memory_order_relaxed);
+
+        LOG_INFO(QString("🗺️ [地图预加载] 完成: 成功 %1 / 失败 %2 / 取消 %3, 耗时 %4 ms")
+                     .arg(loaded).arg(failed).arg(skipped).arg(elapsed));
+
+        m_running.store(false, std::memory_order_release);
+        emit finished(loaded, failed, skipped, elapsed);
+    }
+}
+
+void MapPreloader::cancel()
+{
+    if (!isRunning()) return;
+    if (m_cancelled.exchange(true, std::memory_order_acq_rel)) return;
+    LOG_INFO(QString("🗺️ [地图预加载] 已请求取消 (已完成 %1/%2)").arg(finishedCount()).arg(m_total));
+}
+
+bool MapPreloader::waitForDone(int msecs)
+{
+    return m_pool.waitForDone(msecs);
+}
@@ -4,6 +4,8 @@
 #include "calculate.h"
 #include "war3map.h"
 #include "logger.h"
+#include "packetsigner.h"
+#include "udpbatchsocket.h"
 #include <QDir>
 #include <QTimer>
 #include <QPointer>
@@ -12,17 +14,20 @@
 #include <QDataStream>
 #include <QStandardPaths>
 #include <QCoreApplication>
-#include <QNetworkDatagram>
-#include <QRandomGenerator>
-#include <QCryptographicHash>
+#include <QVarLengthArray>
 
 #ifdef Q_OS_WIN
 #include <winsock2.h>
 #else
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <unistd.h>
+#include <cerrno>
 #endif
 
+// 逐包诊断树: 需同时开启 server/trace_datagrams 与 DEBUG 级别，默认只剩一次布尔判断
+#define DGRAM_TRACE(...) do { if (m_traceDatagrams) LOG_DEBUG_F(__VA_ARGS__); } while (0)
+
 NetManager::NetManager(QObject *parent)
     : QObject(parent)
     , m_isRunning(false)
@@ -36,6 +41,7 @@ NetManager::NetManager(QObject *parent)
     , m_cleanupTimer(nullptr)
     , m_broadcastTimer(nullptr)
     , m_udpSocket(nullptr)
+    , m_udpIo(nullptr)
     , m_tcpServer(nullptr)
     , m_nextSessionId(1000)
     , m_serverSeq(0)
@@ -427,9 +433,17 @@ bool NetManager::startServer(quint64 port, const QString &configFile)
         return false;
     }
     setupSocketOptions();
-    LOG_INFO(QString("│   └── ✅ UDP 链路就绪: %1").arg(m_udpSocket->localPort()));
 
-    connect(m_udpSocket, &QUdpSocket::readyRead, this, &NetManager::onUDPReadyRead);
+    // 收包由批量后端接管 (Linux: recvmmsg/sendmmsg，其他平台: Qt)
+    m_udpIo = new UdpBatchSocket(m_udpSocket, [this](char *data, int size, const QHostAddress &sender, quint16 senderPort) {
+        handleIncomingDatagram(data, size, sender, senderPort);
+    }, this);
+    LOG_INFO(QString("│   ├── 收发后端: %1").arg(m_udpIo->backendName()));
+
+    if (m_udpWorkerCount > 1 && startUdpWorkers(m_udpSocket->localPort())) {
+        LOG_INFO(QString("│   ├── 接收线程: 主线程 + %1 个工作线程 (SO_REUSEPORT)").arg(m_udpWorkers.size()));
+    }
+    LOG_INFO(QString("│   └── ✅ UDP 链路就绪: %1").arg(m_udpSocket->localPort()));
 
     // 5. TCP 监听配置
     LOG_INFO(QString("├── 🤝 正在开启 TCP 服务监听 (端口: %1)...").arg(port));
@@ -465,6 +479,15 @@ void NetManager::loadConfiguration()
     m_cleanupInterval = m_settings->value("server/cleanup_interval", 20000).toInt();
     m_enableBroadcast = m_settings->value("server/enable_broadcast", false).toBool();
     m_broadcastInterval = m_settings->value("server/broadcast_interval", 10000).toInt();
+    m_traceDatagrams = m_settings->value("server/trace_datagrams", false).toBool();
+
+    // UDP 接收套接字数 (SO_REUSEPORT，仅 Linux)，0 = 按 CPU 核数
+    m_udpWorkerCount = m_settings->value("server/udp_workers", 1).toInt();
+    if (m_udpWorkerCount <= 0) m_udpWorkerCount = QThread::idealThreadCount();
+    m_udpWorkerCount = qBound(1, m_udpWorkerCount, 64);
+#ifndef Q_OS_LINUX
+    m_udpWorkerCount = 1;
+#endif
 }
 
 bool NetManager::setupSocketOptions()
@@ -482,6 +505,19 @@ bool NetManager::setupSocketOptions()
 
 bool NetManager::bindSocket(quint64 port)
 {
+    // 多接收线程: 主套接字同样需要在 bind 前打开 SO_REUSEPORT，才能与工作线程共享端口
+    if (m_udpWorkerCount > 1) {
+        int fd = openReusePortSocket(port);
+        if (fd >= 0 && m_udpSocket->setSocketDescriptor(fd, QUdpSocket::BoundState)) {
+            return true;
+        }
+#ifndef Q_OS_WIN
+        if (fd >= 0) ::close(fd);
+#endif
+        LOG_WARNING("│   ├── ⚠️ SO_REUSEPORT 绑定失败，退回单接收线程");
+        m_udpWorkerCount = 1;
+    }
+
     if (!m_udpSocket->bind(QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress)) {
         LOG_ERROR(QString("Bind Error: %1").arg(m_udpSocket->errorString()));
         return false;
@@ -489,6 +525,83 @@ bool NetManager::bindSocket(quint64 port)
     return true;
 }
 
+int NetManager::openReusePortSocket(quint64 port)
+{
+#ifdef Q_OS_LINUX
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((quint16)port);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        LOG_WARNING(QString("SO_REUSEPORT bind 失败 (端口 %1, errno %2)").arg(port).arg(errno));
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    Q_UNUSED(port);
+    return -1;
+#endif
+}
+
+bool NetManager::startUdpWorkers(quint64 port)
+{
+    // 每个工作线程持有一个同端口的套接字，内核按四元组哈希分流；
+    // 线程内完成看门狗 / 签名 / CRC 校验并直接应答心跳，其余业务包排队回主线程
+    for (int i = 1; i < m_udpWorkerCount; ++i) {
+        int fd = openReusePortSocket(port);
+        if (fd < 0) break;
+
+        QUdpSocket *socket = new QUdpSocket;
+        if (!socket->setSocketDescriptor(fd, QUdpSocket::BoundState)) {
+#ifndef Q_OS_WIN
+            ::close(fd);
+#endif
+            delete socket;
+            break;
+        }
+
+        UdpBatchSocket *io = new UdpBatchSocket(socket, UdpBatchSocket::DatagramHandler(), socket);
+        io->setHandler([this, io](char *data, int size, const QHostAddress &sender, quint16 senderPort) {
+            handleWorkerDatagram(io, data, size, sender, senderPort);
+        });
+
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("udp-rx-%1").arg(i));
+        socket->moveToThread(thread);
+        connect(thread, &QThread::finished, socket, &QObject::deleteLater);
+        thread->start();
+
+        m_udpWorkers.append({ thread, socket });
+    }
+
+    if (m_udpWorkers.size() + 1 < m_udpWorkerCount) {
+        LOG_WARNING(QString("│   ├── ⚠️ 接收工作线程仅启动 %1 / %2 个").arg(m_udpWorkers.size()).arg(m_udpWorkerCount - 1));
+    }
+    return !m_udpWorkers.isEmpty();
+}
+
+void NetManager::stopUdpWorkers()
+{
+    for (const UdpWorker &worker : qAsConst(m_udpWorkers)) {
+        worker.thread->quit();
+        worker.thread->wait();
+        delete worker.thread;
+    }
+    m_udpWorkers.clear();
+}
+
 void NetManager::setupTimers()
 {
     m_cleanupTimer = new QTimer(this);
@@ -510,7 +623,7 @@ void NetManager::stopServer()
     if (!m_isRunning) return;
     m_isRunning = false;
     cleanupResources();
-    m_registerInfos.clear();
+    m_sessions.clear();
     emit serverStopped();
 }
 
@@ -518,15 +631,19 @@ void NetManager::stopServer()
 
 qint64 NetManager::sendUdpPacket(const QHostAddress &target, quint64 port, PacketType type, const void *payload, quint64 payloadLen, quint32 sessionId)
 {
-    if (!m_udpSocket) {
+    return sendUdpPacketVia(m_udpIo, target, port, type, payload, payloadLen, sessionId);
+}
+
+qint64 NetManager::sendUdpPacketVia(UdpBatchSocket *io, const QHostAddress &target, quint64 port, PacketType type, const void *payload, quint64 payloadLen, quint32 sessionId)
+{
+    if (!io) {
         LOG_ERROR("❌ [UDP] 发送失败: UDP Socket 未初始化");
         return -1;
     }
 
-    // 1. 准备 Buffer
+    // 1. 准备 Buffer (常见的小包直接用栈空间)
     int totalSize = sizeof(PacketHeader) + payloadLen;
-    QByteArray buffer;
-    buffer.resize(totalSize);
+    QVarLengthArray<char, 512> buffer(totalSize);
 
     // 2. 填充 Header
     PacketHeader *header = reinterpret_cast<PacketHeader*>(buffer.data());
@@ -545,27 +662,22 @@ qint64 NetManager::sendUdpPacket(const QHostAddress &target, quint64 port, Packe
     }
 
     // 4. 计算 CRC
-    header->checksum = calculateStandardCRC16(buffer);
+    header->checksum = calculateStandardCRC16(buffer.constData(), totalSize);
 
     // 5. 后计算安全签名
-    QByteArray secret = getAppSecret();
-    QByteArray signSource = buffer + secret;
-    QByteArray signature = QCryptographicHash::hash(signSource, QCryptographicHash::Sha256);
-    memcpy(header->signature, signature.constData(), 16);
+    PacketSigner::sign(buffer.constData(), totalSize, header->signature);
 
     // 6. 发送
-    qint64 sent = m_udpSocket->writeDatagram(buffer, target, port);
-
-    QString typeStr = packetTypeToString(type);
+    qint64 sent = io->send(buffer.constData(), totalSize, target, port);
 
     if (sent < 0) {
         LOG_ERROR(QString("❌ [UDP] 发送失败 -> %1:%2 | Cmd: %3 | Error: %4")
-                      .arg(target.toString()).arg(port).arg(typeStr, m_udpSocket->errorString()));
+                      .arg(target.toString()).arg(port).arg(packetTypeToString(type), io->errorString()));
     } else {
         if (type == PacketType::C_S_HEARTBEAT || type == PacketType::S_C_PONG) {
-            LOG_DEBUG(QString("📤 [UDP] %1 -> %2:%3 (Len: %4)").arg(typeStr, target.toString()).arg(port).arg(sent));
+            LOG_DEBUG_F("📤 [UDP] %1 -> %2:%3 (Len: %4)", packetTypeToString(type), target.toString(), port, sent);
         } else {
-            LOG_INFO(QString("📤 [UDP] %1 -> %2:%3 (Len: %4)").arg(typeStr, target.toString()).arg(port).arg(sent));
+            LOG_INFO_F("📤 [UDP] %1 -> %2:%3 (Len: %4)", packetTypeToString(type), target.toString(), port, sent);
         }
     }
     return sent;
@@ -633,9 +745,7 @@ bool NetManager::sendTcpPacket(QTcpSocket *socket, PacketType type, const void *
 
     // 6. 计算校验
     header->checksum = calculateStandardCRC16(buffer);
-    QByteArray secret = getAppSecret();
-    QByteArray signature = QCryptographicHash::hash(buffer + secret, QCryptographicHash::Sha256);
-    memcpy(header->signature, signature.constData(), 16);
+    PacketSigner::sign(buffer.constData(), buffer.size(), header->signature);
 
     // 7. 执行发送
     QString peerInfo = QString("%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort());
@@ -661,167 +771,166 @@ bool NetManager::sendTcpPacket(QTcpSocket *socket, PacketType type, const void *
 
 // ==================== 二进制接收逻辑 ====================
 
-void NetManager::onUDPReadyRead()
-{
-    while (m_udpSocket && m_udpSocket->hasPendingDatagrams()) {
-        QNetworkDatagram datagram = m_udpSocket->receiveDatagram();
-        handleIncomingDatagram(datagram);
-    }
-}
-
-void NetManager::handleIncomingDatagram(const QNetworkDatagram &datagram)
+NetManager::DatagramVerdict NetManager::inspectDatagram(char *data, int size, const QHostAddress &senderAddr, quint16 senderPort)
 {
-    QString senderInfo = QString("%1:%2").arg(datagram.senderAddress().toString()).arg(datagram.senderPort());
-    QByteArray data = datagram.data();
+    // --- 1. 进入函数 (逐包诊断树由 server/trace_datagrams 控制) ---
+    DGRAM_TRACE("┌── [收到数据包] 来自: %1:%2", senderAddr.toString(), senderPort);
+    DGRAM_TRACE("│   ├── 原始大小: %1 字节", size);
 
-    // --- 1. 进入函数 ---
-    qDebug() << "┌── [收到数据包] 来自:" << senderInfo;
-    qDebug() << "│   ├── 原始大小:" << data.size() << "字节";
+    // 长度预检 (先于任何包头字段读取)
+    if (size < (int)sizeof(PacketHeader)) {
+        DGRAM_TRACE("│   └── ❌ [错误] 数据长度小于包头最小长度");
+        return DatagramDrop;
+    }
 
-    PacketHeader *header = reinterpret_cast<PacketHeader*>(data.data());
+    // 直接在接收缓冲区上解析
+    PacketHeader *header = reinterpret_cast<PacketHeader*>(data);
     PacketType packetType = static_cast<PacketType>(header->command);
 
     // 看门狗检查
-    if (!m_watchdog.checkUdpPacket(datagram.senderAddress(), data.size(), packetType, header->sessionId)) {
-        qDebug() << "│   └── ❌ [拒绝] 未通过看门狗流量检查";
-        return;
-    }
-
-    // 长度预检
-    if (data.size() < (int)sizeof(PacketHeader)) {
-        qDebug() << "│   └── ❌ [错误] 数据长度小于包头最小长度";
-        return;
+    if (!m_watchdog.checkUdpPacket(senderAddr, size, packetType, header->sessionId)) {
+        DGRAM_TRACE("│   └── ❌ [拒绝] 未通过看门狗流量检查");
+        return DatagramDrop;
     }
 
     // --- 2. 基础协议校验 ---
-    qDebug() << "│   ├── [1. 协议头校验]";
+    DGRAM_TRACE("│   ├── [1. 协议头校验]");
     if (header->magic != PROTOCOL_MAGIC || header->version != PROTOCOL_VERSION) {
-        qDebug() << "│   │   ├── 魔数:" << QString("0x%1").arg(header->magic, 0, 16).toUpper()
-                 << "(期望:" << QString("0x%1").arg(PROTOCOL_MAGIC, 0, 16).toUpper() << ")";
-        qDebug() << "│   │   ├── 版本:" << header->version << "(期望:" << PROTOCOL_VERSION << ")";
-        qDebug() << "│   │   └── ❌ 结果: 魔数或版本不匹配，丢弃";
-        return;
+        DGRAM_TRACE("│   │   ├── 魔数: 0x%1 (期望: 0x%2)",
+                    QString::number(header->magic, 16).toUpper(), QString::number(PROTOCOL_MAGIC, 16).toUpper());
+        DGRAM_TRACE("│   │   ├── 版本: %1 (期望: %2)", header->version, PROTOCOL_VERSION);
+        DGRAM_TRACE("│   │   └── ❌ 结果: 魔数或版本不匹配，丢弃");
+        return DatagramDrop;
     }
 
-    if (data.size() != static_cast<int>(sizeof(PacketHeader) + header->payloadLen)) {
-        qDebug() << "│   │   ├── 声明负载长度:" << header->payloadLen;
-        qDebug() << "│   │   ├── 实际总长度:" << data.size();
-        qDebug() << "│   │   └── ❌ 结果: 数据包完整性校验失败 (长度不匹配)";
-        return;
+    if (size != static_cast<int>(sizeof(PacketHeader) + header->payloadLen)) {
+        DGRAM_TRACE("│   │   ├── 声明负载长度: %1", header->payloadLen);
+        DGRAM_TRACE("│   │   ├── 实际总长度: %1", size);
+        DGRAM_TRACE("│   │   └── ❌ 结果: 数据包完整性校验失败 (长度不匹配)");
+        return DatagramDrop;
     }
-    qDebug() << "│   │   └── ✅ 基础校验通过";
+    DGRAM_TRACE("│   │   └── ✅ 基础校验通过");
 
+    // 探测 / 心跳不带签名，直接交给调用方回 PONG
     if (packetType == C_S_PING || packetType == C_S_HEARTBEAT) {
-        quint32 sessionId = header->sessionId;
-        bool isRegistered = false;
-        {
-            QReadLocker locker(&m_registerInfosLock);
-            isRegistered = m_sessionIndex.contains(sessionId);
-        }
-
-        if (!isRegistered && sessionId != 0) {
-            LOG_INFO(QString("🔍 [链路探测] 收到探测标识: %1 | 来自: %2:%3")
-                         .arg(sessionId)
-                         .arg(datagram.senderAddress().toString())
-                         .arg(datagram.senderPort()));
-        } else if (sessionId == 0) {
-            LOG_DEBUG(QString("🔍 [链路探测] 收到匿名探测 | 来自: %1:%2")
-                          .arg(datagram.senderAddress().toString())
-                          .arg(datagram.senderPort()));
-        }
-
-        handleUdpPing(header, datagram.senderAddress(), datagram.senderPort());
-        return;
+        return DatagramPing;
     }
 
     // 暂存校验位用于比对
     quint16 receivedChecksum = header->checksum;
-    char receivedSignature[16];
-    memcpy(receivedSignature, header->signature, 16);
+    char receivedSignature[PacketSigner::SIGNATURE_SIZE];
+    memcpy(receivedSignature, header->signature, PacketSigner::SIGNATURE_SIZE);
 
     // 重置校验位进行二次计算
-    memset(header->signature, 0, 16);
+    memset(header->signature, 0, PacketSigner::SIGNATURE_SIZE);
     header->checksum = 0;
 
     // --- 3. 安全签名校验 ---
-    qDebug() << "│   ├── [2. 签名校验]";
-    QByteArray secret = getAppSecret();
-    QCryptographicHash hasher(QCryptographicHash::Sha256);
-    hasher.addData(data);
-    hasher.addData(secret);
-    QByteArray expectedHash = hasher.result();
-
-    if (memcmp(receivedSignature, expectedHash.constData(), 16) != 0) {
-        qDebug() << "│   │   ├── 收到签名:" << QByteArray(receivedSignature, 16).toHex().toUpper();
-        qDebug() << "│   │   ├── 期望签名:" << expectedHash.toHex().toUpper();
-        qDebug() << "│   │   └── ❌ 结果: 签名验证失败 (密钥可能不一致)";
-        return;
+    DGRAM_TRACE("│   ├── [2. 签名校验]");
+    if (!PacketSigner::verify(data, size, receivedSignature)) {
+        DGRAM_TRACE("│   │   ├── 收到签名: %1", LogHex(QByteArray(receivedSignature, PacketSigner::SIGNATURE_SIZE), 0, false));
+        DGRAM_TRACE("│   │   └── ❌ 结果: 签名验证失败 (密钥可能不一致)");
+        return DatagramDrop;
     }
-    qDebug() << "│   │   └── ✅ 签名验证通过";
+    DGRAM_TRACE("│   │   └── ✅ 签名验证通过");
 
     // --- 4. CRC 校验 ---
-    qDebug() << "│   ├── [3. 内容校验]";
-    memcpy(header->signature, receivedSignature, 16);
-    quint16 calculatedCrc = calculateStandardCRC16(data);
+    DGRAM_TRACE("│   ├── [3. 内容校验]");
+    memcpy(header->signature, receivedSignature, PacketSigner::SIGNATURE_SIZE);
+    quint16 calculatedCrc = calculateStandardCRC16(data, size);
 
     if (calculatedCrc != receivedChecksum) {
-        qDebug() << "│   │   ├── 收到 CRC: 0x" << QString::number(receivedChecksum, 16).toUpper();
-        qDebug() << "│   │   ├── 计算 CRC: 0x" << QString::number(calculatedCrc, 16).toUpper();
-        qDebug() << "│   │   └── ❌ 结果: CRC 校验失败 (数据可能在传输中损坏)";
-        return;
+        DGRAM_TRACE("│   │   ├── 收到 CRC: 0x%1", QString::number(receivedChecksum, 16).toUpper());
+        DGRAM_TRACE("│   │   ├── 计算 CRC: 0x%1", QString::number(calculatedCrc, 16).toUpper());
+        DGRAM_TRACE("│   │   └── ❌ 结果: CRC 校验失败 (数据可能在传输中损坏)");
+        return DatagramDrop;
     }
-    qDebug() << "│   │   └── ✅ CRC 校验通过";
+    DGRAM_TRACE("│   │   └── ✅ CRC 校验通过");
 
-    // --- 5. 指令分发 ---
-    char *payload = data.data() + sizeof(PacketHeader);
+    return DatagramValid;
+}
 
-    qDebug() << "│   └── [4. 指令分发] 命令ID:" << packetType << "序列号:" << header->seq;
+void NetManager::handleIncomingDatagram(char *data, int size, const QHostAddress &senderAddr, quint16 senderPort)
+{
+    switch (inspectDatagram(data, size, senderAddr, senderPort)) {
+    case DatagramPing:
+        handleUdpPing(reinterpret_cast<const PacketHeader*>(data), senderAddr, senderPort);
+        break;
+    case DatagramValid:
+        dispatchDatagram(reinterpret_cast<const PacketHeader*>(data), data + sizeof(PacketHeader), senderAddr, senderPort);
+        break;
+    default:
+        break;
+    }
+}
 
-    QString currentClientId;
-    {
-        QReadLocker locker(&m_registerInfosLock);
-        currentClientId = m_sessionIndex.value(header->sessionId);
+void NetManager::handleWorkerDatagram(UdpBatchSocket *io, char *data, int size, const QHostAddress &senderAddr, quint16 senderPort)
+{
+    // 接收工作线程: 校验与心跳在本线程完成，回包走本线程的套接字
+    switch (inspectDatagram(data, size, senderAddr, senderPort)) {
+    case DatagramPing:
+        handleUdpPing(reinterpret_cast<const PacketHeader*>(data), senderAddr, senderPort, io);
+        break;
+    case DatagramValid: {
+        // 其余业务包校验通过后交给主线程处理
+        QByteArray packet(data, size);
+        QMetaObject::invokeMethod(this, [this, packet, senderAddr, senderPort]() {
+            dispatchDatagram(reinterpret_cast<const PacketHeader*>(packet.constData()),
+                             packet.constData() + sizeof(PacketHeader), senderAddr, senderPort);
+        }, Qt::QueuedConnection);
+        break;
+    }
+    default:
+        break;
     }
+}
+
+void NetManager::dispatchDatagram(const PacketHeader *header, const char *payload, const QHostAddress &senderAddr, quint16 senderPort)
+{
+    PacketType packetType = static_cast<PacketType>(header->command);
+
+    // --- 5. 指令分发 ---
+    DGRAM_TRACE("│   └── [4. 指令分发] 命令ID: %1 序列号: %2", packetType, header->seq);
 
     switch (packetType) {
     case C_S_PING:
     case C_S_HEARTBEAT: {
-        handleUdpPing(header, datagram.senderAddress(), datagram.senderPort());
+        handleUdpPing(header, senderAddr, senderPort);
         break;
     }
 
     case C_S_REGISTER: {
         if (header->payloadLen >= sizeof(CSRegisterPacket)) {
             LOG_INFO("📥 [UDP 接收] C_S_REGISTER (注册请求)");
-            handleRegister(header, reinterpret_cast<CSRegisterPacket*>(payload), datagram.senderAddress(), datagram.senderPort());
+            handleRegister(header, reinterpret_cast<const CSRegisterPacket*>(payload), senderAddr, senderPort);
         }
         break;
     }
     case C_S_UNREGISTER: {
         LOG_INFO(QString("📤 [UDP 接收] C_S_UNREGISTER (注销请求) | SID: %1").arg(header->sessionId));
-        handleUnregister(header, datagram.senderAddress(), datagram.senderPort());
+        handleUnregister(header, senderAddr, senderPort);
         break;
     }
 
     case C_S_ROOM_PING: {
         LOG_INFO("📥 [UDP 接收] C_S_ROOM_PING (房间列表Ping)");
-        handleRoomPing(header, payload, datagram.senderAddress(), datagram.senderPort());
+        handleRoomPing(header, payload, senderAddr, senderPort);
         break;
     }
 
     case C_S_CHECKMAPCRC: {
         if (header->payloadLen >= sizeof(CSCheckMapCRCPacket)) {
             LOG_INFO("📥 [UDP 接收] C_S_CHECKMAPCRC (地图校验检查)");
-            handleCheckMapCRC(header, reinterpret_cast<CSCheckMapCRCPacket*>(payload),
-                              datagram.senderAddress(), datagram.senderPort());
+            handleCheckMapCRC(header, reinterpret_cast<const CSCheckMapCRCPacket*>(payload),
+                              senderAddr, senderPort);
         }
         break;
     }
 
     default:
         LOG_WARNING(QString("❓ [UDP 未知指令] 来自 %1:%2 | Cmd: %3 (0x%4) | SID: %5")
-                        .arg(datagram.senderAddress().toString())
-                        .arg(datagram.senderPort())
+                        .arg(senderAddr.toString())
+                        .arg(senderPort)
                         .arg(packetType)
                         .arg(QString::number(packetType, 16).toUpper())
                         .arg(header->sessionId));
@@ -877,35 +986,32 @@ void NetManager::handleRegister(const PacketHeader *header, const CSRegisterPack
         return;
     }
 
-    QWriteLocker locker(&m_registerInfosLock);
-    for (const auto &peer : qAsConst(m_registerInfos)) {
+    QString onlineUser;
+    bool multiOpen = m_sessions.forEach([&](const RegisterInfo &peer) {
         if (peer.hardwareId == hardwareId && peer.username != username) {
-            LOG_WARNING(QString("┌─ [注册拦截] 拒绝多开"));
-            LOG_WARNING(QString("└─ 机器 %1 已有账号 %2 在线，当前请求: %3").arg(hardwareId, peer.username, username));
-            return;
+            onlineUser = peer.username;
+            return true;
         }
+        return false;
+    });
+    if (multiOpen) {
+        LOG_WARNING(QString("┌─ [注册拦截] 拒绝多开"));
+        LOG_WARNING(QString("└─ 机器 %1 已有账号 %2 在线，当前请求: %3").arg(hardwareId, onlineUser, username));
+        return;
     }
 
-    // 3. 业务处理
-    quint32 newSessionId = 0;
-    do { newSessionId = QRandomGenerator::global()->generate(); } while (newSessionId == 0 || m_sessionIndex.contains(newSessionId));
-
-    if (m_registerInfos.contains(clientId)) {
-        m_sessionIndex.remove(m_registerInfos[clientId].sessionId);
-    }
-
+    // 3. 业务处理 (sessionId 由会话表分配，同 clientId 的旧会话被替换)
     qint64 now = QDateTime::currentMSecsSinceEpoch();
     RegisterInfo info;
     info.clientId = clientId; info.hardwareId = hardwareId; info.username = username;
     info.localIp = localIp; info.localPort = packet->localPort;
     info.publicIp = actualPublicIp; info.publicPort = senderPort;
-    info.sessionId = newSessionId; info.lastSeen = now; info.firstSeen = now;
+    info.sessionId = 0; info.lastSeen = now; info.firstSeen = now;
     info.isRegistered = true; info.natType = packet->natType; info.lastSeq = header->seq;
 
-    m_registerInfos[clientId] = info;
+    quint32 newSessionId = m_sessions.registerClient(info, now + m_peerTimeout + 1);
     m_watchdog.markSessionActive(senderAddr, newSessionId);
 
-    m_sessionIndex[newSessionId] = clientId;
     DbManager::instance().updateUserHwid(username, hardwareId);
 
     // 4. 打印简洁树状日志
@@ -935,18 +1041,9 @@ void NetManager::handleUnregister(const PacketHeader *header, const QHostAddress
     // 1. 发送响应包给客户端
     sendUdpPacket(senderAddr, senderPort, S_C_UNREGISTER, nullptr, 0, header->sessionId);
 
-    QWriteLocker locker(&m_registerInfosLock);
-    if (!m_sessionIndex.contains(header->sessionId)) {
-        LOG_WARNING(QString("┌─ [注销失败] 未找到活跃会话"));
-        LOG_WARNING(QString("└─ SessionID: %1 | 来源: %2:%3")
-                        .arg(header->sessionId).arg(senderAddr.toString()).arg(senderPort));
-        return;
-    }
-
     // 2. 执行下线逻辑
-    QString clientId = m_sessionIndex.take(header->sessionId);
-    if (m_registerInfos.contains(clientId)) {
-        RegisterInfo info = m_registerInfos.take(clientId);
+    RegisterInfo info;
+    if (m_sessions.removeBySession(header->sessionId, &info)) {
 
         // 计算在线时长
         qint64 durationSec = (QDateTime::currentMSecsSinceEpoch() - info.firstSeen) / 1000;
@@ -962,7 +1059,9 @@ void NetManager::handleUnregister(const PacketHeader *header, const QHostAddress
         LOG_INFO(QString("├── 时长: %1").arg(durationStr));
         LOG_INFO(QString("└── 状态: 已离线 (内存资源已回收)"));
     } else {
-        LOG_ERROR(QString("└── [系统异常] 索引与主表不同步 (ClientId: %1)").arg(clientId));
+        LOG_WARNING(QString("┌─ [注销失败] 未找到活跃会话"));
+        LOG_WARNING(QString("└─ SessionID: %1 | 来源: %2:%3")
+                        .arg(header->sessionId).arg(senderAddr.toString()).arg(senderPort));
     }
 }
 
@@ -970,34 +1069,13 @@ quint8 NetManager::updateSessionState(quint32 sessionId, const QHostAddress &add
 {
     if (sessionId == 0) return Unregistered;
 
-    m_watchdog.markSessionActive(addr, sessionId);
-
-    QWriteLocker locker(&m_registerInfosLock);
-
-    if (!m_sessionIndex.contains(sessionId)) {
+    // 只在 sessionId 所在分片取读锁; 端点未变化时不加写锁
+    if (!m_sessions.touch(sessionId, addr, port, QDateTime::currentMSecsSinceEpoch(), outIpChanged)) {
         return Unregistered;
     }
 
-    QString clientId = m_sessionIndex.value(sessionId);
-    if (!m_registerInfos.contains(clientId)) {
-        return Unregistered;
-    }
-
-    RegisterInfo &info = m_registerInfos[clientId];
-
-    // 1. 更新活跃时间
-    info.lastSeen = QDateTime::currentMSecsSinceEpoch();
-
-    // 2. 检测并更新 IP
-    QString cleanIp = cleanAddress(addr);
-    if (outIpChanged) *outIpChanged = false;
-
-    if (info.publicIp != cleanIp || info.publicPort != port) {
-        if (outIpChanged) *outIpChanged = true;
-        info.publicIp = cleanIp;
-        info.publicPort = port;
-    }
-
+    // 会话确认存在后才计入该来源的配额 (随机 sessionId 的伪造心跳不能占住限速记录)
+    m_watchdog.markSessionActive(addr, sessionId);
     return Registered;
 }
 
@@ -1032,15 +1110,21 @@ void NetManager::handleTcpPing(QTcpSocket *socket)
     }
 }
 
-void NetManager::handleUdpPing(const PacketHeader *header, const QHostAddress &senderAddr, quint64 senderPort)
+void NetManager::handleUdpPing(const PacketHeader *header, const QHostAddress &senderAddr, quint64 senderPort, UdpBatchSocket *io)
 {
     bool ipChanged = false;
     quint32 sessionId = header->sessionId;
     int status = updateSessionState(sessionId, senderAddr, senderPort, &ipChanged);
 
+    if (sessionId == 0) {
+        LOG_DEBUG_F("🔍 [链路探测] 收到匿名探测 | 来自: %1:%2", senderAddr.toString(), senderPort);
+    } else if (status != Registered) {
+        LOG_INFO_F("🔍 [链路探测] 收到探测标识: %1 | 来自: %2:%3", sessionId, senderAddr.toString(), senderPort);
+    }
+
     SCPongPacket pongPkt;
     pongPkt.status = status;
-    sendUdpPacket(senderAddr, senderPort, S_C_PONG, &pongPkt, sizeof(pongPkt), sessionId);
+    sendUdpPacketVia(io ? io : m_udpIo, senderAddr, senderPort, S_C_PONG, &pongPkt, sizeof(pongPkt), sessionId);
 
     if (status == 2) {
         LOG_DEBUG(QString("🏓 [PING] 已注册探测 Session:%1 <-> %2:%3").arg(sessionId).arg(senderAddr.toString()).arg(senderPort));
@@ -1089,23 +1173,15 @@ void NetManager::handleRoomPing(const PacketHeader *header, const char *payload,
 
 void NetManager::handleCommand(const PacketHeader *header, const CSCommandPacket *packet)
 {
-    QWriteLocker locker(&m_registerInfosLock);
-
     // 1. 首先根据 SessionID 查找对应的 ClientID (ClientId)
-    if (!m_sessionIndex.contains(header->sessionId)) {
+    RegisterInfo info;
+    if (!m_sessions.findBySession(header->sessionId, &info)) {
         LOG_WARNING(QString("⚠️ [指令拒绝] 未知的 SessionID: %1").arg(header->sessionId));
         return;
     }
 
-    QString recordedClientId = m_sessionIndex.value(header->sessionId);
-
-    // 2. 检查数据一致性
-    if (!m_registerInfos.contains(recordedClientId)) {
-        LOG_WARNING(QString("⚠️ [指令拒绝] 数据不一致: ClientId %1 的注册信息已丢失").arg(recordedClientId));
-        return;
-    }
-
-    RegisterInfo &info = m_registerInfos[recordedClientId];
+    // 2. 会话表返回的是快照，后续发送 / 查库期间不持有任何分片锁
+    QString recordedClientId = info.clientId;
 
     // 3. 执行封禁检查
     if (DbManager::instance().isHardwareIdBanned(info.hardwareId) ||
@@ -1115,12 +1191,16 @@ void NetManager::handleCommand(const PacketHeader *header, const CSCommandPacket
         return;
     }
 
-    // 4. 序列号/防重放检查
-    if (header->seq <= info.lastSeq) {
+    // 4. 序列号/防重放检查 (在记录所在分片的写锁下比较并推进)
+    bool fresh = false;
+    m_sessions.updateBySession(header->sessionId, [&](RegisterInfo &record) {
+        fresh = header->seq > record.lastSeq;
+        if (fresh) record.lastSeq = header->seq;
+    });
+    if (!fresh) {
         LOG_WARNING(QString("🛡️ [重放拦截] 收到重复/过期的包, Seq: %1").arg(header->seq));
         return;
     }
-    info.lastSeq = header->seq;
 
     // 5. 提取数据包内容
     QString pktClientId = QString::fromUtf8(packet->clientId, strnlen(packet->clientId, sizeof(packet->clientId)));
@@ -1266,9 +1346,8 @@ TcpConnType NetManager::identifyTcpProtocol(QTcpSocket *socket)
 
     // 分支 D: 非法协议或垃圾数据
     if (available >= 8) {
-        QString hexData = head.toHex(' ').toUpper();
-        LOG_INFO("   ├── ❌ 协议识别失败: 头部数据不匹配任何已知模式");
-        LOG_INFO(QString("   └──  📦 原始字节 (Peek): %1").arg(hexData));
+        LOG_INFO_F("   ├── ❌ 协议识别失败: 头部数据不匹配任何已知模式");
+        LOG_INFO_F("   └──  📦 原始字节 (Peek): %1", LogHex(head, 0));
         LOG_ERROR("   └── 🛡️ 安全动作: 判定为非法连接，正在强制断开...");
 
         socket->disconnectFromHost();
@@ -1449,30 +1528,30 @@ void NetManager::updatePlayerCrcRecord(quint32 sessionId, const QString &crcToke
 {
     if (crcToken.isEmpty()) return;
 
-    QWriteLocker locker(&m_registerInfosLock);
     bool updated = false;
+    QString username;
 
-    // 1. 优先通过 SessionID 定位
-    if (sessionId != 0 && m_sessionIndex.contains(sessionId)) {
-        QString clientId = m_sessionIndex.value(sessionId);
-        if (m_registerInfos.contains(clientId)) {
-            m_registerInfos[clientId].crcToken = crcToken;
-            updated = true;
-            LOG_INFO(QString("🗺️ [CRC关联] 用户: %1 (SID:%2) -> %3")
-                         .arg(m_registerInfos[clientId].username).arg(sessionId).arg(crcToken));
-        }
+    // 1. 优先通过 SessionID 定位 (CRC 人数由会话表同步增减)
+    QString clientId = m_sessions.clientIdBySession(sessionId);
+    if (!clientId.isEmpty() && m_sessions.setCrcToken(clientId, crcToken, &username)) {
+        updated = true;
+        LOG_INFO(QString("🗺️ [CRC关联] 用户: %1 (SID:%2) -> %3")
+                     .arg(username).arg(sessionId).arg(crcToken));
     }
 
     // 2. 备选方案：通过 IP 定位
     if (!updated && !senderIp.isEmpty()) {
-        for (auto it = m_registerInfos.begin(); it != m_registerInfos.end(); ++it) {
-            if (it.value().publicIp == senderIp) {
-                it.value().crcToken = crcToken;
-                updated = true;
-                LOG_INFO(QString("🗺️ [CRC关联] 用户: %1 (via IP:%2) -> %3")
-                             .arg(it.value().username, senderIp, crcToken));
-                break;
-            }
+        clientId.clear();
+        m_sessions.forEach([&](const RegisterInfo &info) {
+            if (info.publicIp != senderIp) return false;
+            clientId = info.clientId;
+            return true;
+        });
+
+        if (!clientId.isEmpty() && m_sessions.setCrcToken(clientId, crcToken, &username)) {
+            updated = true;
+            LOG_INFO(QString("🗺️ [CRC关联] 用户: %1 (via IP:%2) -> %3")
+                         .arg(username, senderIp, crcToken));
         }
     }
 
@@ -1532,9 +1611,9 @@ void NetManager::handleTcpCustomMessage(QTcpSocket *socket)
 
         // B. 如果未绑定，且包里有 SessionID，尝试进行首次绑定
         if (currentClientId.isEmpty() && pHeader->sessionId != 0) {
-            QWriteLocker locker(&m_registerInfosLock);
-            if (m_sessionIndex.contains(pHeader->sessionId)) {
-                QString clientId = m_sessionIndex.value(pHeader->sessionId);
+            RegisterInfo info;
+            if (m_sessions.findBySession(pHeader->sessionId, &info)) {
+                QString clientId = info.clientId;
 
                 int connType = socket->property("ConnType").toInt();
 
@@ -1561,7 +1640,7 @@ void NetManager::handleTcpCustomMessage(QTcpSocket *socket)
                     currentClientId = clientId;
 
                     LOG_INFO(QString("🎮 [TCP 游戏通道识别] 玩家: %1 (UID:%2) 已识别为 W3GS 连接")
-                                 .arg(m_registerInfos[clientId].username, clientId));
+                                 .arg(info.username, clientId));
                 }
             } else {
                 LOG_ERROR(QString("⚠️ [TCP 绑定失败] 无效的 Session: %1").arg(pHeader->sessionId));
@@ -1804,7 +1883,6 @@ void NetManager::onTcpDisconnected() {
     QString clientId = socket->property("clientId").toString();
     if (!clientId.isEmpty()) {
         LOG_INFO(QString("🔌 [TCP断开] 立即同步清理玩家会话: %1").arg(clientId));
-        QWriteLocker locker(&m_registerInfosLock);
         if (m_tcpClients.value(clientId) == socket) {
             m_tcpClients.remove(clientId);
             removeClientInternal(clientId);
@@ -1915,12 +1993,10 @@ bool NetManager::sendStartWar3(const QString &clientId, quint8 status, quint8 er
     }
 
     // 3. 逻辑分支 B: UDP 发送 (回退方案)
-    QReadLocker locker(&m_registerInfosLock);
-    if (m_registerInfos.contains(clientId)) {
-        const RegisterInfo &info = m_registerInfos[clientId];
+    RegisterInfo info;
+    if (m_sessions.find(clientId, &info)) {
         QHostAddress targetAddr(info.publicIp);
         quint16 targetPort = static_cast<quint16>(info.publicPort);
-        locker.unlock();
 
         sendUdpPacket(targetAddr, targetPort, PacketType::S_C_START_WAR3, &pkt, sizeof(pkt));
 
@@ -1963,12 +2039,10 @@ bool NetManager::sendMessageToClient(const QString &clientId, PacketType type, q
     }
 
     // 3. 逻辑分支 B: UDP 发送 (回退方案)
-    QReadLocker locker(&m_registerInfosLock);
-    if (m_registerInfos.contains(clientId)) {
-        const RegisterInfo &info = m_registerInfos[clientId];
+    RegisterInfo info;
+    if (m_sessions.find(clientId, &info)) {
         QHostAddress targetAddr(info.publicIp);
         quint16 targetPort = static_cast<quint16>(info.publicPort);
-        locker.unlock();
 
         sendUdpPacket(targetAddr, targetPort, type, &pkt, sizeof(pkt));
 
@@ -2112,14 +2186,12 @@ void NetManager::sendUploadResult(QTcpSocket* socket, const QString& crc, const
     bool found = false;
     quint32 fallbackSessionId = socket->property("SessionId").toUInt(); // 获取 SessionID
 
-    QReadLocker locker(&m_registerInfosLock);
-
     // ---------------------------------------------------------
-    // 策略 1: 优先尝试通过 IP 匹配
+    // 策略 1: 如果 SessionID 存在，直接通过索引定位 (最准确)
     // ---------------------------------------------------------
-    for (const auto &info : qAsConst(m_registerInfos)) {
-        // 如果 SessionID 存在，优先匹配 SessionID (最准确)
-        if (fallbackSessionId != 0 && info.sessionId == fallbackSessionId) {
+    if (fallbackSessionId != 0) {
+        RegisterInfo info;
+        if (m_sessions.findBySession(fallbackSessionId, &info)) {
             targetAddr = QHostAddress(info.publicIp);
             targetPort = info.publicPort;
             found = true;
@@ -2128,37 +2200,19 @@ void NetManager::sendUploadResult(QTcpSocket* socket, const QString& crc, const
                 LOG_INFO(QString("🔄 [TCP/UDP关联] IP不一致 (TCP:%1 vs UDP:%2)，使用 SessionID:%3 修正")
                              .arg(senderIp, info.publicIp).arg(fallbackSessionId));
             }
-            break;
         }
-
-        // 如果没有 SessionID，才尝试 IP 匹配
-        if (fallbackSessionId == 0 && info.publicIp == senderIp) {
+    } else {
+        // ---------------------------------------------------------
+        // 策略 2: 如果没有 SessionID，才尝试 IP 匹配
+        // ---------------------------------------------------------
+        found = m_sessions.forEach([&](const RegisterInfo &info) {
+            if (info.publicIp != senderIp) return false;
             targetAddr = QHostAddress(info.publicIp);
             targetPort = info.publicPort;
-            found = true;
-            break;
-        }
-    }
-
-    // ---------------------------------------------------------
-    // 策略 2: 如果遍历完还没找到
-    // ---------------------------------------------------------
-    if (!found && fallbackSessionId != 0) {
-        // 尝试通过索引直接查找
-        if (m_sessionIndex.contains(fallbackSessionId)) {
-            QString clientId = m_sessionIndex.value(fallbackSessionId);
-            if (m_registerInfos.contains(clientId)) {
-                const RegisterInfo &info = m_registerInfos[clientId];
-                targetAddr = QHostAddress(info.publicIp);
-                targetPort = info.publicPort;
-                found = true;
-                LOG_INFO(QString("✅ 通过索引找回用户: %1 (Session: %2)").arg(clientId).arg(fallbackSessionId));
-            }
-        }
+            return true;
+        });
     }
 
-    locker.unlock(); // 尽早解锁
-
     if (!found) {
         LOG_WARNING(QString("⚠️ 上传结束，无法找到 UDP 用户 (IP: %1, SessionID: %2)")
                         .arg(senderIp)
@@ -2219,28 +2273,8 @@ void NetManager::onBroadcastTimeout()
 
 void NetManager::updateMostFrequentCrc()
 {
-    m_crcCounts.clear();
-
-    {
-        QReadLocker locker(&m_registerInfosLock);
-        for (const RegisterInfo &peer : qAsConst(m_registerInfos)) {
-            if (!peer.crcToken.isEmpty()) {
-                m_crcCounts[peer.crcToken]++;
-            }
-        }
-    }
-
-    QString maxCrcToken;
-    int maxCount = 0;
-
-    QMapIterator<QString, int> i(m_crcCounts);
-    while (i.hasNext()) {
-        i.next();
-        if (i.value() > maxCount) {
-            maxCount = i.value();
-            maxCrcToken = i.key();
-        }
-    }
+    // 在线人数随 CRC 关联 / 会话删除增量维护，这里只比较各 CRC 的计数
+    QString maxCrcToken = m_sessions.mostFrequentCrc();
 
     if (!maxCrcToken.isEmpty()) {
         QString path = m_crcRootPath + "/" + maxCrcToken;
@@ -2261,6 +2295,8 @@ void NetManager::cleanupResources()
 {
     if (m_cleanupTimer) m_cleanupTimer->deleteLater();
     if (m_broadcastTimer) m_broadcastTimer->deleteLater();
+    stopUdpWorkers();
+    if (m_udpIo) delete m_udpIo;
     if (m_udpSocket) m_udpSocket->disconnect(this);
     if (m_tcpServer) m_tcpServer->disconnect(this);
     if (m_udpSocket) m_udpSocket->deleteLater();
@@ -2268,6 +2304,7 @@ void NetManager::cleanupResources()
     if (m_settings) m_settings->deleteLater();
     m_cleanupTimer = nullptr;
     m_broadcastTimer = nullptr;
+    m_udpIo = nullptr;
     m_udpSocket = nullptr;
     m_tcpServer = nullptr;
     m_settings = nullptr;
@@ -2275,7 +2312,6 @@ void NetManager::cleanupResources()
 
 void NetManager::cleanupExpiredClients()
 {
-    QWriteLocker locker(&m_registerInfosLock);
     quint64 now = QDateTime::currentMSecsSinceEpoch();
 
     // 定义临时结构体存储待删除信息，避免在 remove 时丢失用户名等信息
@@ -2286,12 +2322,10 @@ void NetManager::cleanupExpiredClients()
     };
     QList<ExpiredClient> expiredList;
 
-    // 1. 扫描阶段
-    for (auto it = m_registerInfos.begin(); it != m_registerInfos.end(); ++it) {
-        quint64 silence = now - it.value().lastSeen;
-        if (silence > m_peerTimeout) {
-            expiredList.append({it.key(), it.value().username, silence});
-        }
+    // 1. 到期检查: 会话表只复核时间轮上到期的 clientId，仍活跃的自动顺延
+    const QList<RegisterInfo> expiredInfos = m_sessions.collectExpired((qint64)now, m_peerTimeout);
+    for (const RegisterInfo &info : expiredInfos) {
+        expiredList.append({info.clientId, info.username, now - info.lastSeen});
     }
 
     // 2. 如果没有过期用户，直接返回，保持日志清爽
@@ -2322,54 +2356,47 @@ void NetManager::cleanupExpiredClients()
 
 void NetManager::removeClientInternal(const QString &clientId)
 {
-    if (!m_registerInfos.contains(clientId)) return;
+    // 主表、sessionId 索引、CRC 计数与超时登记由会话表一并清理
+    RegisterInfo info;
+    if (!m_sessions.remove(clientId, &info)) return;
 
-    RegisterInfo info = m_registerInfos[clientId];
     m_watchdog.markSessionInactive(QHostAddress(info.publicIp), info.sessionId);
-
-    // 1. 获取 SessionID
-    quint32 sid = m_registerInfos[clientId].sessionId;
-
-    // 2. 删索引
-    m_sessionIndex.remove(sid);
-
-    // 3. 删主表
-    m_registerInfos.remove(clientId);
 }
 
 // ==================== 工具函数 ====================
 
 QList<RegisterInfo> NetManager::getOnlinePlayers() const
 {
-    QReadLocker locker(&m_registerInfosLock);
-    return m_registerInfos.values();
+    return m_sessions.snapshot();
 }
 
 void NetManager::kickUserIfOnline(const QString &username)
 {
-    QWriteLocker locker(&m_registerInfosLock);
-    for (auto it = m_registerInfos.begin(); it != m_registerInfos.end(); ++it) {
-        if (it.value().username == username) {
-            sendMessageToClient(it.key(), PacketType::S_C_ERROR, ERR_PERMISSION_DENIED, 0, "kickUserIfOnline", true);
-            QString clientId = it.key();
-            m_sessionIndex.remove(it.value().sessionId);
-            m_registerInfos.erase(it);
-            LOG_INFO("👞 已将在线的被封禁用户踢下线: " + username);
-            break;
-        }
-    }
+    QString clientId;
+    m_sessions.forEach([&](const RegisterInfo &info) {
+        if (info.username != username) return false;
+        clientId = info.clientId;
+        return true;
+    });
+    if (clientId.isEmpty()) return;
+
+    // 遍历结束后再发送 / 删除，不在分片锁内回调
+    sendMessageToClient(clientId, PacketType::S_C_ERROR, ERR_PERMISSION_DENIED, 0, "kickUserIfOnline", true);
+    m_sessions.remove(clientId);
+    LOG_INFO("👞 已将在线的被封禁用户踢下线: " + username);
 }
 
 QString NetManager::getHwidByUsername(const QString &username)
 {
-    {
-        QReadLocker locker(&m_registerInfosLock);
-        for (const auto &info : qAsConst(m_registerInfos)) {
-            if (info.username == username) {
-                LOG_INFO(QString("🔍 [在线匹配] 找到用户 %1 的 HWID: %2").arg(username, info.hardwareId));
-                return info.hardwareId;
-            }
-        }
+    QString onlineHwid;
+    m_sessions.forEach([&](const RegisterInfo &info) {
+        if (info.username != username) return false;
+        onlineHwid = info.hardwareId;
+        return true;
+    });
+    if (!onlineHwid.isEmpty()) {
+        LOG_INFO(QString("🔍 [在线匹配] 找到用户 %1 的 HWID: %2").arg(username, onlineHwid));
+        return onlineHwid;
     }
 
     QString hwid = DbManager::instance().getHwidFromHistory(username);
@@ -2410,9 +2437,7 @@ bool NetManager::isValidFileName(const QString &name)
 
 bool NetManager::isClientRegistered(const QString &clientId) const
 {
-    if (clientId.isEmpty()) return false;
-    QReadLocker locker(&m_registerInfosLock);
-    return m_registerInfos.contains(clientId);
+    return m_sessions.contains(clientId);
 }
 
 QString NetManager::cleanAddress(const QHostAddress &address) {
@@ -2483,6 +2508,6 @@ QString NetManager::packetTypeToString(PacketType type)
     }
 }
 
-QByteArray NetManager::getAppSecret() const { return "CC_War3_@#_Platform_2026_SecureKey"; }
+QByteArray NetManager::getAppSecret() { return PacketSigner::appSecret(); }
 
 bool NetManager::isRunning() const { return m_isRunning; }
@@ -0,0 +1,170 @@
+#include "packetsigner.h"
+#include <cstring>
+
+namespace {
+
+const char kAppSecret[] = "CC_War3_@#_Platform_2026_SecureKey";
+const int  kAppSecretLen = sizeof(kAppSecret) - 1;
+
+const quint32 K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline quint32 rotr(quint32 x, int n) { return (x >> n) | (x << (32 - n)); }
+
+inline quint32 loadBE32(const unsigned char *p)
+{
+    return ((quint32)p[0] << 24) | ((quint32)p[1] << 16) | ((quint32)p[2] << 8) | (quint32)p[3];
+}
+
+inline void storeBE32(unsigned char *p, quint32 v)
+{
+    p[0] = (unsigned char)(v >> 24); p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);  p[3] = (unsigned char)v;
+}
+
+// 栈上的 SHA-256 上下文 (纯值类型)
+struct Sha256Ctx {
+    quint32         state[8];
+    quint64         length;         // 已输入的总字节数
+    unsigned char   buffer[64];     // 未满一块的残留数据
+    int             bufferLen;
+};
+
+void compress(quint32 *state, const unsigned char *block)
+{
+    quint32 w[64];
+    for (int i = 0; i < 16; ++i) w[i] = loadBE32(block + i * 4);
+    for (int i = 16; i < 64; ++i) {
+        const quint32 s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const quint32 s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    quint32 a = state[0], b = state[1], c = state[2], d = state[3];
+    quint32 e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; ++i) {
+        const quint32 S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        const quint32 ch = (e & f) ^ (~e & g);
+        const quint32 t1 = h + S1 + ch + K[i] + w[i];
+        const quint32 S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        const quint32 maj = (a & b) ^ (a & c) ^ (b & c);
+        const quint32 t2 = S0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void init(Sha256Ctx &ctx)
+{
+    static const quint32 IV[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(ctx.state, IV, sizeof(IV));
+    ctx.length = 0;
+    ctx.bufferLen = 0;
+}
+
+void update(Sha256Ctx &ctx, const unsigned char *data, int len)
+{
+    ctx.length += (quint64)len;
+
+    // 1. 先补满残留块
+    if (ctx.bufferLen > 0) {
+        const int take = qMin(64 - ctx.bufferLen, len);
+        memcpy(ctx.buffer + ctx.bufferLen, data, take);
+        ctx.bufferLen += take;
+        data += take;
+        len -= take;
+        if (ctx.bufferLen < 64) return;
+        compress(ctx.state, ctx.buffer);
+        ctx.bufferLen = 0;
+    }
+
+    // 2. 整块直接在输入上压缩，不拷贝
+    while (len >= 64) {
+        compress(ctx.state, data);
+        data += 64;
+        len -= 64;
+    }
+
+    // 3. 剩余字节留到下一次
+    if (len > 0) {
+        memcpy(ctx.buffer, data, len);
+        ctx.bufferLen = len;
+    }
+}
+
+void final(Sha256Ctx &ctx, unsigned char *out)
+{
+    const quint64 bitLength = ctx.length * 8;
+
+    ctx.buffer[ctx.bufferLen++] = 0x80;
+    if (ctx.bufferLen > 56) {
+        memset(ctx.buffer + ctx.bufferLen, 0, 64 - ctx.bufferLen);
+        compress(ctx.state, ctx.buffer);
+        ctx.bufferLen = 0;
+    }
+    memset(ctx.buffer + ctx.bufferLen, 0, 56 - ctx.bufferLen);
+    storeBE32(ctx.buffer + 56, (quint32)(bitLength >> 32));
+    storeBE32(ctx.buffer + 60, (quint32)bitLength);
+    compress(ctx.state, ctx.buffer);
+
+    for (int i = 0; i < 8; ++i) storeBE32(out + i * 4, ctx.state[i]);
+}
+
+void signedDigest(const char *data, int len, unsigned char *digest)
+{
+    Sha256Ctx ctx;
+    init(ctx);
+    update(ctx, reinterpret_cast<const unsigned char*>(data), len);
+    update(ctx, reinterpret_cast<const unsigned char*>(kAppSecret), kAppSecretLen);
+    final(ctx, digest);
+}
+
+}
+
+namespace PacketSigner {
+
+QByteArray appSecret()
+{
+    return QByteArray::fromRawData(kAppSecret, kAppSecretLen);
+}
+
+void sign(const char *data, int len, char *out)
+{
+    unsigned char digest[32];
+    signedDigest(data, len, digest);
+    memcpy(out, digest, SIGNATURE_SIZE);
+}
+
+bool verify(const char *data, int len, const char *expected)
+{
+    unsigned char digest[32];
+    signedDigest(data, len, digest);
+
+    unsigned char diff = 0;
+    for (int i = 0; i < SIGNATURE_SIZE; ++i) diff |= digest[i] ^ (unsigned char)expected[i];
+    return diff == 0;
+}
+
+void sha256(const void *data, int len, unsigned char *out)
+{
+    Sha256Ctx ctx;
+    init(ctx);
+    update(ctx, static_cast<const unsigned char*>(data), len);
+    final(ctx, out);
+}
+
+}
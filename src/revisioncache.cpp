@@ -0,0 +1,186 @@
+#include "revisioncache.h"
+#include "logger.h"
+#include "bncsutil/checkrevision.h"
+#include <QDataStream>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+
+QMutex CheckRevisionCache::s_mutex;
+QWaitCondition CheckRevisionCache::s_computed;
+QHash<QString, quint32> CheckRevisionCache::s_entries;
+QSet<QString> CheckRevisionCache::s_computing;
+QSet<QString> CheckRevisionCache::s_loadedIndexes;
+bool CheckRevisionCache::s_persistent = false;
+quint64 CheckRevisionCache::s_generation = 0;
+QMutex CheckRevisionCache::s_saveMutex;
+QHash<QString, quint64> CheckRevisionCache::s_savedGenerations;
+std::atomic<quint64> CheckRevisionCache::s_hits { 0 };
+std::atomic<quint64> CheckRevisionCache::s_misses { 0 };
+
+// =========================================================
+// 持久化索引: <War3 目录>/checkrevision.idx
+// =========================================================
+static const quint32 REVISION_INDEX_MAGIC       = 0x56523357; // "W3RV"
+static const quint32 REVISION_INDEX_VERSION     = 1;
+static const int     REVISION_INDEX_MAX_ENTRIES = 256;        // 超出后整体清空重建
+
+static QString indexPathFor(const QString &exePath)
+{
+    return QFileInfo(exePath).absoluteDir().absoluteFilePath("checkrevision.idx");
+}
+
+bool CheckRevisionCache::checkRevision(const QByteArray &formula, const QString &exePath,
+                                       const QString &stormPath, const QString &gamePath,
+                                       int mpqNumber, quint32 *checkSum, bool *hit)
+{
+    if (hit) *hit = false;
+
+    // 1. 以文件指纹构造键 (任一文件缺失时键中大小为 -1，计算必然失败，不会入缓存)
+    const QString key = buildKey(formula, exePath, stormPath, gamePath, mpqNumber);
+    const QString indexPath = indexPathFor(exePath);
+
+    {
+        QMutexLocker locker(&s_mutex);
+        if (s_persistent && !s_loadedIndexes.contains(indexPath)) {
+            s_loadedIndexes.insert(indexPath);
+            loadIndexLocked(indexPath);
+        }
+
+        // 2. 同一键正在被其他分片线程计算时等待其结果，避免一批 Bot 同时哈希
+        while (s_computing.contains(key)) {
+            s_computed.wait(&s_mutex);
+        }
+
+        auto it = s_entries.constFind(key);
+        if (it != s_entries.constEnd()) {
+            *checkSum = it.value();
+            s_hits.fetch_add(1, std::memory_order_relaxed);
+            if (hit) *hit = true;
+            return true;
+        }
+
+        s_computing.insert(key);
+    }
+
+    // 3. 未命中: 锁外完整计算
+    s_misses.fetch_add(1, std::memory_order_relaxed);
+
+    unsigned long value = 0;
+    const bool ok = checkRevisionFlat(formula.constData(), exePath.toUtf8().constData(),
+                                      stormPath.toUtf8().constData(), gamePath.toUtf8().constData(),
+                                      mpqNumber, &value) != 0;
+
+    // 4. 锁内只入表并取该目录条目的快照，落盘在锁外进行，不阻塞其他分片的命中
+    QHash<QString, quint32> snapshot;
+    quint64 generation = 0;
+    bool persist = false;
+    {
+        QMutexLocker locker(&s_mutex);
+        s_computing.remove(key);
+        if (ok) {
+            *checkSum = (quint32)value;
+            if (s_entries.size() >= REVISION_INDEX_MAX_ENTRIES) s_entries.clear();
+            s_entries.insert(key, *checkSum);
+            if (s_persistent) {
+                snapshot = snapshotIndexLocked(indexPath);
+                generation = ++s_generation;
+                persist = true;
+            }
+        }
+        s_computed.wakeAll();
+    }
+
+    if (persist) saveIndex(indexPath, snapshot, generation);
+    return ok;
+}
+
+void CheckRevisionCache::setPersistent(bool enabled)
+{
+    QMutexLocker locker(&s_mutex);
+    s_persistent = enabled;
+}
+
+void CheckRevisionCache::clear()
+{
+    QMutexLocker locker(&s_mutex);
+    s_entries.clear();
+    s_loadedIndexes.clear();
+}
+
+int CheckRevisionCache::size()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_entries.size();
+}
+
+QString CheckRevisionCache::buildKey(const QByteArray &formula, const QString &exePath,
+                                     const QString &stormPath, const QString &gamePath, int mpqNumber)
+{
+    QString key = QString::fromLatin1(formula) + QLatin1Char('|') + QString::number(mpqNumber);
+    for (const QString &path : { exePath, stormPath, gamePath }) {
+        const QFileInfo info(path);
+        key += QString("|%1:%2:%3")
+                   .arg(info.absoluteFilePath())
+                   .arg(info.exists() ? info.size() : -1)
+                   .arg(info.lastModified().toMSecsSinceEpoch());
+    }
+    return key;
+}
+
+void CheckRevisionCache::loadIndexLocked(const QString &indexPath)
+{
+    QFile f(indexPath);
+    if (!f.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != REVISION_INDEX_MAGIC || version != REVISION_INDEX_VERSION) return;
+
+    QHash<QString, quint32> entries;
+    in >> entries;
+    if (in.status() != QDataStream::Ok) return;
+
+    // 持久化的旧条目键中带有文件指纹，文件变化后不会再被命中
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        s_entries.insert(it.key(), it.value());
+    }
+    LOG_INFO(QString("🧮 [版本校验缓存] 已载入 %1 条记录: %2").arg(entries.size()).arg(indexPath));
+}
+
+// 只保存属于该目录的条目
+QHash<QString, quint32> CheckRevisionCache::snapshotIndexLocked(const QString &indexPath)
+{
+    const QString dirPrefix = QFileInfo(indexPath).absolutePath() + QLatin1Char('/');
+    QHash<QString, quint32> entries;
+    for (auto it = s_entries.constBegin(); it != s_entries.constEnd(); ++it) {
+        if (it.key().contains(QLatin1Char('|') + dirPrefix)) entries.insert(it.key(), it.value());
+    }
+    return entries;
+}
+
+// 写入唯一临时文件后原子替换; 并发落盘时跳过比已写入版本更旧的快照
+void CheckRevisionCache::saveIndex(const QString &indexPath, const QHash<QString, quint32> &entries, quint64 generation)
+{
+    QMutexLocker locker(&s_saveMutex);
+    if (s_savedGenerations.value(indexPath, 0) >= generation) return;
+
+    QSaveFile f(indexPath);
+    if (!f.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(QString("🧮 [版本校验缓存] 无法写入: %1").arg(indexPath));
+        return;
+    }
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << REVISION_INDEX_MAGIC << REVISION_INDEX_VERSION << entries;
+    if (out.status() != QDataStream::Ok || !f.commit()) {
+        f.cancelWriting();
+        LOG_WARNING(QString("🧮 [版本校验缓存] 无法写入: %1").arg(indexPath));
+        return;
+    }
+    s_savedGenerations.insert(indexPath, generation);
+}
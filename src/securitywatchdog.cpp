@@ -1,49 +1,271 @@
 #include "securitywatchdog.h"
 #include "logger.h"
-#include <QDebug>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
 
-SecurityWatchdog::SecurityWatchdog(QObject *parent) : QObject(parent)
+#ifdef Q_OS_LINUX
+#include <time.h>
+#endif
+
+namespace {
+
+const quint64 KEY_EMPTY = 0;
+const quint64 KEY_BUSY  = ~Q_UINT64_C(0);
+
+const qint64 UDP_WINDOW_US = 1000000;       // UDP 令牌桶: 1 秒的突发容量
+const qint64 TCP_WINDOW_US = 60000000;      // TCP 令牌桶: 60 秒的突发容量
+
+// 粗粒度单调时钟 (毫秒): Linux 走 vDSO 的 CLOCK_MONOTONIC_COARSE，不陷入内核
+inline qint64 coarseNowMs()
+{
+#ifdef Q_OS_LINUX
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (qint64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#else
+    static const QElapsedTimer clock = []() { QElapsedTimer t; t.start(); return t; }();
+    return clock.elapsed();
+#endif
+}
+
+inline quint64 mix64(quint64 x)
+{
+    x ^= x >> 33; x *= Q_UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33; x *= Q_UINT64_C(0xc4ceb9fe1a85ec53);
+    x ^= x >> 33;
+    return x;
+}
+
+// GCRA: 把理论到达时间推后 cost，返回推后之后桶内的积压 (微秒)。
+// 积压上限为 window + cost，攻击停止后最多一个窗口即可恢复。
+inline qint64 chargeBucket(std::atomic<qint64> &tat, qint64 nowUs, qint64 costUs, qint64 windowUs)
+{
+    qint64 current = tat.load(std::memory_order_relaxed);
+    for (;;) {
+        const qint64 next = qMin(qMax(current, nowUs) + costUs, nowUs + windowUs + costUs);
+        if (tat.compare_exchange_weak(current, next, std::memory_order_relaxed)) return next - nowUs;
+    }
+}
+
+QString displayAddress(const QHostAddress &addr)
+{
+    bool ok = false;
+    const quint32 ipv4 = addr.toIPv4Address(&ok);
+    return ok ? QHostAddress(ipv4).toString() : QString("%1 (/64)").arg(addr.toString());
+}
+
+}
+
+SecurityWatchdog::SecurityWatchdog(QObject *parent)
+    : QObject(parent)
+    , m_hashSeed(QRandomGenerator::system()->generate64())
+    , m_ipStats(IPV4_TABLE_SETS, "IPv4")
+    , m_ipStatsV6(IPV6_TABLE_SETS, "IPv6")
 {
     addWhitelist("127.0.0.1");
     addWhitelist("::1");
+}
+
+SecurityWatchdog::~SecurityWatchdog() = default;
 
-    m_cleanupTimer = new QTimer(this);
-    connect(m_cleanupTimer, &QTimer::timeout, this, &SecurityWatchdog::cleanupStaleRecords);
-    m_cleanupTimer->start(CLEANUP_INTERVAL_MS);
+// ==================== 记录表 ====================
+
+// IPv4 (含 IPv4 映射地址) 以地址为键; IPv6 以 /64 前缀为键
+SecurityWatchdog::StatsTable *SecurityWatchdog::tableFor(const QHostAddress &addr, quint64 *key)
+{
+    bool ok = false;
+    const quint32 ipv4 = addr.toIPv4Address(&ok);
+    if (ok) {
+        *key = (Q_UINT64_C(1) << 32) | ipv4;
+        return &m_ipStats;
+    }
+
+    const Q_IPV6ADDR ipv6 = addr.toIPv6Address();
+    quint64 prefix = 0;
+    for (int i = 0; i < 8; ++i) prefix = (prefix << 8) | ipv6[i];
+    if (prefix == KEY_EMPTY || prefix == KEY_BUSY) prefix ^= 1;
+    *key = prefix;
+    return &m_ipStatsV6;
+}
+
+// 组号由带随机种子的哈希决定
+int SecurityWatchdog::setIndex(const StatsTable &table, quint64 key) const
+{
+    return (int)(mix64(key ^ m_hashSeed) & (quint64)(table.sets - 1));
 }
 
-quint32 SecurityWatchdog::parseIpToInt(const QHostAddress &addr) const {
-    bool ok;
-    quint32 ip = addr.toIPv4Address(&ok);
-    return ok ? ip : 0;
+IpStats *SecurityWatchdog::findStats(StatsTable &table, quint64 key) const
+{
+    IpStats *set = table.slots + setIndex(table, key) * TABLE_WAYS;
+    for (int way = 0; way < TABLE_WAYS; ++way) {
+        if (set[way].key.load(std::memory_order_acquire) == key) return &set[way];
+    }
+    return nullptr;
+}
+
+// 查找或占用一条记录。组内无空位时按以下顺序替换最久未活动的记录:
+//   1. 未封禁、没有近期在线 Session 的记录
+//   2. 已封禁的记录 (伪造源地址即可触发封禁，不能让它们长期占住整组)
+// 名单记录与有近期在线 Session 的记录不会被替换; 全部如此时返回 nullptr，由调用方走组共享配额。
+// 被替换记录上仍在进行的计数可能落到新记录上，只会让限速略偏严格。
+IpStats *SecurityWatchdog::acquireStats(StatsTable &table, quint64 key, qint64 nowMs)
+{
+    IpStats *set = table.slots + setIndex(table, key) * TABLE_WAYS;
+
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        IpStats *victim = nullptr;
+        quint64 victimKey = KEY_EMPTY;
+        int victimRank = 3;                 // 0 = 空, 1 = 闲置, 2 = 已封禁
+        qint64 victimActivity = 0;
+
+        for (int way = 0; way < TABLE_WAYS; ++way) {
+            IpStats &slot = set[way];
+            const quint64 slotKey = slot.key.load(std::memory_order_acquire);
+            if (slotKey == key) return &slot;
+            if (slotKey == KEY_BUSY) continue;
+
+            if (slotKey == KEY_EMPTY) {
+                if (victimRank != 0) { victim = &slot; victimKey = KEY_EMPTY; victimRank = 0; }
+                continue;
+            }
+            if (victimRank == 0) continue;
+
+            const qint64 activity = slot.lastActivityTime.load(std::memory_order_relaxed);
+            if (slot.flags.load(std::memory_order_relaxed) != 0) continue;
+            if (slot.activeSessions.load(std::memory_order_relaxed) > 0 && nowMs - activity < RECORD_TIMEOUT_MS) continue;
+
+            const int rank = slot.banExpireTime.load(std::memory_order_relaxed) > nowMs ? 2 : 1;
+            if (rank < victimRank || (rank == victimRank && activity < victimActivity)) {
+                victim = &slot;
+                victimKey = slotKey;
+                victimRank = rank;
+                victimActivity = activity;
+            }
+        }
+
+        if (!victim) break;
+
+        // 先锁定为 BUSY 再重置字段，最后发布新键
+        quint64 expected = victimKey;
+        if (!victim->key.compare_exchange_strong(expected, KEY_BUSY, std::memory_order_acq_rel)) continue;
+
+        quint32 generation = m_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (generation == 0) generation = m_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        victim->lastActivityTime.store(nowMs, std::memory_order_relaxed);
+        victim->udpTat.store(0, std::memory_order_relaxed);
+        victim->tcpTat.store(0, std::memory_order_relaxed);
+        victim->banExpireTime.store(0, std::memory_order_relaxed);
+        victim->violationCount.store(0, std::memory_order_relaxed);
+        victim->activeSessions.store(0, std::memory_order_relaxed);
+        victim->flags.store(0, std::memory_order_relaxed);
+        victim->generation.store(generation, std::memory_order_relaxed);
+        victim->key.store(key, std::memory_order_release);
+
+        if (victimKey != KEY_EMPTY) table.evictions.fetch_add(1, std::memory_order_relaxed);
+        return victim;
+    }
+
+    return nullptr;
+}
+
+// 组内没有可用记录: 不拒绝该来源，而是让同组所有溢出来源共用一份基础配额 (不封禁)
+bool SecurityWatchdog::checkFallback(StatsTable &table, quint64 key, bool isUdp, qint64 nowMs)
+{
+    const quint64 overflows = table.overflows.fetch_add(1, std::memory_order_relaxed) + 1;
+    if ((overflows & (overflows - 1)) == 0) {   // 1, 2, 4, 8 ... 次时提示，避免刷屏
+        LOG_WARNING(QString("🛡️ [安全拦截] %1 记录表组已满 (全部被名单/在线占用)，来源改用组共享配额 | 累计 %2 次")
+                        .arg(table.name).arg(overflows));
+    }
+
+    SetFallback &bucket = table.fallback[setIndex(table, key)];
+    if (isUdp) {
+        return chargeBucket(bucket.udpTat, nowMs * 1000, UDP_WINDOW_US / BASE_UDP_PER_SEC, UDP_WINDOW_US) <= UDP_WINDOW_US;
+    }
+    return chargeBucket(bucket.tcpTat, nowMs * 1000, TCP_WINDOW_US / MAX_TCP_PER_MIN_BASE, TCP_WINDOW_US) <= TCP_WINDOW_US;
 }
 
 // ==================== 业务同步逻辑 ====================
 
+quint64 SecurityWatchdog::sessionPair(quint64 key, quint32 sessionId) const
+{
+    return mix64(key ^ m_hashSeed) ^ sessionId;
+}
+
+SecurityWatchdog::SessionShard &SecurityWatchdog::sessionShard(quint64 pair)
+{
+    return m_sessionShards[mix64(pair) & (SESSION_SHARDS - 1)];
+}
+
+bool SecurityWatchdog::isKnownSession(quint64 key, quint32 sessionId, quint32 generation)
+{
+    const quint64 pair = sessionPair(key, sessionId);
+    SessionShard &shard = sessionShard(pair);
+    QReadLocker locker(&shard.lock);
+    auto it = shard.pairs.constFind(pair);
+    return it != shard.pairs.constEnd() && it.value() == generation;
+}
+
 void SecurityWatchdog::markSessionActive(const QHostAddress &ip, quint32 sessionId)
 {
     if (sessionId == 0) return;
-    QMutexLocker locker(&m_mutex);
-    quint32 ipv4 = parseIpToInt(ip);
 
-    if (ipv4 != 0) {
-        m_ipStats[ipv4].activeSessions.insert(sessionId);
-        m_ipStats[ipv4].lastActivityTime = QDateTime::currentMSecsSinceEpoch();
-    } else {
-        m_ipStatsFallback[ip.toString()].activeSessions.insert(sessionId);
-        m_ipStatsFallback[ip.toString()].lastActivityTime = QDateTime::currentMSecsSinceEpoch();
+    quint64 key;
+    StatsTable *table = tableFor(ip, &key);
+    const qint64 now = coarseNowMs();
+
+    IpStats *stats = acquireStats(*table, key, now);
+    if (!stats) return;     // 组已满: 该来源走组共享配额，不单独计数
+    const quint32 generation = stats->generation.load(std::memory_order_relaxed);
+
+    // 1. 心跳路径: 已登记的 Session 只刷新活跃时间 (读锁)
+    if (isKnownSession(key, sessionId, generation)) {
+        stats->lastActivityTime.store(now, std::memory_order_relaxed);
+        return;
+    }
+
+    // 2. 首次出现，或登记后记录曾被替换: (重新) 登记并增加该来源的配额
+    const quint64 pair = sessionPair(key, sessionId);
+    SessionShard &shard = sessionShard(pair);
+    bool counted = false;
+    {
+        QWriteLocker locker(&shard.lock);
+        auto it = shard.pairs.find(pair);
+        if (it == shard.pairs.end()) {
+            shard.pairs.insert(pair, generation);
+            counted = true;
+        } else if (it.value() != generation) {
+            it.value() = generation;
+            counted = true;
+        }
     }
+    if (counted) stats->activeSessions.fetch_add(1, std::memory_order_relaxed);
+    stats->lastActivityTime.store(now, std::memory_order_relaxed);
 }
 
 void SecurityWatchdog::markSessionInactive(const QHostAddress &ip, quint32 sessionId)
 {
-    QMutexLocker locker(&m_mutex);
-    quint32 ipv4 = parseIpToInt(ip);
-    if (ipv4 != 0) {
-        if (m_ipStats.contains(ipv4)) m_ipStats[ipv4].activeSessions.remove(sessionId);
-    } else {
-        QString ipStr = ip.toString();
-        if (m_ipStatsFallback.contains(ipStr)) m_ipStatsFallback[ipStr].activeSessions.remove(sessionId);
+    quint64 key;
+    StatsTable *table = tableFor(ip, &key);
+
+    IpStats *stats = findStats(*table, key);
+    const quint32 generation = stats ? stats->generation.load(std::memory_order_relaxed) : 0;
+
+    // 登记项总是删除; 只有登记在当前记录上的 Session 才扣减计数
+    const quint64 pair = sessionPair(key, sessionId);
+    SessionShard &shard = sessionShard(pair);
+    bool counted = false;
+    {
+        QWriteLocker locker(&shard.lock);
+        auto it = shard.pairs.find(pair);
+        if (it == shard.pairs.end()) return;
+        counted = (stats && it.value() == generation);
+        shard.pairs.erase(it);
+    }
+    if (!counted) return;
+
+    if (stats->activeSessions.fetch_sub(1, std::memory_order_relaxed) <= 0) {
+        stats->activeSessions.store(0, std::memory_order_relaxed);   // 记录曾被替换
     }
 }
 
@@ -51,72 +273,65 @@ void SecurityWatchdog::markSessionInactive(const QHostAddress &ip, quint32 sessi
 
 bool SecurityWatchdog::checkUdpPacket(const QHostAddress &sender, int packetSize, PacketType packetType, quint32 sessionId)
 {
-    quint32 ipv4 = parseIpToInt(sender);
-    QMutexLocker locker(&m_mutex);
-    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    // 1. 获取 Stats (无锁)
+    quint64 key;
+    StatsTable *table = tableFor(sender, &key);
+    const qint64 now = coarseNowMs();
 
-    // 1. 获取 Stats 引用
-    IpStats *stats;
-    QString ipStrFallback;
-    if (ipv4 != 0) {
-        if (m_whitelistInt.contains(ipv4)) return true;
-        if (m_blacklistInt.contains(ipv4)) return false;
-        stats = &m_ipStats[ipv4];
-    } else {
-        ipStrFallback = sender.toString();
-        if (m_ipStatsFallback.size() > MAX_IP_STATS_SIZE) return false;
-        stats = &m_ipStatsFallback[ipStrFallback];
-    }
+    IpStats *stats = acquireStats(*table, key, now);
+    if (!stats) return packetSize <= 1450 && checkFallback(*table, key, true, now);
 
-    stats->lastActivityTime = now;
+    const int flags = stats->flags.load(std::memory_order_relaxed);
+    if (flags & FlagWhitelist) return true;
+    if (flags & FlagBlacklist) return false;
+
+    // 粗粒度时钟在同一毫秒内不重复写同一缓存行
+    if (stats->lastActivityTime.load(std::memory_order_relaxed) != now) {
+        stats->lastActivityTime.store(now, std::memory_order_relaxed);
+    }
 
     // 2. 封禁检查
-    if (isIpBanned(ipv4, ipStrFallback, *stats, now)) return false;
+    if (isIpBanned(sender, *stats, now)) return false;
 
     // 3. 基础体积过滤
     if (packetSize > 1450) {
-        triggerBan(ipv4, ipStrFallback, *stats, "超大 UDP 畸形包");
+        triggerBan(sender, *stats, now, "超大 UDP 畸形包");
         return false;
     }
 
-    // 4. 频率重置逻辑
-    if (now - stats->lastUdpResetTime > 1000) {
-        stats->udpPacketCount = 0;
-        stats->lastUdpResetTime = now;
-    }
-    stats->udpPacketCount++;
-
-    // 5. 利用 sessionId 进行身份判定
-    // 检查这个包携带的 SessionId 是否是我们已经记录并验证过的
-    bool isKnownSession = (sessionId != 0 && stats->activeSessions.contains(sessionId));
+    // 4. 利用 sessionId 进行身份判定 (该来源没有在线 Session 时无需查表)
+    const int sessions = stats->activeSessions.load(std::memory_order_relaxed);
+    const bool isKnown = (sessionId != 0 && sessions > 0
+                          && isKnownSession(key, sessionId, stats->generation.load(std::memory_order_relaxed)));
 
-    // 6. 动态阈值计算
+    // 5. 动态阈值计算，差异化放行策略: 对高频小包放宽限制
     int dynamicLimit = getDynamicUdpLimit(*stats);
-
-    // 7. 差异化放行策略
     if (packetType == PacketType::C_S_HEARTBEAT ||
         packetType == PacketType::C_S_PING ||
         packetType == PacketType::C_S_ROOM_PING)
     {
-        dynamicLimit *= 5; // 对高频小包放宽限制
+        dynamicLimit *= 5;
     }
 
-    // 8. 针对非法 Session 的惩罚
+    // 6. 令牌桶计费: 每个包占 1/dynamicLimit 秒，积压超过 1 秒即超限
+    const qint64 backlog = chargeBucket(stats->udpTat, now * 1000, UDP_WINDOW_US / dynamicLimit, UDP_WINDOW_US);
+
+    // 7. 针对非法 Session 的惩罚
     // 如果这个 IP 下已经有玩家在线了，但当前包是一个未知的 SessionId，且不是注册包
     // 这极有可能是攻击者在同一个 NAT 网关下伪造非法包。
-    if (!isKnownSession && packetType != PacketType::C_S_REGISTER && !stats->activeSessions.isEmpty()) {
+    if (!isKnown && packetType != PacketType::C_S_REGISTER && sessions > 0) {
         // 对于已有在线玩家的 IP，非法的 Session 只允许占用 20% 的总带宽配额
-        if (stats->udpPacketCount > (dynamicLimit / 5)) {
+        if (backlog > UDP_WINDOW_US / 5) {
             // 这种情况下只静默丢弃包，不轻易触发封禁（防止由于玩家重连 Session 变更导致的误杀）
             return false;
         }
     }
 
-    // 9. 总量封禁检查
-    if (stats->udpPacketCount > dynamicLimit) {
-        triggerBan(ipv4, ipStrFallback, *stats,
+    // 8. 总量封禁检查
+    if (backlog > UDP_WINDOW_US) {
+        triggerBan(sender, *stats, now,
                    QString("UDP 洪水 (Limit:%1 | Known:%2)")
-                       .arg(dynamicLimit).arg(isKnownSession ? "Yes" : "No"));
+                       .arg(dynamicLimit).arg(isKnown ? "Yes" : "No"));
         return false;
     }
 
@@ -125,34 +340,22 @@ bool SecurityWatchdog::checkUdpPacket(const QHostAddress &sender, int packetSize
 
 bool SecurityWatchdog::checkTcpConnection(const QHostAddress &sender)
 {
-    quint32 ipv4 = parseIpToInt(sender);
-    QMutexLocker locker(&m_mutex);
-    qint64 now = QDateTime::currentMSecsSinceEpoch();
-
-    IpStats *stats;
-    QString ipStrFallback;
-
-    if (ipv4 != 0) {
-        if (m_whitelistInt.contains(ipv4)) return true;
-        stats = &m_ipStats[ipv4];
-    } else {
-        ipStrFallback = sender.toString();
-        stats = &m_ipStatsFallback[ipStrFallback];
-    }
-
-    stats->lastActivityTime = now;
-    if (isIpBanned(ipv4, ipStrFallback, *stats, now)) return false;
-
-    // TCP 频率重置 (60秒)
-    if (now - stats->lastTcpResetTime > 60000) {
-        stats->tcpConnCount = 0;
-        stats->lastTcpResetTime = now;
-    }
-    stats->tcpConnCount++;
-
-    int dynamicLimit = getDynamicTcpLimit(*stats);
-    if (stats->tcpConnCount > dynamicLimit) {
-        triggerBan(ipv4, ipStrFallback, *stats, "TCP 连接频繁");
+    quint64 key;
+    StatsTable *table = tableFor(sender, &key);
+    const qint64 now = coarseNowMs();
+
+    IpStats *stats = acquireStats(*table, key, now);
+    if (!stats) return checkFallback(*table, key, false, now);
+    if (stats->flags.load(std::memory_order_relaxed) & FlagWhitelist) return true;
+
+    stats->lastActivityTime.store(now, std::memory_order_relaxed);
+    if (isIpBanned(sender, *stats, now)) return false;
+
+    // TCP 令牌桶 (60秒窗口)
+    const int dynamicLimit = getDynamicTcpLimit(*stats);
+    const qint64 backlog = chargeBucket(stats->tcpTat, now * 1000, TCP_WINDOW_US / dynamicLimit, TCP_WINDOW_US);
+    if (backlog > TCP_WINDOW_US) {
+        triggerBan(sender, *stats, now, "TCP 连接频繁");
         return false;
     }
 
@@ -163,77 +366,64 @@ bool SecurityWatchdog::checkTcpConnection(const QHostAddress &sender)
 
 int SecurityWatchdog::getDynamicUdpLimit(const IpStats &stats) const {
     // 基础 150 + 每个在线玩家给 50 的额外带宽
-    return BASE_UDP_PER_SEC + (stats.activeSessions.size() * EXTRA_UDP_PER_SESSION);
+    return BASE_UDP_PER_SEC + (qMax(0, stats.activeSessions.load(std::memory_order_relaxed)) * EXTRA_UDP_PER_SESSION);
 }
 
 int SecurityWatchdog::getDynamicTcpLimit(const IpStats &stats) const {
-    return MAX_TCP_PER_MIN_BASE + (stats.activeSessions.size() * EXTRA_TCP_PER_SESSION);
+    return MAX_TCP_PER_MIN_BASE + (qMax(0, stats.activeSessions.load(std::memory_order_relaxed)) * EXTRA_TCP_PER_SESSION);
 }
 
-bool SecurityWatchdog::isIpBanned(quint32 ipInt, const QString &ipStr, IpStats &stats, qint64 now)
+bool SecurityWatchdog::isIpBanned(const QHostAddress &addr, IpStats &stats, qint64 nowMs)
 {
-    if (!stats.isBanned) return false;
-    if (now < stats.banExpireTime) return true;
+    qint64 expire = stats.banExpireTime.load(std::memory_order_relaxed);
+    if (expire == 0) return false;
+    if (nowMs < expire) return true;
 
-    stats.isBanned = false;
-    QString displayIp = ipInt != 0 ? QHostAddress(ipInt).toString() : ipStr;
-    LOG_INFO(QString("🔓 IP %1 自动解封 (封禁期满)").arg(displayIp));
+    // 只有把封禁状态清零的线程打印解封日志
+    if (stats.banExpireTime.compare_exchange_strong(expire, 0, std::memory_order_relaxed)) {
+        LOG_INFO(QString("🔓 IP %1 自动解封 (封禁期满)").arg(displayAddress(addr)));
+    }
     return false;
 }
 
-void SecurityWatchdog::triggerBan(quint32 ipInt, const QString &ipStr, IpStats &stats, const QString &reason)
+void SecurityWatchdog::triggerBan(const QHostAddress &addr, IpStats &stats, qint64 nowMs, const QString &reason)
 {
-    if (stats.isBanned) return;
-
-    stats.isBanned = true;
-    stats.violationCount++;
+    qint64 expire = stats.banExpireTime.load(std::memory_order_relaxed);
+    if (expire != 0 && nowMs < expire) return;
 
     // 阶梯封禁: 1min, 2min, 4min, 8min, 16min, max 32min
-    int duration = BAN_BASE_TIME_MS * (1 << qMin(stats.violationCount - 1, 5));
-    stats.banExpireTime = QDateTime::currentMSecsSinceEpoch() + duration;
+    const int violations = stats.violationCount.load(std::memory_order_relaxed) + 1;
+    const qint64 duration = (qint64)BAN_BASE_TIME_MS * (1 << qMin(violations - 1, 5));
 
-    QString displayIp = ipInt != 0 ? QHostAddress(ipInt).toString() : ipStr;
-    LOG_WARNING(QString("🛡️ [安全拦截] 封禁 IP: %1 | 原因: %2 | 在线Session数: %3")
-                    .arg(displayIp, reason).arg(stats.activeSessions.size()));
-}
-
-void SecurityWatchdog::cleanupStaleRecords()
-{
-    QMutexLocker locker(&m_mutex);
-    qint64 now = QDateTime::currentMSecsSinceEpoch();
-
-    auto cleanupMap = [&](auto &map) {
-        auto it = map.begin();
-        while (it != map.end()) {
-            // 只有同时满足以下条件才清理：
-            // 1. 没有被封禁
-            // 2. 超过 10 分钟没有数据往来
-            // 3. 该 IP 下已经没有任何活跃的 Session
-            if (!it.value().isBanned &&
-                (now - it.value().lastActivityTime > RECORD_TIMEOUT_MS) &&
-                it.value().activeSessions.isEmpty()) {
-                it = map.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    };
+    // 并发触发时只有一个线程生效并打印日志
+    if (!stats.banExpireTime.compare_exchange_strong(expire, nowMs + duration, std::memory_order_relaxed)) return;
+    stats.violationCount.fetch_add(1, std::memory_order_relaxed);
 
-    cleanupMap(m_ipStats);
-    cleanupMap(m_ipStatsFallback);
+    LOG_WARNING(QString("🛡️ [安全拦截] 封禁 IP: %1 | 原因: %2 | 在线Session数: %3")
+                    .arg(displayAddress(addr), reason).arg(stats.activeSessions.load(std::memory_order_relaxed)));
 }
 
 void SecurityWatchdog::addWhitelist(const QString &ip) {
-    QMutexLocker locker(&m_mutex);
-    quint32 ipInt = parseIpToInt(QHostAddress(ip));
-    if (ipInt != 0) m_whitelistInt.insert(ipInt);
+    quint64 key;
+    StatsTable *table = tableFor(QHostAddress(ip), &key);
+    if (IpStats *stats = acquireStats(*table, key, coarseNowMs())) {
+        stats->flags.fetch_or(FlagWhitelist, std::memory_order_relaxed);
+    }
+}
+
+void SecurityWatchdog::addBlacklist(const QString &ip) {
+    quint64 key;
+    StatsTable *table = tableFor(QHostAddress(ip), &key);
+    if (IpStats *stats = acquireStats(*table, key, coarseNowMs())) {
+        stats->flags.fetch_or(FlagBlacklist, std::memory_order_relaxed);
+    }
 }
 
 void SecurityWatchdog::unban(const QString &ip) {
-    QMutexLocker locker(&m_mutex);
-    quint32 ipInt = parseIpToInt(QHostAddress(ip));
-    if (ipInt != 0 && m_ipStats.contains(ipInt)) {
-        m_ipStats[ipInt].isBanned = false;
-        m_ipStats[ipInt].violationCount = 0;
+    quint64 key;
+    StatsTable *table = tableFor(QHostAddress(ip), &key);
+    if (IpStats *stats = findStats(*table, key)) {
+        stats->banExpireTime.store(0, std::memory_order_relaxed);
+        stats->violationCount.store(0, std::memory_order_relaxed);
     }
 }
@@ -0,0 +1,319 @@
+#include "sessionregistry.h"
+#include <QRandomGenerator>
+
+SessionRegistry::SessionRegistry(qint64 expiryTickMs)
+    : m_expiryWheel(expiryTickMs)
+{
+}
+
+// =========================================================
+// 1. 注册 / 删除
+// =========================================================
+
+quint32 SessionRegistry::registerClient(const RegisterInfo &info, qint64 expiryDeadlineMs)
+{
+    EntryPtr entry = EntryPtr::create();
+    entry->info = info;
+    entry->info.crcToken.clear();   // 新会话尚未关联地图
+    entry->lastSeen.store(info.lastSeen, std::memory_order_relaxed);
+    entry->endpoint.store(endpointKey(QHostAddress(info.publicIp), info.publicPort), std::memory_order_relaxed);
+
+    // 1. 在 sessionId 分片内分配并占用一个未使用的 sessionId
+    quint32 sessionId = 0;
+    for (;;) {
+        sessionId = QRandomGenerator::global()->generate();
+        if (sessionId == 0) continue;
+
+        Shard &shard = sessionShard(sessionId);
+        QWriteLocker locker(&shard.lock);
+        if (shard.bySession.contains(sessionId)) continue;
+        entry->info.sessionId = sessionId;
+        shard.bySession.insert(sessionId, entry);
+        break;
+    }
+
+    // 2. 写入主表，替换同 clientId 的旧会话
+    EntryPtr previous;
+    {
+        Shard &shard = clientShard(info.clientId);
+        QWriteLocker locker(&shard.lock);
+        previous = shard.byClient.value(info.clientId);
+        shard.byClient.insert(info.clientId, entry);
+        if (previous) adjustCrcCountLocked(previous->info.crcToken, -1);
+    }
+    if (previous) unlinkSession(previous);
+
+    // 3. 登记超时复核 (同一 clientId 重复登记时只保留最新截止时间)
+    {
+        QMutexLocker locker(&m_expiryLock);
+        m_expiryWheel.schedule(info.clientId, expiryDeadlineMs);
+    }
+
+    return sessionId;
+}
+
+bool SessionRegistry::remove(const QString &clientId, RegisterInfo *removed)
+{
+    EntryPtr entry;
+    {
+        Shard &shard = clientShard(clientId);
+        QWriteLocker locker(&shard.lock);
+        entry = shard.byClient.take(clientId);
+        if (!entry) return false;
+        adjustCrcCountLocked(entry->info.crcToken, -1);
+        fillSnapshot(entry, removed);
+    }
+    unlinkSession(entry);
+
+    QMutexLocker locker(&m_expiryLock);
+    m_expiryWheel.cancel(clientId);
+    return true;
+}
+
+bool SessionRegistry::removeBySession(quint32 sessionId, RegisterInfo *removed)
+{
+    EntryPtr entry = lookupSession(sessionId);
+    if (!entry) return false;
+
+    // 主表中已是更新的会话时只清理这个过期的 sessionId
+    const QString &clientId = entry->info.clientId;
+    bool owned = false;
+    {
+        Shard &shard = clientShard(clientId);
+        QWriteLocker locker(&shard.lock);
+        auto it = shard.byClient.find(clientId);
+        if (it != shard.byClient.end() && it.value() == entry) {
+            shard.byClient.erase(it);
+            adjustCrcCountLocked(entry->info.crcToken, -1);
+            owned = true;
+        }
+        fillSnapshot(entry, removed);
+    }
+    unlinkSession(entry);
+
+    if (owned) {
+        QMutexLocker locker(&m_expiryLock);
+        m_expiryWheel.cancel(clientId);
+    }
+    return owned;
+}
+
+void SessionRegistry::clear()
+{
+    for (Shard &shard : m_shards) {
+        QWriteLocker locker(&shard.lock);
+        shard.byClient.clear();
+        shard.bySession.clear();
+    }
+    {
+        QMutexLocker locker(&m_crcLock);
+        m_crcCounts.clear();
+    }
+    QMutexLocker locker(&m_expiryLock);
+    m_expiryWheel.clear();
+}
+
+// 只在索引仍指向该记录时删除 (sessionId 可能已被新会话复用)
+void SessionRegistry::unlinkSession(const EntryPtr &entry)
+{
+    const quint32 sessionId = entry->info.sessionId;
+    Shard &shard = sessionShard(sessionId);
+    QWriteLocker locker(&shard.lock);
+    auto it = shard.bySession.find(sessionId);
+    if (it != shard.bySession.end() && it.value() == entry) shard.bySession.erase(it);
+}
+
+// =========================================================
+// 2. 心跳
+// =========================================================
+
+bool SessionRegistry::touch(quint32 sessionId, const QHostAddress &addr, quint64 port, qint64 nowMs, bool *outEndpointChanged)
+{
+    if (outEndpointChanged) *outEndpointChanged = false;
+
+    EntryPtr entry = lookupSession(sessionId);
+    if (!entry) return false;
+
+    entry->lastSeen.store((quint64)nowMs, std::memory_order_relaxed);
+
+    // 1. 端点指纹一致: 无锁返回 (绝大多数心跳)
+    const quint64 key = endpointKey(addr, port);
+    if (key != 0 && key == entry->endpoint.load(std::memory_order_relaxed)) return true;
+
+    // 2. 指纹不一致或为 IPv6: 在主表分片上比较并更新字符串形式的地址
+    QString ip = addr.toString();
+    if (ip.startsWith("::ffff:")) ip = ip.mid(7);
+
+    Shard &shard = clientShard(entry->info.clientId);
+    QWriteLocker locker(&shard.lock);
+    if (entry->info.publicIp != ip || entry->info.publicPort != port) {
+        entry->info.publicIp = ip;
+        entry->info.publicPort = port;
+        if (outEndpointChanged) *outEndpointChanged = true;
+    }
+    entry->endpoint.store(key, std::memory_order_relaxed);
+    return true;
+}
+
+SessionRegistry::EntryPtr SessionRegistry::lookupSession(quint32 sessionId) const
+{
+    if (sessionId == 0) return EntryPtr();
+
+    const Shard &shard = sessionShard(sessionId);
+    QReadLocker locker(&shard.lock);
+    return shard.bySession.value(sessionId);
+}
+
+// IPv4 (含 IPv4 映射地址) 编码为 1 | ip | port; 其他地址返回 0
+quint64 SessionRegistry::endpointKey(const QHostAddress &addr, quint64 port)
+{
+    bool ok = false;
+    const quint32 ip = addr.toIPv4Address(&ok);
+    if (!ok) return 0;
+    return (Q_UINT64_C(1) << 48) | ((quint64)ip << 16) | (port & 0xFFFF);
+}
+
+// =========================================================
+// 3. 查询
+// =========================================================
+
+void SessionRegistry::fillSnapshot(const EntryPtr &entry, RegisterInfo *out)
+{
+    if (!out) return;
+    *out = entry->info;
+    out->lastSeen = entry->lastSeen.load(std::memory_order_relaxed);
+}
+
+bool SessionRegistry::find(const QString &clientId, RegisterInfo *out) const
+{
+    if (clientId.isEmpty()) return false;
+
+    const Shard &shard = clientShard(clientId);
+    QReadLocker locker(&shard.lock);
+    auto it = shard.byClient.constFind(clientId);
+    if (it == shard.byClient.constEnd()) return false;
+    fillSnapshot(it.value(), out);
+    return true;
+}
+
+bool SessionRegistry::findBySession(quint32 sessionId, RegisterInfo *out) const
+{
+    EntryPtr entry = lookupSession(sessionId);
+    if (!entry) return false;
+
+    const Shard &shard = clientShard(entry->info.clientId);
+    QReadLocker locker(&shard.lock);
+    if (shard.byClient.value(entry->info.clientId) != entry) return false;
+    fillSnapshot(entry, out);
+    return true;
+}
+
+QString SessionRegistry::clientIdBySession(quint32 sessionId) const
+{
+    EntryPtr entry = lookupSession(sessionId);
+    return entry ? entry->info.clientId : QString();
+}
+
+int SessionRegistry::size() const
+{
+    int total = 0;
+    for (const Shard &shard : m_shards) {
+        QReadLocker locker(&shard.lock);
+        total += shard.byClient.size();
+    }
+    return total;
+}
+
+QList<RegisterInfo> SessionRegistry::snapshot() const
+{
+    QList<RegisterInfo> result;
+    for (const Shard &shard : m_shards) {
+        QReadLocker locker(&shard.lock);
+        for (const EntryPtr &entry : shard.byClient) {
+            RegisterInfo info;
+            fillSnapshot(entry, &info);
+            result.append(info);
+        }
+    }
+    return result;
+}
+
+// =========================================================
+// 4. 地图 CRC 人数统计
+// =========================================================
+
+bool SessionRegistry::setCrcToken(const QString &clientId, const QString &crcToken, QString *username)
+{
+    Shard &shard = clientShard(clientId);
+    QWriteLocker locker(&shard.lock);
+    auto it = shard.byClient.find(clientId);
+    if (it == shard.byClient.end()) return false;
+
+    RegisterInfo &info = it.value()->info;
+    if (info.crcToken != crcToken) {
+        adjustCrcCountLocked(info.crcToken, -1);
+        adjustCrcCountLocked(crcToken, +1);
+        info.crcToken = crcToken;
+    }
+    if (username) *username = info.username;
+    return true;
+}
+
+// 调用方持有记录所在分片的写锁
+void SessionRegistry::adjustCrcCountLocked(const QString &crcToken, int delta)
+{
+    if (crcToken.isEmpty()) return;
+
+    QMutexLocker locker(&m_crcLock);
+    auto it = m_crcCounts.find(crcToken);
+    if (it == m_crcCounts.end()) {
+        if (delta > 0) m_crcCounts.insert(crcToken, delta);
+        return;
+    }
+    it.value() += delta;
+    if (it.value() <= 0) m_crcCounts.erase(it);
+}
+
+// 只遍历不同 CRC 的计数 (数量与在线人数无关); 人数相同时取键序最小者
+QString SessionRegistry::mostFrequentCrc(int *count) const
+{
+    QMutexLocker locker(&m_crcLock);
+
+    QString maxCrcToken;
+    int maxCount = 0;
+    for (auto it = m_crcCounts.constBegin(); it != m_crcCounts.constEnd(); ++it) {
+        if (it.value() > maxCount) {
+            maxCount = it.value();
+            maxCrcToken = it.key();
+        }
+    }
+
+    if (count) *count = maxCount;
+    return maxCrcToken;
+}
+
+// =========================================================
+// 5. 超时
+// ---------------------------------------------------------
+// 心跳只刷新 lastSeen 不改期，到期时按实际 lastSeen 复核，仍活跃则顺延
+// =========================================================
+
+QList<RegisterInfo> SessionRegistry::collectExpired(qint64 nowMs, quint64 timeoutMs)
+{
+    QList<RegisterInfo> expired;
+
+    QMutexLocker locker(&m_expiryLock);
+    m_expiryWheel.advance(nowMs, [&](const QString &clientId) {
+        RegisterInfo info;
+        if (!find(clientId, &info)) return;     // 已注销 / 已被踢出
+
+        // UDP 工作线程可能在取 nowMs 之后才 touch，lastSeen 比 nowMs 新时按活跃处理 (有符号比较，避免无符号下溢)
+        if (nowMs - (qint64)info.lastSeen > (qint64)timeoutMs) {
+            expired.append(info);
+        } else {
+            m_expiryWheel.schedule(clientId, (qint64)(info.lastSeen + timeoutMs + 1));
+        }
+    });
+
+    return expired;
+}
@@ -0,0 +1,256 @@
+#include "udpbatchsocket.h"
+#include "logger.h"
+#include <QSocketNotifier>
+#include <QThread>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+const int kRxBufferSize     = 65536;    // Qt 回退路径: 可容纳任意 UDP 报文
+const int kBatchSize        = 32;       // 每次 recvmmsg / sendmmsg 的报文数
+const int kSlotSize         = 2048;     // 批量路径单个报文槽 (控制协议与 W3GS UDP 报文均远小于此)
+const int kMaxRoundsPerWake = 16;       // 单次唤醒最多读取的批数，避免饿死事件循环
+
+}
+
+#ifdef Q_OS_LINUX
+struct UdpBatchSocket::BatchBuffers {
+    char            rx[kBatchSize][kSlotSize];
+    sockaddr_in     rxAddr[kBatchSize];
+    iovec           rxIov[kBatchSize];
+    mmsghdr         rxMsgs[kBatchSize];
+
+    char            tx[kBatchSize][kSlotSize];
+    sockaddr_in     txAddr[kBatchSize];
+    iovec           txIov[kBatchSize];
+    mmsghdr         txMsgs[kBatchSize];
+};
+#else
+struct UdpBatchSocket::BatchBuffers {};
+#endif
+
+UdpBatchSocket::UdpBatchSocket(QUdpSocket *socket, DatagramHandler handler, QObject *parent)
+    : QObject(parent)
+    , m_socket(socket)
+    , m_handler(std::move(handler))
+{
+    connect(socket, &QUdpSocket::readyRead, this, &UdpBatchSocket::onQtReadyRead);
+    connect(socket, &QUdpSocket::stateChanged, this, &UdpBatchSocket::onSocketStateChanged);
+
+    if (socket->state() == QAbstractSocket::BoundState) attach();
+}
+
+UdpBatchSocket::~UdpBatchSocket()
+{
+    detach();
+    delete m_batch;
+}
+
+bool UdpBatchSocket::batchingAvailable()
+{
+#ifdef Q_OS_LINUX
+    static const bool enabled = qEnvironmentVariableIsEmpty("WAR3BOT_NO_UDP_BATCH");
+    return enabled;
+#else
+    return false;
+#endif
+}
+
+void UdpBatchSocket::onSocketStateChanged(QAbstractSocket::SocketState state)
+{
+    if (state == QAbstractSocket::BoundState) attach();
+    else detach();
+}
+
+// =========================================================
+// 1. 挂接 / 解除批量路径
+// ---------------------------------------------------------
+// 在 dup 出的描述符上注册独立的 QSocketNotifier (同一描述符不能注册两个读通知器)。
+// QUdpSocket 自身的读通知器在首次 readyRead 后因无人经由 Qt 读取而自行停用。
+// =========================================================
+
+void UdpBatchSocket::attach()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd >= 0 || !m_socket || !batchingAvailable()) return;
+
+    const int fd = (int)m_socket->socketDescriptor();
+    if (fd < 0) return;
+
+    m_fd = ::dup(fd);
+    if (m_fd < 0) {
+        LOG_WARNING(QString("📡 [UDP 批量] dup 失败 (errno %1)，使用 Qt 收发").arg(errno));
+        return;
+    }
+
+    m_txCount = 0;
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, SIGNAL(activated(int)), this, SLOT(onBatchReadable()));
+
+    LOG_DEBUG(QString("📡 [UDP 批量] 已挂接端口 %1 (recvmmsg/sendmmsg x %2)")
+                  .arg(m_socket->localPort()).arg(kBatchSize));
+#endif
+}
+
+void UdpBatchSocket::detach()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd < 0) return;
+
+    flush();
+    // detach 可能由 activated 槽内的回调触发，notifier 仍在调用栈上，只能延迟析构
+    m_notifier->setEnabled(false);
+    m_notifier->deleteLater();
+    m_notifier = nullptr;
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+}
+
+// =========================================================
+// 2. 收包
+// =========================================================
+
+void UdpBatchSocket::onQtReadyRead()
+{
+    if (isBatched()) {
+        onBatchReadable();
+        return;
+    }
+
+    if (m_rxBuffer.size() != kRxBufferSize) m_rxBuffer.resize(kRxBufferSize);
+
+    while (m_socket && m_socket->hasPendingDatagrams()) {
+        qint64 size = m_socket->readDatagram(m_rxBuffer.data(), m_rxBuffer.size(), &m_sender, &m_senderPort);
+        if (size < 0) break;
+        m_handler(m_rxBuffer.data(), (int)size, m_sender, m_senderPort);
+    }
+}
+
+void UdpBatchSocket::onBatchReadable()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd < 0 || m_inBatch) return;
+
+    // 批量缓冲区 (~128 KiB) 在首次收包时才分配: 多数 Bot 的房间端口很少收到报文
+    if (!m_batch) m_batch = new BatchBuffers;
+    BatchBuffers &b = *m_batch;
+    m_inBatch = true;
+
+    for (int round = 0; round < kMaxRoundsPerWake && m_fd >= 0; ++round) {
+        for (int i = 0; i < kBatchSize; ++i) {
+            b.rxIov[i].iov_base = b.rx[i];
+            b.rxIov[i].iov_len = kSlotSize;
+            memset(&b.rxMsgs[i], 0, sizeof(mmsghdr));
+            b.rxMsgs[i].msg_hdr.msg_name = &b.rxAddr[i];
+            b.rxMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            b.rxMsgs[i].msg_hdr.msg_iov = &b.rxIov[i];
+            b.rxMsgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const int received = recvmmsg(m_fd, b.rxMsgs, kBatchSize, MSG_DONTWAIT, nullptr);
+        if (received <= 0) break;   // EAGAIN: 队列已读空
+
+        for (int i = 0; i < received && m_fd >= 0; ++i) {
+            const mmsghdr &msg = b.rxMsgs[i];
+            if (msg.msg_hdr.msg_flags & MSG_TRUNC) {
+                LOG_DEBUG(QString("📡 [UDP 批量] 丢弃超长报文 (> %1 字节)").arg(kSlotSize));
+                continue;
+            }
+
+            // 同一来源连续到达时 (心跳风暴中很常见) 复用上一个 QHostAddress
+            const sockaddr_in &addr = b.rxAddr[i];
+            const quint32 ip = ntohl(addr.sin_addr.s_addr);
+            if (m_sender.protocol() != QAbstractSocket::IPv4Protocol || m_sender.toIPv4Address() != ip) {
+                m_sender.setAddress(ip);
+            }
+            m_senderPort = ntohs(addr.sin_port);
+
+            m_handler(b.rx[i], (int)msg.msg_len, m_sender, m_senderPort);
+        }
+
+        flush();
+        if (received < kBatchSize) break;
+    }
+
+    m_inBatch = false;
+    flush();
+#endif
+}
+
+// =========================================================
+// 3. 发包
+// =========================================================
+
+qint64 UdpBatchSocket::send(const char *data, int size, const QHostAddress &target, quint16 port)
+{
+    if (!m_socket) return -1;
+
+#ifdef Q_OS_LINUX
+    // 只有本线程收包回调内的 IPv4 小包走批量发送
+    if (m_inBatch && m_fd >= 0 && size <= kSlotSize
+        && target.protocol() == QAbstractSocket::IPv4Protocol
+        && QThread::currentThread() == thread()) {
+
+        if (m_txCount == kBatchSize) flush();
+
+        BatchBuffers &b = *m_batch;
+        const int i = m_txCount++;
+        memcpy(b.tx[i], data, size);
+
+        memset(&b.txAddr[i], 0, sizeof(sockaddr_in));
+        b.txAddr[i].sin_family = AF_INET;
+        b.txAddr[i].sin_addr.s_addr = htonl(target.toIPv4Address());
+        b.txAddr[i].sin_port = htons(port);
+
+        b.txIov[i].iov_base = b.tx[i];
+        b.txIov[i].iov_len = size;
+        memset(&b.txMsgs[i], 0, sizeof(mmsghdr));
+        b.txMsgs[i].msg_hdr.msg_name = &b.txAddr[i];
+        b.txMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        b.txMsgs[i].msg_hdr.msg_iov = &b.txIov[i];
+        b.txMsgs[i].msg_hdr.msg_iovlen = 1;
+        return size;
+    }
+#endif
+
+    return m_socket->writeDatagram(data, size, target, port);
+}
+
+void UdpBatchSocket::flush()
+{
+#ifdef Q_OS_LINUX
+    if (m_txCount == 0 || m_fd < 0) {
+        m_txCount = 0;
+        return;
+    }
+
+    int sent = 0;
+    while (sent < m_txCount) {
+        const int n = sendmmsg(m_fd, m_batch->txMsgs + sent, m_txCount - sent, MSG_DONTWAIT);
+        if (n > 0) {
+            sent += n;
+            continue;
+        }
+
+        const int err = errno;
+        if (err == EINTR) continue;
+
+        // 发送缓冲区满: 本批剩余报文全部丢弃; 其他错误 (如目标不可达) 只跳过出错的那一个 (UDP 语义)
+        const int dropped = (err == EAGAIN || err == EWOULDBLOCK) ? (m_txCount - sent) : 1;
+        m_txDropped += (quint64)dropped;
+        sent += dropped;
+        LOG_WARNING(QString("📡 [UDP 批量] sendmmsg 失败 (errno %1)，丢弃 %2 个报文 / 累计 %3")
+                        .arg(err).arg(dropped).arg(m_txDropped));
+    }
+    m_txCount = 0;
+#endif
+}
@@ -7,11 +7,13 @@ War3Bot::War3Bot(QObject *parent)
     : QObject(parent)
     , m_forcePortReuse(false)
     , m_botManager(nullptr)
+    , m_mapPreloader(nullptr)
     , m_netManager(nullptr)
     , m_client(nullptr)
 {
     m_client = new Client(this);
     m_botManager = new BotManager(this);
+    m_mapPreloader = new MapPreloader(this);
     connect(m_client, &Client::authenticated, this, &War3Bot::onBnetAuthenticated);
     connect(m_client, &Client::gameCreateSuccess, this, &War3Bot::onGameCreateSuccess);
 }
@@ -109,6 +111,16 @@ bool War3Bot::startServer(quint16 port, const QString &configFile)
             LOG_INFO(QString("│   ├── 👤 主机器人显示名: %1").arg(botDisplayName));
         }
 
+        // 地图库后台预加载 (线程池并行解析，填充 War3Map 共享缓存)
+        if (settings.value("maps/preload", true).toBool()) {
+            QStringList mapDirs = MapPreloader::resolveMapDirs(settings.value("maps/preload_dirs", "").toString());
+            int preloadThreads = settings.value("maps/preload_threads", 0).toInt();
+            LOG_INFO(QString("│   ├── 🗺️ 地图预加载: 已开启 (%1 个目录)").arg(mapDirs.size()));
+            m_mapPreloader->start(mapDirs, preloadThreads);
+        } else {
+            LOG_INFO("│   ├── 🗺️ 地图预加载: ⛔ 关闭");
+        }
+
         LOG_INFO(QString("└── 🤖 机器人集群初始化 (目标在线: %1)...").arg(botCount));
 
         // 执行集群启动
@@ -225,6 +237,9 @@ void War3Bot::stopAdv()
 
 void War3Bot::stopServer()
 {
+    if (m_mapPreloader && m_mapPreloader->isRunning()) {
+        m_mapPreloader->cancel();
+    }
     if (m_netManager) {
         m_netManager->stopServer();
         LOG_INFO("War3Bot 服务器已停止");
@@ -1,15 +1,28 @@
 #include "war3map.h"
 #include "logger.h"
+#include "bitrotate.h"
+#include "bnethash.h"
 #include <QDir>
 #include <QFile>
 #include <QDebug>
 #include <QtEndian>
 #include <QFileInfo>
-#include <QCryptographicHash>
-
+#include <QSaveFile>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QCoreApplication>
+#include <QHash>
+
+#include <vector>
 #include <zlib.h>
 #include "StormLib.h"
 
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 
 QMutex War3Map::s_cacheMutex;
 QMutex War3Map::s_priorityCrcDirMutex;
@@ -32,9 +45,87 @@ static inline quint32 rotateLeft(quint32 value, int shift) {
 }
 
 // 以 Little-Endian 模式将 uint32 写入 SHA1
-void sha1UpdateInt32(QCryptographicHash &sha1, quint32 value) {
+static void sha1UpdateInt32(t_sha1_ctx *sha1, quint32 value) {
     quint32 le = qToLittleEndian(value);
-    sha1.addData((const char*)&le, 4);
+    sha1_update(sha1, &le, 4);
+}
+
+// =========================================================
+// 地图索引 (Sidecar): <地图文件>.idx
+// ---------------------------------------------------------
+// 以 "大小 + 修改时间 + 优先 CRC 目录 + 两个基础脚本的指纹" 为键，
+// 缓存 MapCRC / SHA1 / MapInfo / w3i 元数据 / 尺寸 / 分片包头，
+// 命中时 load 只需 stat + 读一个小文件，任一条件变化自动失效。
+// =========================================================
+static const quint32 MAP_INDEX_MAGIC    = 0x58493357; // "W3IX"
+static const quint32 MAP_INDEX_VERSION  = 2;          // v2: 每个条目前置写入时间戳
+static const int     MAP_INDEX_MAX_KEYS = 8;          // 每张地图最多保留的 CRC 目录变体
+
+static QDataStream &operator<<(QDataStream &out, const W3iPlayer &p) {
+    return out << p.id << p.type << p.race << p.fix << p.name << p.startX << p.startY << p.allyLow << p.allyHigh;
+}
+static QDataStream &operator>>(QDataStream &in, W3iPlayer &p) {
+    return in >> p.id >> p.type >> p.race >> p.fix >> p.name >> p.startX >> p.startY >> p.allyLow >> p.allyHigh;
+}
+static QDataStream &operator<<(QDataStream &out, const W3iForce &f) {
+    return out << f.flags << f.playerMasks << f.name;
+}
+static QDataStream &operator>>(QDataStream &in, W3iForce &f) {
+    return in >> f.flags >> f.playerMasks >> f.name;
+}
+
+static void writeIndexEntry(QDataStream &out, const War3MapSharedData &d) {
+    out << d.mapSize << d.mapInfo << d.mapCRC << d.mapSHA1Bytes
+        << d.mapWidth << d.mapHeight << d.mapPlayableWidth << d.mapPlayableHeight
+        << d.mapOptions << d.w3iPlayers << d.w3iForces << d.numPlayers
+        << d.mapPartHeaders;
+}
+static void readIndexEntry(QDataStream &in, War3MapSharedData &d) {
+    in >> d.mapSize >> d.mapInfo >> d.mapCRC >> d.mapSHA1Bytes
+       >> d.mapWidth >> d.mapHeight >> d.mapPlayableWidth >> d.mapPlayableHeight
+       >> d.mapOptions >> d.w3iPlayers >> d.w3iForces >> d.numPlayers
+       >> d.mapPartHeaders;
+}
+
+// 条目开头的写入时间戳 (ms)，用于淘汰最旧的 CRC 目录变体
+static qint64 indexEntryStamp(const QByteArray &entry) {
+    QDataStream in(entry);
+    in.setVersion(QDataStream::Qt_5_12);
+    qint64 writtenMs = 0;
+    in >> writtenMs;
+    return in.status() == QDataStream::Ok ? writtenMs : 0;
+}
+
+// 读取整个索引: 键 -> 序列化后的条目
+static QMap<QString, QByteArray> readMapIndex(const QString &indexPath) {
+    QMap<QString, QByteArray> entries;
+    QFile f(indexPath);
+    if (!f.open(QIODevice::ReadOnly)) return entries;
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != MAP_INDEX_MAGIC || version != MAP_INDEX_VERSION) return entries;
+
+    in >> entries;
+    if (in.status() != QDataStream::Ok) entries.clear();
+    return entries;
+}
+
+static bool writeMapIndex(const QString &indexPath, const QMap<QString, QByteArray> &entries) {
+    // QSaveFile 写入唯一的临时文件后原子替换: 并发写入互不覆盖，读方也不会看到半截或缺失的索引
+    QSaveFile f(indexPath);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << MAP_INDEX_MAGIC << MAP_INDEX_VERSION << entries;
+    if (out.status() != QDataStream::Ok) {
+        f.cancelWriting();
+        return false;
+    }
+    return f.commit();
 }
 
 // =========================================================
@@ -72,6 +163,10 @@ QByteArray War3Map::getMapRawData() const {
     return m_sharedData ? m_sharedData->mapRawData : QByteArray();
 }
 
+QByteArray War3Map::getMapPartHeaders() const {
+    return m_sharedData ? m_sharedData->mapPartHeaders : QByteArray();
+}
+
 quint32 War3Map::getMapSize() const {
     if (!isValid() || m_sharedData->mapSize.size() < 4) return 0;
     return qFromLittleEndian<quint32>(m_sharedData->mapSize.constData());
@@ -189,6 +284,120 @@ bool War3Map::getMapSize(const QByteArray &w3eData, quint16 &outW, quint16 &outH
     return (width > 0 && height > 0);
 }
 
+// 解析基础脚本路径: 优先 CRC 目录 -> war3files 默认目录
+static QString resolveLocalScript(const QString &priorityCrcDir, const QString &name)
+{
+    if (!priorityCrcDir.isEmpty()) {
+        QString path = priorityCrcDir + "/" + name;
+        if (QFile::exists(path)) return path;
+    }
+    return "war3files/" + name;
+}
+
+// 基础脚本指纹 (路径 + 大小 + 修改时间)，用于索引失效判断
+static QString localScriptStamp(const QString &priorityCrcDir)
+{
+    QStringList parts;
+    for (const char *name : { "common.j", "blizzard.j" }) {
+        QFileInfo info(resolveLocalScript(priorityCrcDir, name));
+        parts << QString("%1:%2:%3").arg(info.absoluteFilePath()).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+    }
+    return parts.join('|');
+}
+
+// =========================================================
+// 基础脚本哈希缓存 (common.j / blizzard.j)
+// ---------------------------------------------------------
+// 按优先 CRC 目录缓存两个脚本的暴雪哈希，以及 SHA1 输入
+// "common.j + blizzard.j + 魔数" 之后的中间状态；加载地图时
+// 拷贝中间状态继续哈希地图自身文件即可。
+// 文件监视器在脚本变化时清除对应条目；编辑器"替换式保存"
+// 可能让监视器丢失路径，因此命中时仍比对一次指纹兜底。
+// =========================================================
+struct BaseScriptHash {
+    QString         stamp;
+    QStringList     files;
+    quint32         hCommon = 0;
+    quint32         hBlizz = 0;
+    t_sha1_ctx      sha1Mid;
+};
+
+static QMutex s_baseScriptMutex;
+static QHash<QString, BaseScriptHash> s_baseScriptCache;
+
+// 监视器常驻主线程 (QFileSystemWatcher 非线程安全，增删路径都投递到其所在线程)
+static QFileSystemWatcher *baseScriptWatcher()
+{
+    static QFileSystemWatcher *watcher = []() {
+        auto *w = new QFileSystemWatcher();
+        if (QCoreApplication::instance()) w->moveToThread(QCoreApplication::instance()->thread());
+
+        QObject::connect(w, &QFileSystemWatcher::fileChanged, w, [](const QString &path) {
+            QMutexLocker locker(&s_baseScriptMutex);
+            auto it = s_baseScriptCache.begin();
+            while (it != s_baseScriptCache.end()) {
+                if (it.value().files.contains(path)) {
+                    LOG_INFO(QString("[War3Map] 📜 基础脚本已变更，清除哈希缓存: %1").arg(path));
+                    it = s_baseScriptCache.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        });
+        return w;
+    }();
+    return watcher;
+}
+
+static bool loadBaseScriptHash(const QString &priorityCrcDir, const QString &stamp, BaseScriptHash &out, bool &cached)
+{
+    // 1. 缓存命中
+    {
+        QMutexLocker locker(&s_baseScriptMutex);
+        auto it = s_baseScriptCache.constFind(priorityCrcDir);
+        if (it != s_baseScriptCache.constEnd() && it.value().stamp == stamp) {
+            out = it.value();
+            cached = true;
+            return true;
+        }
+    }
+
+    // 2. 读取并计算
+    cached = false;
+    const QString commonPath = QFileInfo(resolveLocalScript(priorityCrcDir, "common.j")).absoluteFilePath();
+    const QString blizzPath = QFileInfo(resolveLocalScript(priorityCrcDir, "blizzard.j")).absoluteFilePath();
+
+    QFile fCommon(commonPath);
+    QFile fBlizz(blizzPath);
+    if (!fCommon.open(QIODevice::ReadOnly) || !fBlizz.open(QIODevice::ReadOnly)) return false;
+    const QByteArray dataCommon = fCommon.readAll();
+    const QByteArray dataBlizzard = fBlizz.readAll();
+    if (dataCommon.isEmpty() || dataBlizzard.isEmpty()) return false;
+
+    BaseScriptHash entry;
+    entry.stamp = stamp;
+    entry.files << commonPath << blizzPath;
+    entry.hCommon = War3Map::calcBlizzardHash(dataCommon);
+    entry.hBlizz = War3Map::calcBlizzardHash(dataBlizzard);
+    sha1_init(&entry.sha1Mid);
+    sha1_update(&entry.sha1Mid, dataCommon.constData(), dataCommon.size());
+    sha1_update(&entry.sha1Mid, dataBlizzard.constData(), dataBlizzard.size());
+    sha1UpdateInt32(&entry.sha1Mid, 0x03F1379E);
+
+    {
+        QMutexLocker locker(&s_baseScriptMutex);
+        s_baseScriptCache.insert(priorityCrcDir, entry);
+    }
+
+    // 3. 登记监视 (已监视的路径会被忽略)
+    QFileSystemWatcher *watcher = baseScriptWatcher();
+    const QStringList files = entry.files;
+    QMetaObject::invokeMethod(watcher, [watcher, files]() { watcher->addPaths(files); }, Qt::QueuedConnection);
+
+    out = entry;
+    return true;
+}
+
 // 核心加载函数
 bool War3Map::load(const QString &mapPath)
 {
@@ -203,10 +412,19 @@ bool War3Map::load(const QString &mapPath)
         QMutexLocker locker(&s_cacheMutex);
         if (s_cache.contains(cleanPath)) {
             m_sharedData = s_cache[cleanPath];
-            if (m_sharedData && m_sharedData->valid) {
+            // 文件已被替换 (大小或修改时间变化) 时不再复用旧映射，重新加载
+            const QFileInfo current(cleanPath);
+            const bool unchanged = m_sharedData
+                                   && current.size() == m_sharedData->fileSize
+                                   && current.lastModified().toMSecsSinceEpoch() == m_sharedData->fileMtime;
+            if (m_sharedData && m_sharedData->valid && unchanged) {
                 LOG_INFO(QString("   └─ ⚡ [缓存命中] Ref: %1").arg(m_sharedData.use_count()));
                 return true;
             }
+            if (m_sharedData && !unchanged) {
+                LOG_INFO("   ├─ ♻️ [缓存失效] 磁盘文件已变化，重新映射");
+            }
+            m_sharedData.reset();
             s_cache.remove(cleanPath);
         }
     }
@@ -215,14 +433,66 @@ bool War3Map::load(const QString &mapPath)
     newData->mapPath = cleanPath;
     newData->valid = false;
 
-    // 3. 读取物理文件
-    QFile file(mapPath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    // 3. 映射物理文件 (只读 mmap，多个房间共享同一份页缓存)
+    auto file = std::make_shared<QFile>(mapPath);
+    if (!file->open(QIODevice::ReadOnly)) {
         LOG_ERROR(QString("   └─ ❌ [错误] 无法打开文件: %1").arg(mapPath));
         return false;
     }
-    newData->mapRawData = file.readAll();
-    file.close();
+    const qint64 fileSize = file->size();
+    newData->fileSize = fileSize;
+    newData->fileMtime = QFileInfo(cleanPath).lastModified().toMSecsSinceEpoch();
+    uchar *view = (fileSize > 0) ? file->map(0, fileSize) : nullptr;
+    if (view) {
+        newData->mapFile = file;
+        newData->mapped = true;
+        newData->mapRawData = QByteArray::fromRawData(reinterpret_cast<const char*>(view), (int)fileSize);
+    } else {
+        // 映射失败 (如特殊文件系统)，退回整读
+        LOG_WARNING(QString("   ├─ ⚠️ 内存映射失败，退回整读: %1").arg(file->errorString()));
+        newData->mapRawData = file->readAll();
+        file->close();
+    }
+
+    // 3.1 索引查询: 命中则跳过 MPQ 解析与全部哈希计算
+    const QString priorityCrcDir = getPriorityCrcDirectory();
+    const QString scriptStamp = localScriptStamp(priorityCrcDir);
+    const QFileInfo mapFileInfo(cleanPath);
+    const QString indexPath = cleanPath + ".idx";
+    const QString indexKey = QString("%1|%2|%3|%4")
+                                 .arg(mapFileInfo.size())
+                                 .arg(mapFileInfo.lastModified().toMSecsSinceEpoch())
+                                 .arg(priorityCrcDir, scriptStamp);
+    QMap<QString, QByteArray> indexEntries = readMapIndex(indexPath);
+
+    if (indexEntries.contains(indexKey)) {
+        QDataStream in(indexEntries.value(indexKey));
+        in.setVersion(QDataStream::Qt_5_12);
+        qint64 writtenMs = 0;
+        in >> writtenMs;
+        readIndexEntry(in, *newData);
+
+        if (in.status() == QDataStream::Ok && newData->mapSize == toBytes((quint32)newData->mapRawData.size())) {
+            newData->valid = true;
+            {
+                QMutexLocker locker(&s_cacheMutex);
+                s_cache.insert(cleanPath, newData);
+                m_sharedData = newData;
+            }
+            LOG_INFO(QString("   └─ ⚡ [索引命中] MapCRC=0x%1 (%2)")
+                         .arg(QString::number(getMapCRC(), 16).toUpper(), QFileInfo(indexPath).fileName()));
+            return true;
+        }
+        LOG_WARNING("   ├─ ⚠️ 索引条目损坏，重新解析");
+        auto freshData = std::make_shared<War3MapSharedData>();
+        freshData->mapPath = newData->mapPath;
+        freshData->mapRawData = newData->mapRawData;
+        freshData->mapFile = newData->mapFile;
+        freshData->mapped = newData->mapped;
+        freshData->fileSize = newData->fileSize;
+        freshData->fileMtime = newData->fileMtime;
+        newData = freshData;
+    }
 
     // 4. 计算基础校验信息 (Size, CRC32)
     newData->mapSize = toBytes((quint32)newData->mapRawData.size());
@@ -232,6 +502,13 @@ bool War3Map::load(const QString &mapPath)
 
     LOG_INFO(QString("   ├─ 📂 文件读取: %1 bytes (CRC: %2)").arg(newData->mapRawData.size()).arg(QString::number(zCrc, 16).toUpper()));
 
+    // 4.1 预构建下载分片包头 (所有 Client 共享)
+    newData->mapPartHeaders = buildMapPartHeaders(newData->mapRawData);
+    LOG_INFO(QString("   ├─ 🧩 分片预构建: %1 片 (%2 bytes, %3)")
+                 .arg(newData->mapPartHeaders.size() / MAP_PART_HEADER_SIZE)
+                 .arg(newData->mapPartHeaders.size())
+                 .arg(newData->mapped ? "mmap" : "heap"));
+
     // 5. MPQ 操作
     HANDLE hMpq = NULL;
     QString nativePath = QDir::toNativeSeparators(mapPath);
@@ -247,17 +524,6 @@ bool War3Map::load(const QString &mapPath)
     }
 
     // 辅助读取函数
-    auto readLocalScript = [&](const QString &name) -> QByteArray {
-        QString priorityCrcDir = getPriorityCrcDirectory();
-        if (!priorityCrcDir.isEmpty()) {
-            QFile f(priorityCrcDir + "/" + name);
-            if (f.exists() && f.open(QIODevice::ReadOnly)) return f.readAll();
-        }
-        QFile fDefault("war3files/" + name);
-        if (fDefault.open(QIODevice::ReadOnly)) return fDefault.readAll();
-        return QByteArray();
-    };
-
     auto readMpqFile = [&](const QString &name) -> QByteArray {
         HANDLE hFile = NULL;
         QByteArray buf;
@@ -273,25 +539,33 @@ bool War3Map::load(const QString &mapPath)
         return buf;
     };
 
-    // 🔐 哈希计算
-    QByteArray dataCommon = readLocalScript("common.j");
-    QByteArray dataBlizzard = readLocalScript("blizzard.j");
+    // 🔐 哈希计算 (common.j / blizzard.j 的哈希与 SHA1 中间状态按目录缓存)
+    BaseScriptHash baseHash;
+    bool baseCached = false;
+    if (!loadBaseScriptHash(priorityCrcDir, scriptStamp, baseHash, baseCached)) {
+        LOG_ERROR("   └─ ❌ [错误] 基础脚本 (common.j / blizzard.j) 缺失，无法计算 Hash");
+        SFileCloseArchive(hMpq);
+        return false;
+    }
+    LOG_INFO(QString("   ├─ 📜 基础脚本: %1").arg(baseCached ? "⚡ 缓存命中" : "已计算并缓存"));
+
     QByteArray dataMapScript = readMpqFile("war3map.j");
     if (dataMapScript.isEmpty()) dataMapScript = readMpqFile("scripts\\war3map.j");
 
-    if (dataCommon.isEmpty() || dataBlizzard.isEmpty() || dataMapScript.isEmpty()) {
+    if (dataMapScript.isEmpty()) {
         LOG_ERROR("   └─ ❌ [错误] 核心脚本缺失，无法计算 Hash");
         SFileCloseArchive(hMpq);
         return false;
     }
 
-    QCryptographicHash sha1Ctx(QCryptographicHash::Sha1);
+    // 从中间状态继续: 已包含 common.j + blizzard.j + 魔数
+    t_sha1_ctx sha1Ctx = baseHash.sha1Mid;
 
     // 基于 war3 1.26a 反汇编计算 (game.dll + 3B1A20)
 
     // Step 1: 计算基础 Hash
-    quint32 hCommon = calcBlizzardHash(dataCommon);
-    quint32 hBlizz = calcBlizzardHash(dataBlizzard);
+    quint32 hCommon = baseHash.hCommon;
+    quint32 hBlizz = baseHash.hBlizz;
     quint32 hScript = calcBlizzardHash(dataMapScript);
 
     // Step 2: 汇编 game.dll + 3B1AEB: xor ebx, ebp (Blizz ^ Common)
@@ -313,10 +587,7 @@ bool War3Map::load(const QString &mapPath)
     crcVal = rotateLeft(crcVal, 3);
 
     // SHA1 填充
-    sha1Ctx.addData(dataCommon);
-    sha1Ctx.addData(dataBlizzard);
-    sha1UpdateInt32(sha1Ctx, 0x03F1379E);
-    sha1Ctx.addData(dataMapScript);
+    sha1_update(&sha1Ctx, dataMapScript.constData(), dataMapScript.size());
 
     const char *componentFiles[] = {
         "war3map.w3e", "war3map.wpm", "war3map.doo", "war3map.w3u",
@@ -326,15 +597,15 @@ bool War3Map::load(const QString &mapPath)
     for (const char *compName : componentFiles) {
         QByteArray compData = readMpqFile(compName);
         if (!compData.isEmpty()) {
-            sha1Ctx.addData(compData);
+            sha1_update(&sha1Ctx, compData.constData(), compData.size());
             crcVal = rotateLeft(crcVal ^ calcBlizzardHash(compData), 3);
         }
     }
 
-    newData->mapSHA1Bytes = sha1Ctx.result();
+    newData->mapSHA1Bytes = sha1_final(sha1Ctx);
     newData->mapCRC = toBytes(crcVal);
 
-    LOG_INFO(QString("   ├─ 🔐 校验计算: MapCRC=0x%1").arg(QString::number(crcVal, 16).toUpper()));
+    LOG_INFO(QString("   ├─ 🔐 校验计算: MapCRC=0x%1 (哈希内核: %2)").arg(QString::number(crcVal, 16).toUpper(), blizzardHashKernelName()));
 
     // ℹ️ 元数据解析
     LOG_INFO("   ├─ ℹ️ 元数据解析 (w3i):");
@@ -491,6 +762,42 @@ bool War3Map::load(const QString &mapPath)
         m_sharedData = newData;
     }
 
+    // 写回索引 (同一地图仅保留最近的若干个 CRC 目录变体)
+    {
+        QByteArray entry;
+        QDataStream out(&entry, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << QDateTime::currentMSecsSinceEpoch();
+        writeIndexEntry(out, *newData);
+
+        const QString sizeMtimePrefix = indexKey.section('|', 0, 1) + "|";
+        for (auto it = indexEntries.begin(); it != indexEntries.end();) {
+            // 文件本身已变化的旧条目直接丢弃
+            if (!it.key().startsWith(sizeMtimePrefix)) it = indexEntries.erase(it);
+            else ++it;
+        }
+        while (indexEntries.size() >= MAP_INDEX_MAX_KEYS) {
+            // 淘汰写入时间最早的条目 (键按字典序排列，与新旧无关)
+            auto oldest = indexEntries.begin();
+            qint64 oldestMs = indexEntryStamp(oldest.value());
+            for (auto it = std::next(oldest); it != indexEntries.end(); ++it) {
+                const qint64 ms = indexEntryStamp(it.value());
+                if (ms < oldestMs) {
+                    oldest = it;
+                    oldestMs = ms;
+                }
+            }
+            indexEntries.erase(oldest);
+        }
+        indexEntries.insert(indexKey, entry);
+
+        if (writeMapIndex(indexPath, indexEntries)) {
+            LOG_INFO(QString("   ├─ 💾 索引已写入: %1").arg(QFileInfo(indexPath).fileName()));
+        } else {
+            LOG_WARNING(QString("   ├─ ⚠️ 索引写入失败 (目录不可写?): %1").arg(indexPath));
+        }
+    }
+
     LOG_INFO("   └─ ✅ [完成] 加载结束");
     return true;
 }
@@ -510,6 +817,93 @@ void War3Map::clearUnusedCache()
     }
 }
 
+QByteArray War3Map::buildMapPartHeaders(const QByteArray &mapData)
+{
+    const int total = mapData.size();
+    if (total <= 0) return QByteArray();
+
+    const int partCount = (total + MAP_PART_CHUNK_SIZE - 1) / MAP_PART_CHUNK_SIZE;
+
+    // 包头定长排列，发送时按 offset / MAP_PART_CHUNK_SIZE 直接定位
+    QByteArray headers;
+    headers.resize(partCount * MAP_PART_HEADER_SIZE);
+
+    const char *src = mapData.constData();
+    uchar *dst = reinterpret_cast<uchar*>(headers.data());
+
+    for (int i = 0; i < partCount; ++i) {
+        const quint32 offset = (quint32)i * MAP_PART_CHUNK_SIZE;
+        const int chunkSize = qMin(MAP_PART_CHUNK_SIZE, total - (int)offset);
+
+        uLong zCrc = crc32(0L, Z_NULL, 0);
+        zCrc = crc32(zCrc, reinterpret_cast<const Bytef*>(src + offset), chunkSize);
+
+        // Header: F7 43 [Len] [ToPID] [FromPID] [Unknown=1] [Offset] [CRC32]
+        dst[0] = 0xF7;
+        dst[1] = 0x43;
+        qToLittleEndian<quint16>((quint16)(MAP_PART_HEADER_SIZE + chunkSize), dst + 2);
+        dst[MAP_PART_TOPID_OFFSET] = 0;
+        dst[MAP_PART_FROMPID_OFFSET] = 0;
+        qToLittleEndian<quint32>(1, dst + 6);
+        qToLittleEndian<quint32>(offset, dst + 10);
+        qToLittleEndian<quint32>((quint32)zCrc, dst + 14);
+
+        dst += MAP_PART_HEADER_SIZE;
+    }
+
+    return headers;
+}
+
+QStringList War3Map::memoryReport()
+{
+    QStringList lines;
+    qint64 totalMapped = 0;
+    qint64 totalResident = 0;
+
+#ifdef Q_OS_UNIX
+    const long pageSize = sysconf(_SC_PAGESIZE);
+#endif
+
+    QMutexLocker locker(&s_cacheMutex);
+    for (auto it = s_cache.constBegin(); it != s_cache.constEnd(); ++it) {
+        const auto &data = it.value();
+        if (!data) continue;
+
+        const qint64 size = data->mapRawData.size();
+        qint64 resident = size;
+
+#ifdef Q_OS_UNIX
+        // mincore 统计映射中已驻留物理内存的页
+        if (data->mapped && size > 0 && pageSize > 0) {
+            const size_t pages = (size_t)((size + pageSize - 1) / pageSize);
+            std::vector<unsigned char> vec(pages);
+            void *addr = const_cast<char*>(data->mapRawData.constData());
+            if (mincore(addr, (size_t)size, vec.data()) == 0) {
+                resident = 0;
+                for (unsigned char v : vec) {
+                    if (v & 1) resident += pageSize;
+                }
+                resident = qMin(resident, size);
+            }
+        }
+#endif
+
+        totalMapped += size;
+        totalResident += resident;
+        lines << QString("%1 | %2 | 大小: %3 KB | 常驻: %4 KB | 包头: %5 KB | 引用: %6")
+                     .arg(QFileInfo(it.key()).fileName())
+                     .arg(data->mapped ? "mmap" : "heap")
+                     .arg(size / 1024)
+                     .arg(resident / 1024)
+                     .arg(data->mapPartHeaders.size() / 1024)
+                     .arg(data.use_count() - 1);
+    }
+
+    lines << QString("合计: %1 张地图 | 大小: %2 KB | 常驻: %3 KB")
+                 .arg(s_cache.size()).arg(totalMapped / 1024).arg(totalResident / 1024);
+    return lines;
+}
+
 QByteArray War3Map::decodeStatString(const QByteArray &encoded)
 {
     QByteArray decoded;
@@ -693,7 +1087,7 @@ QString War3Map::getPriorityCrcDirectory()
 // 核心算法：暴雪自定义哈希 (Blizzard Hash)
 // 汇编入口: Game.dll + 39E5C0
 // =========================================================
-quint32 War3Map::calcBlizzardHash(const QByteArray &data) {
+quint32 War3Map::calcBlizzardHashReference(const QByteArray &data) {
     quint32 hash = 0;
     const char *ptr = data.constData();
     int length = data.size();
@@ -736,3 +1130,208 @@ quint32 War3Map::calcBlizzardHash(const QByteArray &data) {
 
     return hash;
 }
+
+// =========================================================
+// 暴雪哈希: 多通道折叠实现
+// ---------------------------------------------------------
+// h' = rol(h ^ c, 3) 对 XOR 是线性的，展开后:
+//   h_N = XOR_i rol(c_i, 3 * (N - i))
+// 旋转量以 32 个 DWORD 为周期重复，因此把第 i 个 DWORD 异或进
+// 通道 acc[i % 32] (纯 XOR，可整块向量化)，最后按通道各自旋转
+// 一次再合并即可，与逐 DWORD 的原始实现逐位一致。
+// =========================================================
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define WAR3MAP_HASH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define WAR3MAP_TARGET(x)
+#else
+#define WAR3MAP_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+#include <cstring>
+
+#define BLIZZ_HASH_LANES        32
+#define BLIZZ_HASH_BLOCK_SIZE   (BLIZZ_HASH_LANES * 4)
+
+typedef void (*BlizzFoldFn)(const char *ptr, int blocks, quint32 *acc);
+
+// 标量通道: 每块 16 次 64 位异或
+static void blizzFoldScalar(const char *ptr, int blocks, quint32 *acc)
+{
+    quint64 lanes[BLIZZ_HASH_LANES / 2];
+    memcpy(lanes, acc, sizeof(lanes));
+    for (int b = 0; b < blocks; ++b, ptr += BLIZZ_HASH_BLOCK_SIZE) {
+        for (int k = 0; k < BLIZZ_HASH_LANES / 2; ++k) {
+            quint64 v;
+            memcpy(&v, ptr + k * 8, 8);
+            lanes[k] ^= v;
+        }
+    }
+    memcpy(acc, lanes, sizeof(lanes));
+}
+
+#ifdef WAR3MAP_HASH_X86
+// SSE2: 8 个 128 位累加器
+WAR3MAP_TARGET("sse2")
+static void blizzFoldSse2(const char *ptr, int blocks, quint32 *acc)
+{
+    __m128i a[8];
+    for (int k = 0; k < 8; ++k) a[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + k);
+    for (int b = 0; b < blocks; ++b, ptr += BLIZZ_HASH_BLOCK_SIZE) {
+        const __m128i *p = reinterpret_cast<const __m128i*>(ptr);
+        for (int k = 0; k < 8; ++k) a[k] = _mm_xor_si128(a[k], _mm_loadu_si128(p + k));
+    }
+    for (int k = 0; k < 8; ++k) _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + k, a[k]);
+}
+
+// AVX2: 4 个 256 位累加器
+WAR3MAP_TARGET("avx2")
+static void blizzFoldAvx2(const char *ptr, int blocks, quint32 *acc)
+{
+    __m256i a[4];
+    for (int k = 0; k < 4; ++k) a[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + k);
+    for (int b = 0; b < blocks; ++b, ptr += BLIZZ_HASH_BLOCK_SIZE) {
+        const __m256i *p = reinterpret_cast<const __m256i*>(ptr);
+        for (int k = 0; k < 4; ++k) a[k] = _mm256_xor_si256(a[k], _mm256_loadu_si256(p + k));
+    }
+    for (int k = 0; k < 4; ++k) _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + k, a[k]);
+}
+
+static bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool cpuHasSse2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+#endif
+
+struct BlizzFoldKernel {
+    BlizzFoldFn fn;
+    const char *name;
+};
+
+// 运行时按 CPU 能力选择一次 (函数内静态变量的初始化是线程安全的)
+static const BlizzFoldKernel &blizzFoldKernel()
+{
+    static const BlizzFoldKernel kernel = []() -> BlizzFoldKernel {
+#ifdef WAR3MAP_HASH_X86
+        if (qEnvironmentVariableIsEmpty("WAR3BOT_NO_SIMD")) {
+            if (cpuHasAvx2()) return { blizzFoldAvx2, "AVX2" };
+            if (cpuHasSse2()) return { blizzFoldSse2, "SSE2" };
+        }
+#endif
+        return { blizzFoldScalar, "Scalar" };
+    }();
+    return kernel;
+}
+
+const char *War3Map::blizzardHashKernelName()
+{
+    return blizzFoldKernel().name;
+}
+
+quint32 War3Map::calcBlizzardHash(const QByteArray &data)
+{
+    const char *ptr = data.constData();
+    const int length = data.size();
+    const int dwordCount = length / 4;
+
+    // 1. 整块折叠进 32 个通道
+    quint32 acc[BLIZZ_HASH_LANES] = {};
+    const int blocks = dwordCount / BLIZZ_HASH_LANES;
+    if (blocks > 0) blizzFoldKernel().fn(ptr, blocks, acc);
+
+    // 2. 不足一块的 DWORD 按下标落入对应通道
+    for (int i = blocks * BLIZZ_HASH_LANES; i < dwordCount; ++i) {
+        quint32 chunk;
+        memcpy(&chunk, ptr + i * 4, 4);
+        acc[i % BLIZZ_HASH_LANES] ^= chunk;
+    }
+
+    // 3. 合并: 通道 j 内各 DWORD 的旋转量同为 3 * (N - j) mod 32
+    quint32 hash = 0;
+    for (int j = 0; j < BLIZZ_HASH_LANES; ++j) {
+        const int steps = ((dwordCount - j) % BLIZZ_HASH_LANES + BLIZZ_HASH_LANES) % BLIZZ_HASH_LANES;
+        hash ^= ROTL32(acc[j], 3 * steps);
+    }
+
+    // 4. 尾部字节仍按原顺序串行处理
+    for (int i = dwordCount * 4; i < length; ++i) {
+        hash = rotateLeft(hash ^ (quint8)ptr[i], 3);
+    }
+
+    return hash;
+}
+
+QStringList War3Map::benchmarkBlizzardHash(int rounds)
+{
+    QList<std::shared_ptr<War3MapSharedData>> maps;
+    {
+        QMutexLocker locker(&s_cacheMutex);
+        for (auto it = s_cache.constBegin(); it != s_cache.constEnd(); ++it) {
+            if (it.value() && it.value()->valid) maps.append(it.value());
+        }
+    }
+
+    QStringList lines;
+    lines << QString("内核: %1, 轮数: %2").arg(blizzardHashKernelName()).arg(rounds);
+    if (maps.isEmpty()) {
+        lines << "缓存中没有已加载的地图";
+        return lines;
+    }
+
+    for (const auto &map : qAsConst(maps)) {
+        const QByteArray &data = map->mapRawData;
+        const double mb = data.size() / (1024.0 * 1024.0) * rounds;
+
+        QElapsedTimer timer;
+        quint32 refHash = 0;
+        timer.start();
+        for (int r = 0; r < rounds; ++r) refHash ^= calcBlizzardHashReference(data) + r;
+        const qint64 refNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+        quint32 fastHash = 0;
+        timer.restart();
+        for (int r = 0; r < rounds; ++r) fastHash ^= calcBlizzardHash(data) + r;
+        const qint64 fastNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+        lines << QString("%1: %2 KB | 原实现 %3 MB/s | 折叠 %4 MB/s | x%5 | %6")
+                     .arg(QFileInfo(map->mapPath).fileName())
+                     .arg(data.size() / 1024)
+                     .arg(mb / (refNs / 1e9), 0, 'f', 0)
+                     .arg(mb / (fastNs / 1e9), 0, 'f', 0)
+                     .arg((double)refNs / fastNs, 0, 'f', 1)
+                     .arg(refHash == fastHash ? "✅ 一致" : "❌ 不一致");
+    }
+    return lines;
+}